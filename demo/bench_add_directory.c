@@ -0,0 +1,307 @@
+#include "mc3media.h"
+#include "mc3msg.h"
+#include "mergecom.h"
+#include "diction.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+// Times building a DICOMDIR from a file-set with MC_DDH_Add_Directory,
+// once for each thread count given. If PATIENTS isn't zero, a file-set
+// of 100 files (5 studies of 2 series of 10 images) per patient is
+// written to DIR first. The files hold only the attributes the records
+// are built from, so they're read faster than real images would be.
+// Usage: bench_add_directory DIR PATIENTS [THREADS...]
+
+#define STUDIES_PER_PATIENT 5
+#define SERIES_PER_STUDY 2
+#define IMAGES_PER_SERIES 10
+
+static double now_ms( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int check( MC_STATUS stat, const char* what )
+{
+    if( stat != MC_NORMAL_COMPLETION )
+    {
+        printf( "%s: %s\n", what, MC_Error_Message( stat ) );
+    }
+    else
+    {
+        // Do nothing
+    }
+
+    return stat == MC_NORMAL_COMPLETION;
+}
+
+static MC_STATUS write_using_stdio( char* Cbfilename,
+                                    void* CbuserInfo,
+                                    int   CbdataSize,
+                                    void* CbdataBuffer,
+                                    int   CbisFirst,
+                                    int   CbisLast )
+{
+    FILE** f_ptr = (FILE**)CbuserInfo;
+
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( CbisFirst != 0 )
+    {
+        *f_ptr = fopen( Cbfilename, "wb" );
+    }
+    else
+    {
+        // Do nothing. File pointer already initialized
+    }
+
+    if( *f_ptr != NULL &&
+        ( CbdataSize <= 0 ||
+          fwrite( CbdataBuffer, CbdataSize, 1, *f_ptr ) == 1u ) )
+    {
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = MC_CANNOT_COMPLY;
+    }
+
+    if( CbisLast != 0 && *f_ptr != NULL )
+    {
+        fclose( *f_ptr );
+        *f_ptr = NULL;
+    }
+    else
+    {
+        // Do nothing
+    }
+
+    return ret;
+}
+
+static int write_image( const char* filename,
+                        int         patient,
+                        int         study,
+                        int         series,
+                        int         image )
+{
+    char value[64];
+    int fileid = 0;
+    FILE* f = NULL;
+    int ok = check( MC_Create_Empty_File( &fileid, filename ),
+                    "MC_Create_Empty_File" );
+
+    sprintf( value, "1.2.9.%d.%d.%d.%d", patient, study, series, image );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_MEDIA_STORAGE_SOP_CLASS_UID,
+                                                "1.2.840.10008.5.1.4.1.1.7" ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_MEDIA_STORAGE_SOP_INSTANCE_UID,
+                                                value ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_TRANSFER_SYNTAX_UID,
+                                                "1.2.840.10008.1.2.1" ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_SOP_CLASS_UID,
+                                                "1.2.840.10008.5.1.4.1.1.7" ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_SOP_INSTANCE_UID,
+                                                value ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_STUDY_DATE,
+                                                "20240101" ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_STUDY_TIME,
+                                                "120000" ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_MODALITY,
+                                                "OT" ),
+                      "MC_Set_Value_From_String" );
+
+    sprintf( value, "DOE^P%d", patient );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_PATIENTS_NAME,
+                                                value ),
+                      "MC_Set_Value_From_String" );
+    sprintf( value, "PID%d", patient );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_PATIENT_ID,
+                                                value ),
+                      "MC_Set_Value_From_String" );
+    sprintf( value, "1.2.7.%d.%d", patient, study );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_STUDY_INSTANCE_UID,
+                                                value ),
+                      "MC_Set_Value_From_String" );
+    sprintf( value, "ST%d", study );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_STUDY_ID,
+                                                value ),
+                      "MC_Set_Value_From_String" );
+    sprintf( value, "1.2.8.%d.%d.%d", patient, study, series );
+    ok = ok && check( MC_Set_Value_From_String( fileid,
+                                                MC_ATT_SERIES_INSTANCE_UID,
+                                                value ),
+                      "MC_Set_Value_From_String" );
+    ok = ok && check( MC_Set_Value_From_Int( fileid,
+                                             MC_ATT_SERIES_NUMBER,
+                                             series + 1 ),
+                      "MC_Set_Value_From_Int" );
+    ok = ok && check( MC_Set_Value_From_Int( fileid,
+                                             MC_ATT_INSTANCE_NUMBER,
+                                             image + 1 ),
+                      "MC_Set_Value_From_Int" );
+
+    ok = ok && check( MC_Write_File( fileid, 0, &f, write_using_stdio ),
+                      "MC_Write_File" );
+
+    if( fileid != 0 )
+    {
+        MC_Free_File( &fileid );
+    }
+    else
+    {
+        // Do nothing. Not created
+    }
+
+    return ok;
+}
+
+// Writes the file-set under root, with File IDs of the form
+// P0000/S0/SE0/I00000
+static int write_file_set( const char* root, int patient_count )
+{
+    char path[1024];
+    int ok = 1;
+
+    for( int p = 0; ok && p < patient_count; ++p )
+    {
+        for( int st = 0; ok && st < STUDIES_PER_PATIENT; ++st )
+        {
+            for( int se = 0; ok && se < SERIES_PER_STUDY; ++se )
+            {
+                // Each directory of the File ID is created in turn
+                sprintf( path, "%s/P%04d", root, p );
+                mkdir( path, 0777 );
+                sprintf( path, "%s/P%04d/S%d", root, p, st );
+                mkdir( path, 0777 );
+                sprintf( path, "%s/P%04d/S%d/SE%d", root, p, st, se );
+                mkdir( path, 0777 );
+
+                for( int i = 0; ok && i < IMAGES_PER_SERIES; ++i )
+                {
+                    sprintf( path,
+                             "%s/P%04d/S%d/SE%d/I%05d",
+                             root, p, st, se, i );
+                    ok = write_image( path, p, st, se, i );
+                }
+            }
+        }
+    }
+
+    return ok;
+}
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 3 )
+    {
+        printf( "usage: %s DIR PATIENTS [THREADS...]\n", argv[0] );
+        return 1;
+    }
+
+    const char* root = argv[1];
+    const int patient_count = atoi( argv[2] );
+    char dicomdir[1024];
+    int ok = check( MC_Library_Initialization( NULL, NULL, NULL ),
+                    "MC_Library_Initialization" );
+
+    if( ok && patient_count > 0 )
+    {
+        const double start = now_ms();
+        mkdir( root, 0777 );
+        ok = write_file_set( root, patient_count );
+        if( ok )
+        {
+            printf( "wrote %d files: %.0f ms\n",
+                    patient_count * STUDIES_PER_PATIENT * SERIES_PER_STUDY * IMAGES_PER_SERIES,
+                    now_ms() - start );
+        }
+        else
+        {
+            // Do nothing. Error already printed
+        }
+    }
+    else
+    {
+        // Do nothing. Use the file-set already in DIR
+    }
+
+    sprintf( dicomdir, "%s/DICOMDIR", root );
+
+    // Every core is used if no thread count is given
+    const int run_count = argc > 3 ? argc - 3 : 1;
+    for( int run = 0; ok && run < run_count; ++run )
+    {
+        const int thread_count = argc > 3 ? atoi( argv[3 + run] ) : 0;
+        int dirid = 0;
+        int files_added = 0;
+
+        remove( dicomdir );
+        ok = check( MC_DDH_Create( dicomdir, "BENCH", 0, &dirid ),
+                    "MC_DDH_Create" );
+
+        const double start = now_ms();
+        ok = ok && check( MC_DDH_Add_Directory( dirid,
+                                                root,
+                                                thread_count,
+                                                &files_added ),
+                          "MC_DDH_Add_Directory" );
+        const double added = now_ms();
+        ok = ok && check( MC_DDH_Update( dirid ), "MC_DDH_Update" );
+        const double updated = now_ms();
+
+        if( ok )
+        {
+            printf( "threads %d: %d files, add %.0f ms (%.1f us/file), "
+                    "update %.0f ms\n",
+                    thread_count,
+                    files_added,
+                    added - start,
+                    ( added - start ) * 1000.0 / ( files_added > 0 ? files_added : 1 ),
+                    updated - added );
+        }
+        else
+        {
+            // Do nothing. Error already printed
+        }
+
+        if( dirid != 0 )
+        {
+            MC_Free_File( &dirid );
+        }
+        else
+        {
+            // Do nothing. Not created
+        }
+    }
+
+    MC_Library_Release();
+
+    return ok ? 0 : 1;
+}
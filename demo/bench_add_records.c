@@ -0,0 +1,86 @@
+#include "mc3media.h"
+#include "mc3msg.h"
+#include "mergecom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Times adding image records to the end of a single series, which used
+// to walk the series' whole chain of child records for every record
+// added. Usage: bench_add_records [records]
+
+static double now_ms( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int check( MC_STATUS stat, const char* what )
+{
+    if( stat != MC_NORMAL_COMPLETION )
+    {
+        printf( "%s: %s\n", what, MC_Error_Message( stat ) );
+    }
+    else
+    {
+        // Do nothing
+    }
+
+    return stat == MC_NORMAL_COMPLETION;
+}
+
+int main( int argc, char* argv[] )
+{
+    const int record_count = argc > 1 ? atoi( argv[1] ) : 20000;
+    int dirid = 0;
+    int patient = 0;
+    int study = 0;
+    int series = 0;
+    int ok = check( MC_Library_Initialization( NULL, NULL, NULL ),
+                    "MC_Library_Initialization" );
+
+    ok = ok && check( MC_DDH_Create( "DICOMDIR", "BENCH", 0, &dirid ),
+                      "MC_DDH_Create" );
+    ok = ok && check( MC_DDH_Add_Record( dirid, "PATIENT", &patient ),
+                      "MC_DDH_Add_Record" );
+    ok = ok && check( MC_DDH_Add_Record( patient, "STUDY", &study ),
+                      "MC_DDH_Add_Record" );
+    ok = ok && check( MC_DDH_Add_Record( study, "SERIES", &series ),
+                      "MC_DDH_Add_Record" );
+
+    const double start = now_ms();
+    for( int i = 0; ok && i < record_count; ++i )
+    {
+        int image = 0;
+        ok = check( MC_DDH_Add_Record( series, "IMAGE", &image ),
+                    "MC_DDH_Add_Record" );
+    }
+    const double elapsed = now_ms() - start;
+
+    if( ok )
+    {
+        printf( "%d image records: %.1f ms (%.2f us/record)\n",
+                record_count,
+                elapsed,
+                elapsed * 1000.0 / record_count );
+    }
+    else
+    {
+        // Do nothing. Error already printed
+    }
+
+    if( dirid != 0 )
+    {
+        MC_Free_File( &dirid );
+    }
+    else
+    {
+        // Do nothing. Not created
+    }
+    MC_Library_Release();
+
+    return ok ? 0 : 1;
+}
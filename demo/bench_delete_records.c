@@ -0,0 +1,133 @@
+#include "bench_dicomdir.h"
+
+#include "mc3media.h"
+#include "mc3msg.h"
+#include "mergecom.h"
+
+#include <stdio.h>
+
+// Times MC_DDH_Delete_Record on a DICOMDIR of 101,300 records read from
+// file: deleting one image of the last patient, every second patient,
+// and then all the records left. Usage: bench_delete_records [DICOMDIR]
+
+static MC_TRAVERSAL_STATUS count_record( int RecordID, void* UserData )
+{
+    ++*(long*)UserData;
+
+    return MC_TS_CONTINUE;
+}
+
+static long count_records( int dirid )
+{
+    long count = 0;
+    MC_DDH_Traverse_Records( dirid, &count, count_record );
+
+    return count;
+}
+
+int main( int argc, char* argv[] )
+{
+    const char* path = argc > 1 ? argv[1] : "DICOMDIR";
+    int patients[BENCH_PATIENTS];
+    int patient_count = 0;
+    int dirid = 0;
+    int ok = check( MC_Library_Initialization( NULL, NULL, NULL ),
+                    "MC_Library_Initialization" );
+
+    ok = ok && write_bench_dicomdir( path );
+    ok = ok && check( MC_DDH_Open( path, &dirid ), "MC_DDH_Open" );
+
+    // The patient records are read before timing anything
+    int id = 0;
+    ok = ok && check( MC_DDH_Get_First_Lower_Record( dirid, &id ),
+                      "MC_DDH_Get_First_Lower_Record" );
+    while( ok && id != 0 && patient_count < BENCH_PATIENTS )
+    {
+        patients[patient_count++] = id;
+        ok = check( MC_DDH_Get_Next_Record( id, &id ),
+                    "MC_DDH_Get_Next_Record" );
+    }
+
+    if( ok && patient_count > 0 )
+    {
+        printf( "%ld records, %d patients\n",
+                count_records( dirid ),
+                patient_count );
+
+        int study = 0;
+        int series = 0;
+        int image = 0;
+        ok = check( MC_DDH_Get_First_Lower_Record( patients[patient_count - 1],
+                                                   &study ),
+                    "MC_DDH_Get_First_Lower_Record" );
+        ok = ok && check( MC_DDH_Get_First_Lower_Record( study, &series ),
+                          "MC_DDH_Get_First_Lower_Record" );
+        ok = ok && check( MC_DDH_Get_First_Lower_Record( series, &image ),
+                          "MC_DDH_Get_First_Lower_Record" );
+
+        double start = now_ms();
+        ok = ok && check( MC_DDH_Delete_Record( image ),
+                          "MC_DDH_Delete_Record" );
+        if( ok )
+        {
+            printf( "delete one image: %.2f ms\n", now_ms() - start );
+        }
+        else
+        {
+            // Do nothing. Error already printed
+        }
+
+        int deleted = 0;
+        start = now_ms();
+        for( int p = 0; ok && p < patient_count; p += 2 )
+        {
+            ok = check( MC_DDH_Delete_Record( patients[p] ),
+                        "MC_DDH_Delete_Record" );
+            ++deleted;
+        }
+        if( ok )
+        {
+            const double elapsed = now_ms() - start;
+            printf( "delete %d patients: %.1f ms (%.2f ms/patient), "
+                    "%ld records left\n",
+                    deleted,
+                    elapsed,
+                    elapsed / deleted,
+                    count_records( dirid ) );
+        }
+        else
+        {
+            // Do nothing. Error already printed
+        }
+
+        start = now_ms();
+        ok = ok && check( MC_DDH_Delete_Record( dirid ),
+                          "MC_DDH_Delete_Record" );
+        if( ok )
+        {
+            printf( "delete all records: %.1f ms, %ld records left\n",
+                    now_ms() - start,
+                    count_records( dirid ) );
+        }
+        else
+        {
+            // Do nothing. Error already printed
+        }
+    }
+    else
+    {
+        // Do nothing. Error already printed
+    }
+
+    if( dirid != 0 )
+    {
+        MC_Free_File( &dirid );
+    }
+    else
+    {
+        // Do nothing. Not opened
+    }
+    MC_Library_Release();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include "bench_dicomdir.h"
+
+#include "mc3media.h"
+#include "mc3msg.h"
+#include "mergecom.h"
+#include "diction.h"
+
+#include <stdio.h>
+#include <time.h>
+
+double now_ms( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+int check( MC_STATUS stat, const char* what )
+{
+    if( stat != MC_NORMAL_COMPLETION )
+    {
+        printf( "%s: %s\n", what, MC_Error_Message( stat ) );
+    }
+    else
+    {
+        // Do nothing
+    }
+
+    return stat == MC_NORMAL_COMPLETION;
+}
+
+static int set_string( int id, unsigned long tag, const char* value )
+{
+    return check( MC_Set_Value_From_String( id, tag, value ),
+                  "MC_Set_Value_From_String" );
+}
+
+static int add_images( int series, int patient, int study, int series_num )
+{
+    char value[64];
+    int ok = 1;
+
+    for( int i = 0; ok && i < BENCH_IMAGES_PER_SERIES; ++i )
+    {
+        int image = 0;
+        ok = check( MC_DDH_Add_Record( series, "IMAGE", &image ),
+                    "MC_DDH_Add_Record" );
+
+        sprintf( value, "%d", i + 1 );
+        ok = ok && set_string( image, MC_ATT_INSTANCE_NUMBER, value );
+        sprintf( value,
+                 "1.2.9.%d.%d.%d.%d",
+                 patient, study, series_num, i );
+        ok = ok && set_string( image,
+                               MC_ATT_REFERENCED_SOP_INSTANCE_UID_IN_FILE,
+                               value );
+    }
+
+    return ok;
+}
+
+static int add_study( int patient_id, int patient, int study )
+{
+    char value[64];
+    int study_id = 0;
+    int ok = check( MC_DDH_Add_Record( patient_id, "STUDY", &study_id ),
+                    "MC_DDH_Add_Record" );
+
+    sprintf( value, "1.2.7.%d.%d", patient, study );
+    ok = ok && set_string( study_id, MC_ATT_STUDY_INSTANCE_UID, value );
+    ok = ok && set_string( study_id, MC_ATT_STUDY_DATE, "20240101" );
+    ok = ok && set_string( study_id, MC_ATT_STUDY_TIME, "120000" );
+    sprintf( value, "STUDY %d", study );
+    ok = ok && set_string( study_id, MC_ATT_STUDY_DESCRIPTION, value );
+    sprintf( value, "ST%d", study );
+    ok = ok && set_string( study_id, MC_ATT_STUDY_ID, value );
+    sprintf( value, "ACC%d", study );
+    ok = ok && set_string( study_id, MC_ATT_ACCESSION_NUMBER, value );
+
+    for( int se = 0; ok && se < BENCH_SERIES_PER_STUDY; ++se )
+    {
+        int series_id = 0;
+        ok = check( MC_DDH_Add_Record( study_id, "SERIES", &series_id ),
+                    "MC_DDH_Add_Record" );
+
+        sprintf( value, "1.2.8.%d.%d.%d", patient, study, se );
+        ok = ok && set_string( series_id, MC_ATT_SERIES_INSTANCE_UID, value );
+        ok = ok && set_string( series_id, MC_ATT_MODALITY, "OT" );
+        sprintf( value, "%d", se + 1 );
+        ok = ok && set_string( series_id, MC_ATT_SERIES_NUMBER, value );
+        ok = ok && add_images( series_id, patient, study, se );
+    }
+
+    return ok;
+}
+
+int write_bench_dicomdir( const char* path )
+{
+    char value[64];
+    int dirid = 0;
+    int ok = 1;
+
+    remove( path );
+    ok = check( MC_DDH_Create( path, "BENCH", 0, &dirid ), "MC_DDH_Create" );
+
+    for( int p = 0; ok && p < BENCH_PATIENTS; ++p )
+    {
+        int patient_id = 0;
+        ok = check( MC_DDH_Add_Record( dirid, "PATIENT", &patient_id ),
+                    "MC_DDH_Add_Record" );
+
+        sprintf( value, "DOE^P%d", p );
+        ok = ok && set_string( patient_id, MC_ATT_PATIENTS_NAME, value );
+        sprintf( value, "PID%d", p );
+        ok = ok && set_string( patient_id, MC_ATT_PATIENT_ID, value );
+
+        for( int st = 0; ok && st < BENCH_STUDIES_PER_PATIENT; ++st )
+        {
+            ok = add_study( patient_id, p, st );
+        }
+    }
+
+    ok = ok && check( MC_DDH_Update( dirid ), "MC_DDH_Update" );
+
+    if( dirid != 0 )
+    {
+        MC_Free_File( &dirid );
+    }
+    else
+    {
+        // Do nothing. Not created
+    }
+
+    return ok;
+}
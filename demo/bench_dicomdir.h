@@ -0,0 +1,25 @@
+#ifndef BENCH_DICOMDIR_H
+#define BENCH_DICOMDIR_H
+
+#include "mcstatus.h"
+
+// Helpers shared by the benchmarks that work on an existing DICOMDIR
+
+#define BENCH_PATIENTS 100
+#define BENCH_STUDIES_PER_PATIENT 2
+#define BENCH_SERIES_PER_STUDY 5
+#define BENCH_IMAGES_PER_SERIES 100
+
+double now_ms( void );
+
+// Prints the error and returns 0 if stat isn't MC_NORMAL_COMPLETION
+int check( MC_STATUS stat, const char* what );
+
+// Writes a DICOMDIR of BENCH_PATIENTS patients to path. Patient p is
+// named DOE^P<p>, its study s has the Study Instance UID 1.2.7.<p>.<s>
+// and the Study Description "STUDY <s>", and series se of that study has
+// the Series Instance UID 1.2.8.<p>.<s>.<se>. Images are numbered from 1
+// within their series.
+int write_bench_dicomdir( const char* path );
+
+#endif
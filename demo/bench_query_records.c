@@ -0,0 +1,273 @@
+#include "bench_dicomdir.h"
+
+#include "mc3media.h"
+#include "mc3msg.h"
+#include "mergecom.h"
+#include "diction.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Times MC_DDH_Query_Records on a DICOMDIR of 101,300 records read from
+// file, and a traversal reading the values through the public API that
+// finds the same records as the first query. Each time is the best of
+// RUNS runs. Usage: bench_query_records [DICOMDIR]
+
+#define RUNS 5
+
+typedef struct
+{
+    const char* record_type;
+    unsigned long tags[2];
+    const char* values[2];
+} query_keys;
+
+static MC_TRAVERSAL_STATUS count_record( int RecordID, void* UserData )
+{
+    ++*(long*)UserData;
+
+    return MC_TS_CONTINUE;
+}
+
+static int open_query( const query_keys* keys, int* itemid )
+{
+    int ok = check( MC_Open_Item( itemid, "BENCH" ), "MC_Open_Item" );
+
+    ok = ok && check( MC_Set_Value_From_String( *itemid,
+                                                MC_ATT_DIRECTORY_RECORD_TYPE,
+                                                keys->record_type ),
+                      "MC_Set_Value_From_String" );
+    for( int i = 0; ok && i < 2 && keys->values[i] != NULL; ++i )
+    {
+        ok = check( MC_Set_Value_From_String( *itemid,
+                                              keys->tags[i],
+                                              keys->values[i] ),
+                    "MC_Set_Value_From_String" );
+    }
+
+    return ok;
+}
+
+static int run_query( int dirid, const char* name, const query_keys* keys )
+{
+    int itemid = 0;
+    long matches = 0;
+    double best = 0.0;
+    int ok = open_query( keys, &itemid );
+
+    for( int run = 0; ok && run < RUNS; ++run )
+    {
+        matches = 0;
+        const double start = now_ms();
+        ok = check( MC_DDH_Query_Records( dirid,
+                                          itemid,
+                                          &matches,
+                                          count_record ),
+                    "MC_DDH_Query_Records" );
+        const double elapsed = now_ms() - start;
+        best = ( run == 0 || elapsed < best ) ? elapsed : best;
+    }
+
+    if( ok )
+    {
+        printf( "%-36s %6ld matches %8.2f ms\n", name, matches, best );
+    }
+    else
+    {
+        // Do nothing. Error already printed
+    }
+
+    if( itemid != 0 )
+    {
+        MC_Free_Item( &itemid );
+    }
+    else
+    {
+        // Do nothing. Not opened
+    }
+
+    return ok;
+}
+
+typedef struct
+{
+    int patient_matches;
+    long matches;
+} traversal_state;
+
+// Finds the images of the patients whose names start with DOE^P1, as
+// the first query does
+static MC_TRAVERSAL_STATUS match_record( int RecordID, void* UserData )
+{
+    traversal_state* state = (traversal_state*)UserData;
+    MC_DIR_RECORD_TYPE type = MC_REC_TYPE_UNKNOWN;
+    MC_TRAVERSAL_STATUS ret = MC_TS_CONTINUE;
+
+    MC_DDH_Get_Record_Type( RecordID, &type );
+    if( type == MC_REC_TYPE_PATIENT )
+    {
+        char name[128] = "";
+        MC_Get_Value_To_String( RecordID,
+                                MC_ATT_PATIENTS_NAME,
+                                sizeof(name),
+                                name );
+        state->patient_matches = strncmp( name, "DOE^P1", 6 ) == 0;
+        ret = state->patient_matches ? MC_TS_CONTINUE : MC_TS_STOP_LOWER;
+    }
+    else if( type == MC_REC_TYPE_IMAGE && state->patient_matches )
+    {
+        ++state->matches;
+    }
+    else
+    {
+        // Do nothing. Not a matching record
+    }
+
+    return ret;
+}
+
+static int run_traversal( int dirid, const char* name )
+{
+    traversal_state state = { 0, 0 };
+    double best = 0.0;
+    int ok = 1;
+
+    for( int run = 0; ok && run < RUNS; ++run )
+    {
+        state.patient_matches = 0;
+        state.matches = 0;
+        const double start = now_ms();
+        ok = check( MC_DDH_Traverse_Records( dirid, &state, match_record ),
+                    "MC_DDH_Traverse_Records" );
+        const double elapsed = now_ms() - start;
+        best = ( run == 0 || elapsed < best ) ? elapsed : best;
+    }
+
+    if( ok )
+    {
+        printf( "%-36s %6ld matches %8.2f ms\n", name, state.matches, best );
+    }
+    else
+    {
+        // Do nothing. Error already printed
+    }
+
+    return ok;
+}
+
+int main( int argc, char* argv[] )
+{
+    const char* path = argc > 1 ? argv[1] : "DICOMDIR";
+    const query_keys name_wildcard =
+        { "IMAGE",
+          { MC_ATT_PATIENTS_NAME, 0 },
+          { "DOE^P1*", NULL } };
+    const query_keys name_and_description =
+        { "SERIES",
+          { MC_ATT_PATIENTS_NAME, MC_ATT_STUDY_DESCRIPTION },
+          { "DOE^P4?", "STUDY 1" } };
+    const query_keys series_uid =
+        { "IMAGE",
+          { MC_ATT_SERIES_INSTANCE_UID, 0 },
+          { "1.2.8.5.1.3", NULL } };
+    const query_keys study_uid_list =
+        { "IMAGE",
+          { MC_ATT_STUDY_INSTANCE_UID, 0 },
+          { "1.2.7.1.1\\1.2.7.50.0\\1.2.7.99.1", NULL } };
+    const query_keys date_range_and_number =
+        { "IMAGE",
+          { MC_ATT_STUDY_DATE, MC_ATT_INSTANCE_NUMBER },
+          { "20240101-20241231", "7" } };
+    int dirid = 0;
+    int ok = check( MC_Library_Initialization( NULL, NULL, NULL ),
+                    "MC_Library_Initialization" );
+
+    ok = ok && write_bench_dicomdir( path );
+    ok = ok && check( MC_DDH_Open( path, &dirid ), "MC_DDH_Open" );
+
+    // The first query reads the records, and the first one with an
+    // indexed key builds the index
+    int itemid = 0;
+    long matches = 0;
+    double start = now_ms();
+    ok = ok && open_query( &name_wildcard, &itemid );
+    ok = ok && check( MC_DDH_Query_Records( dirid,
+                                            itemid,
+                                            &matches,
+                                            count_record ),
+                      "MC_DDH_Query_Records" );
+    if( ok )
+    {
+        printf( "%-36s %6ld matches %8.2f ms\n",
+                "name wildcard, reading records",
+                matches,
+                now_ms() - start );
+    }
+    else
+    {
+        // Do nothing. Error already printed
+    }
+
+    if( itemid != 0 )
+    {
+        MC_Free_Item( &itemid );
+    }
+    else
+    {
+        // Do nothing. Not opened
+    }
+
+    matches = 0;
+    start = now_ms();
+    ok = ok && open_query( &series_uid, &itemid );
+    ok = ok && check( MC_DDH_Query_Records( dirid,
+                                            itemid,
+                                            &matches,
+                                            count_record ),
+                      "MC_DDH_Query_Records" );
+    if( ok )
+    {
+        printf( "%-36s %6ld matches %8.2f ms\n",
+                "series UID, building the index",
+                matches,
+                now_ms() - start );
+    }
+    else
+    {
+        // Do nothing. Error already printed
+    }
+
+    if( itemid != 0 )
+    {
+        MC_Free_Item( &itemid );
+    }
+    else
+    {
+        // Do nothing. Not opened
+    }
+
+    ok = ok && run_query( dirid, "name wildcard -> images", &name_wildcard );
+    ok = ok && run_query( dirid,
+                          "name ? + description -> series",
+                          &name_and_description );
+    ok = ok && run_query( dirid, "series UID -> images", &series_uid );
+    ok = ok && run_query( dirid,
+                          "list of 3 study UIDs -> images",
+                          &study_uid_list );
+    ok = ok && run_query( dirid,
+                          "date range + number -> images",
+                          &date_range_and_number );
+    ok = ok && run_traversal( dirid, "name prefix by traversal -> images" );
+
+    if( dirid != 0 )
+    {
+        MC_Free_File( &dirid );
+    }
+    else
+    {
+        // Do nothing. Not opened
+    }
+    MC_Library_Release();
+
+    return ok ? 0 : 1;
+}
@@ -89,6 +89,27 @@ typedef MC_STATUS (*ReadFileCallback)
     int*   CbisLastPtr
 );
 
+typedef enum
+{
+    MC_PARSE_START_ELEMENT,
+    MC_PARSE_VALUE_DATA,
+    MC_PARSE_START_SEQUENCE,
+    MC_PARSE_END_SEQUENCE,
+    MC_PARSE_START_ITEM,
+    MC_PARSE_END_ITEM
+} MC_PARSE_EVENT;
+
+typedef MC_STATUS (*ParseEventCallback)
+(
+    void*          CbuserInfo,
+    MC_PARSE_EVENT Cbevent,
+    unsigned long  Cbtag,
+    MC_VR          Cbvr,
+    unsigned long  Cblength,
+    void*          CbdataBuffer,
+    int            CbisLast
+);
+
 typedef MC_TRAVERSAL_STATUS (*DDHTraverseCallback)
 (
     int   CurrentRecID,
@@ -120,6 +141,25 @@ MCEXPORT MC_STATUS MC_Open_File_Upto_Tag( int              ApplicationID,
                                           long*            Offset,
                                           ReadFileCallback YourFromMediaFunction );
 
+MCEXPORT MC_STATUS MC_Open_File_Filtered( int                  ApplicationID,
+                                          int                  FileID,
+                                          void*                UserInfo,
+                                          const unsigned long* FirstTags,
+                                          const unsigned long* LastTags,
+                                          int                  NumRanges,
+                                          ReadFileCallback     YourFromMediaFunction );
+
+// Like MC_Open_File, but large OB, OW and OD values are left in the file
+// and re-read through YourFromMediaFunction when they are accessed or
+// written. YourFromMediaFunction and UserInfo must therefore remain valid
+// until the file object is freed, or until every value read from the
+// file has been freed or replaced. Writing the file back over the file it
+// was opened from reads the referenced values into memory first
+MCEXPORT MC_STATUS MC_Open_File_Bulk_Reference( int              ApplicationID,
+                                               int              FileID,
+                                               void*            UserInfo,
+                                               ReadFileCallback YourFromMediaFunction );
+
 MCEXPORT MC_STATUS MC_Write_File( int               FileID,
                                   int               NumBytes,
                                   void*             UserInfo,
@@ -131,6 +171,46 @@ MCEXPORT MC_STATUS MC_Write_File_By_Callback( int               ApplicationID,
                                               void*             UserInfo,
                                               WriteFileCallback YourToMediaFunction );
 
+MCEXPORT MC_STATUS MC_Open_File_Cursor( int*             CursorIDPtr,
+                                        int              ApplicationID,
+                                        int              FileID,
+                                        void*            UserInfo,
+                                        ReadFileCallback YourFromMediaFunction );
+
+MCEXPORT MC_STATUS MC_Cursor_Next_Element( int            CursorID,
+                                           unsigned long* TagPtr,
+                                           MC_VR*         VrPtr,
+                                           unsigned long* LengthPtr );
+
+MCEXPORT MC_STATUS MC_Cursor_Get_Value( int            CursorID,
+                                        const void**   BufferPtr,
+                                        unsigned long* SizePtr );
+
+MCEXPORT MC_STATUS MC_Cursor_Descend( int CursorID );
+
+MCEXPORT MC_STATUS MC_Cursor_Ascend( int CursorID );
+
+MCEXPORT MC_STATUS MC_Close_Cursor( int* CursorID );
+
+MCEXPORT MC_STATUS MC_Parse_File( int                ApplicationID,
+                                  int                FileID,
+                                  void*              ReadUserInfo,
+                                  ReadFileCallback   YourFromMediaFunction,
+                                  void*              EventUserInfo,
+                                  ParseEventCallback YourEventFunction );
+
+MCEXPORT MC_STATUS MC_Patch_File_Value( int           ApplicationID,
+                                        int           FileID,
+                                        unsigned long Tag );
+
+MCEXPORT MC_STATUS MC_Transcode_File( int               ApplicationID,
+                                      int               FileID,
+                                      TRANSFER_SYNTAX   Syntax,
+                                      void*             ReadUserInfo,
+                                      ReadFileCallback  YourFromMediaFunction,
+                                      void*             WriteUserInfo,
+                                      WriteFileCallback YourToMediaFunction );
+
 MCEXPORT MC_STATUS MC_Validate_File( int       FileID,
                                      VAL_ERR** ErrorInfo,
                                      VAL_LEVEL ErrorLevel );
@@ -165,6 +245,8 @@ MCEXPORT MC_STATUS MC_DDH_Copy_Values( int            SourceID,
                                        int            DestID,
                                        unsigned long* TagList );
 
+MCEXPORT MC_STATUS MC_DDH_Copy_Record_Keys( int SourceID, int RecordID );
+
 MCEXPORT MC_STATUS MC_DDH_Add_Record( int         ParentID,
                                       const char* RecordType,
                                       int*        RecordID );
@@ -173,6 +255,21 @@ MCEXPORT MC_STATUS MC_DDH_Delete_Record( int RecordID );
 
 MCEXPORT MC_STATUS MC_DDH_Release_Record( int RecordID );
 
+MCEXPORT MC_STATUS MC_DDH_Find_Record( int           DirMsgID,
+                                       unsigned long Tag,
+                                       const char*   Value,
+                                       int*          RecordID );
+
+MCEXPORT MC_STATUS MC_DDH_Add_Directory( int         DirMsgID,
+                                         const char* DirectoryPath,
+                                         int         NumThreads,
+                                         int*        FilesAdded );
+
+MCEXPORT MC_STATUS MC_DDH_Query_Records( int                 DirMsgID,
+                                         int                 QueryID,
+                                         void*               UserData,
+                                         DDHTraverseCallback YourQueryCallback );
+
 #ifdef __cplusplus
 }
 #endif
@@ -306,6 +306,7 @@ typedef enum
 
 typedef enum
 { 
+    ARENA_BLOCK_SIZE,
     ARTIM_TIMEOUT,
     ASSOC_REPLY_TIMEOUT,
     COMPRESSION_CHROM_FACTOR,
@@ -314,6 +315,7 @@ typedef enum
     COMPRESSION_LUM_FACTOR,
     CONNECT_TIMEOUT,
     DEFLATE_COMPRESSION_LEVEL,
+    DEFLATE_THREADS,
     DESIRED_LAST_PDU_SIZE,
     FLATE_GROW_OUTPUT_BUF_SIZE,
     IGNORE_JPEG_BAD_SUFFIX,
@@ -327,7 +329,9 @@ typedef enum
     MAX_PENDING_CONNECTIONS,
     NUM_HISTORICAL_LOG_FILES,
     NUMBER_OF_CAP_FILES,
+    OBJECT_POOL_SIZE,
     OBOW_BUFFER_SIZE,
+    READ_SQ_DEPTH_LIMIT,
     RELEASE_TIMEOUT,
     TCPIP_LISTEN_PORT,
     TCPIP_RECEIVE_BUFFER_SIZE,
@@ -433,6 +437,15 @@ typedef struct
     MC_STATUS     Status;
 } VAL_ERR;
 
+typedef struct
+{
+    unsigned long Hits;
+    unsigned long Misses;
+    unsigned long Recycled;
+    unsigned long Discarded;
+    unsigned long Pooled;
+} POOL_STATS;
+
 typedef MC_STATUS (*SetValueCallback)
 (
     int           CBMsgFileItemID,
@@ -465,6 +478,21 @@ MCEXPORT MC_STATUS MC_Library_Initialization( CfgFunction        cfg,
 
 MCEXPORT MC_STATUS MC_Library_Release();
 
+MCEXPORT MC_STATUS MC_Get_Object_Pool_Stats( POOL_STATS* StatsPtr );
+
+/**
+ * Gets and sets the int configuration values (eg. DEFLATE_THREADS or
+ * OBJECT_POOL_SIZE). A value set after objects have been opened applies
+ * to the next read or write which uses it.
+ *
+ * ARENA_BLOCK_SIZE is the size of the blocks the values read into a file
+ * are allocated from (64KB by default). Setting it to 0 allocates every
+ * value from the heap instead
+ */
+MCEXPORT MC_STATUS MC_Get_Int_Config_Value( IntParm Parm, int* Value );
+
+MCEXPORT MC_STATUS MC_Set_Int_Config_Value( IntParm Parm, int Value );
+
 /**
  * Clears all existing values in the message and sets the first one
  */
@@ -777,6 +805,11 @@ MCEXPORT MC_STATUS MC_Delete_Range( int           MsgFileItemID,
                                     unsigned long FirstTag,
                                     unsigned long LastTag );
 
+MCEXPORT MC_STATUS MC_Move_Range( int           SourceMsgFileItemID,
+                                  int           DestMsgFileItemID,
+                                  unsigned long FirstTag,
+                                  unsigned long LastTag );
+
 MCEXPORT MC_STATUS MC_Add_Standard_Attribute( int           MsgFileItemID,
                                               unsigned long tag );
 
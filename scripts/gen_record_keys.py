@@ -0,0 +1,54 @@
+#!/usr/bin/python
+
+from Cheetah.Template import Template
+import re
+
+tag_re = re.compile('\\(([0-9A-F]{4}),([0-9A-F]{4})\\)')
+
+def parse_tag(tag):
+    m = tag_re.match(tag)
+    return int( "0x%s%s" % (m.group(1), m.group(2)), 16 )
+
+def parse_record_keys(record_keys):
+    ret = {}
+
+    for row in record_keys:
+        ret.setdefault(row['Record Type'], set()).add(parse_tag(row['Tag']))
+
+    # Keys are sorted so the values of a record can be copied in a single
+    # pass over the source
+    return sorted((record_type, sorted(tags))
+                  for (record_type, tags) in ret.iteritems())
+
+def format_tag(tag):
+    return "0x%08xu" % (tag)
+
+def format_enum(record_type):
+    return "MC_REC_TYPE_%s" % (record_type.replace(' ', '_'))
+
+def format_array(record_type):
+    return "%s_KEYS" % (record_type.replace(' ', '_'))
+
+class gen_record_keys(Template):
+    def __init__(self, record_keys):
+        self.__record_keys = parse_record_keys(record_keys)
+
+    def record_keys(self):
+        return self.__record_keys
+
+def main(args):
+    from csv import DictReader
+    from record_keys_cpp import record_keys_cpp
+
+    # Key attributes of each record type auto-generated from the standard
+    # document
+    record_keys = DictReader(open(args[0], "r"))
+
+    keys_tmpl = record_keys_cpp(record_keys)
+
+    with open("../src/fume/record_keys.cpp", "w") as record_keys_file:
+        record_keys_file.write(str(keys_tmpl))
+
+if __name__ == "__main__":
+    import sys
+    main(sys.argv[1:])
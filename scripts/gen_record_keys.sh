@@ -0,0 +1,6 @@
+#!/bin/bash
+
+cheetah-2.7 compile ../cheetah/*.tmpl
+mv ../cheetah/*.py ./
+
+exec ./gen_record_keys.py ../definitions/record_keys.csv
\ No newline at end of file
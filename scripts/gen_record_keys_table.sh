@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Download the DocBook version of PS3.3 used by this script
+if [ ! -e ../extern/DICOM/part03.xml ]
+then
+    curl -o ../extern/DICOM/part03.xml 'http://dicom.nema.org/medical/dicom/current/source/docbook/part03/part03.xml'
+fi
+
+# Caption of the keys table in PS3.3 Annex F.5 and the Directory Record
+# Type it describes
+RECORD_KEYS_TABLES=(
+    "Patient Keys|PATIENT"
+    "Study Keys|STUDY"
+    "Series Keys|SERIES"
+    "Image Keys|IMAGE"
+    "RT Dose Keys|RT DOSE"
+    "RT Structure Set Keys|RT STRUCTURE SET"
+    "RT Plan Keys|RT PLAN"
+    "RT Treatment Record Keys|RT TREAT RECORD"
+    "Presentation Keys|PRESENTATION"
+    "Waveform Keys|WAVEFORM"
+    "SR Document Keys|SR DOCUMENT"
+    "Key Object Document Keys|KEY OBJECT DOC"
+    "Spectroscopy Keys|SPECTROSCOPY"
+    "Raw Data Keys|RAW DATA"
+    "Registration Keys|REGISTRATION"
+    "Fiducial Keys|FIDUCIAL"
+    "Hanging Protocol Keys|HANGING PROTOCOL"
+    "Encapsulated Document Keys|ENCAP DOC"
+    "HL7 Structured Document Keys|HL7 STRUC DOC"
+    "Real World Value Mapping Keys|VALUE MAP"
+    "Stereometric Relationship Keys|STEREOMETRIC"
+    "Measurement Keys|MEASUREMENT"
+    "Surface Keys|SURFACE"
+    "Surface Scan Keys|SURFACE SCAN"
+    "Color Palette Keys|PALETTE"
+    "Implant Keys|IMPLANT"
+    "Implant Assembly Keys|IMPLANT ASSY"
+    "Implant Group Keys|IMPLANT GROUP"
+    "Tractography Keys|TRACT"
+    "Assessment Keys|ASSESSMENT"
+)
+
+echo '"Record Type","Tag","Attribute Name","Type"'
+for table in "${RECORD_KEYS_TABLES[@]}"
+do
+    xsltproc --stringparam caption "${table%%|*}" \
+             --stringparam record_type "${table##*|}" \
+             ../xslt/docbook_to_record_keys.xslt ../extern/DICOM/part03.xml
+done
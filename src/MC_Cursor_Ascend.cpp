@@ -0,0 +1,54 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+/// local private
+#include "fume/library_context.h"
+#include "fume/file_cursor.h"
+
+using fume::g_context;
+using fume::file_cursor;
+
+MC_STATUS MC_Cursor_Ascend( int CursorID )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr )
+        {
+            file_cursor* cursor = g_context->get_cursor( CursorID );
+            if( cursor != nullptr )
+            {
+                ret = cursor->cursor().ascend();
+            }
+            else
+            {
+                ret = MC_INVALID_FILE_ID;
+            }
+        }
+        else
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
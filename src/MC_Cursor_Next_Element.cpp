@@ -0,0 +1,78 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+/// local private
+#include "fume/library_context.h"
+#include "fume/file_cursor.h"
+
+using fume::g_context;
+using fume::file_cursor;
+
+MC_STATUS MC_Cursor_Next_Element( int            CursorID,
+                                  unsigned long* TagPtr,
+                                  MC_VR*         VrPtr,
+                                  unsigned long* LengthPtr )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr &&
+            TagPtr    != nullptr &&
+            VrPtr     != nullptr &&
+            LengthPtr != nullptr )
+        {
+            file_cursor* cursor = g_context->get_cursor( CursorID );
+            if( cursor != nullptr )
+            {
+                uint32_t tag = 0;
+                MC_VR vr = UNKNOWN_VR;
+                uint32_t length = 0;
+                ret = cursor->cursor().next( tag, vr, length );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    *TagPtr = tag;
+                    *VrPtr = vr;
+                    *LengthPtr = length;
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else
+            {
+                ret = MC_INVALID_FILE_ID;
+            }
+        }
+        else if( g_context == nullptr )
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+        else
+        {
+            ret = MC_NULL_POINTER_PARM;
+        }
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
@@ -0,0 +1,82 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <string>
+#include <thread>
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+// local private
+#include "fume/library_context.h"
+#include "fume/dicomdir_object.h"
+#include "fume/dicomdir_builder.h"
+
+using std::string;
+using std::thread;
+
+using fume::g_context;
+using fume::dicomdir_object;
+using fume::add_directory_records;
+
+MC_STATUS MC_DDH_Add_Directory( int         DirMsgID,
+                                const char* DirectoryPath,
+                                int         NumThreads,
+                                int*        FilesAdded )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr &&
+            DirectoryPath != nullptr &&
+            FilesAdded != nullptr )
+        {
+            dicomdir_object* dicomdir =
+                dynamic_cast<dicomdir_object*>( g_context->find_object( DirMsgID ) );
+            if( dicomdir != nullptr )
+            {
+                // Use every core if the number of threads isn't given.
+                // hardware_concurrency may not know the number of cores
+                const unsigned int cores = thread::hardware_concurrency();
+                const size_t num_threads =
+                    NumThreads > 0 ? static_cast<size_t>( NumThreads ) :
+                    cores > 0u     ? static_cast<size_t>( cores ) :
+                                     1u;
+
+                ret = add_directory_records( *dicomdir,
+                                             string( DirectoryPath ),
+                                             num_threads,
+                                             *FilesAdded );
+            }
+            else
+            {
+                ret = MC_INVALID_DICOMDIR_ID;
+            }
+        }
+        else if( g_context == nullptr )
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+        else
+        {
+            ret = MC_NULL_POINTER_PARM;
+        }
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
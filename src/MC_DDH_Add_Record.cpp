@@ -20,109 +20,21 @@
 #include "fume/library_context.h"
 #include "fume/dicomdir_object.h"
 #include "fume/record_object.h"
-#include "fume/value_representation.h"
 
 using fume::g_context;
 using fume::dicomdir_object;
 using fume::record_object;
 using fume::data_dictionary;
-using fume::value_representation;
-
-template<class RecordType>
-MC_STATUS append_record( RecordType& parent, int child_id )
-{
-    MC_STATUS ret = MC_NORMAL_COMPLETION;
-
-    int next = parent.get_child_record();
-    record_object* child = nullptr;
-    while( ret == MC_NORMAL_COMPLETION && next > 0 )
-    {
-        child = dynamic_cast<record_object*>( g_context->get_object( next ) );
-        if( child != nullptr )
-        {
-            next = child->get_next_record();
-        }
-        else
-        {
-            ret = MC_INVALID_RECORD_ID;
-        }
-    }
-
-    if( ret == MC_NORMAL_COMPLETION )
-    {
-        if( child == nullptr )
-        {
-            // No child elements in chain
-            ret = parent.set_child_record( child_id );
-        }
-        else
-        {
-            ret = child->set_next_record( child_id );
-        }
-    }
-
-    return ret;
-}
-
-template<class RecordType>
-int add_record( dicomdir_object& file_obj,
-                RecordType&      parent,
-                const char*      record_type )
-{
-    int record_id = g_context->create_record_object( file_obj.id(),
-                                                     parent.id(),
-                                                     record_type );
-    if( record_id > 0 )
-    {
-        MC_STATUS stat = append_record( parent, record_id );
-        if( stat == MC_NORMAL_COMPLETION )
-        {
-            value_representation* sequence =
-                file_obj.at( MC_ATT_DIRECTORY_RECORD_SEQUENCE );
-            if( sequence != nullptr )
-            {
-                if( sequence->is_null() == false )
-                {
-                    stat = sequence->set_next( record_id );
-                }
-                else
-                {
-                    stat = sequence->set( record_id );
-                }
-
-                if( stat != MC_NORMAL_COMPLETION )
-                {
-                    record_id = -static_cast<int>( stat );
-                }
-                else
-                {
-                    // Do nothing. Success
-                }
-            }
-            else
-            {
-                record_id = -static_cast<int>( MC_INVALID_TAG );
-            }
-        }
-        else
-        {
-            record_id = -static_cast<int>( stat );
-        }
-    }
-    else
-    {
-        // Do nothing. Will return error
-    }
-
-    return record_id;
-}
 
 static const char* get_child_record_type( record_object& parent )
 {
     const char* ret = nullptr;
 
+    // The parent is looked up without reading its values, since they
+    // are only needed here
     MC_DIR_RECORD_TYPE parent_type = MC_REC_TYPE_UNKNOWN;
-    if( parent.get_record_type( parent_type ) == MC_NORMAL_COMPLETION )
+    if( parent.load_values() == MC_NORMAL_COMPLETION &&
+        parent.get_record_type( parent_type ) == MC_NORMAL_COMPLETION )
     {
         switch( parent_type )
         {
@@ -156,7 +68,7 @@ MC_STATUS MC_DDH_Add_Record( int ParentID, const char* RecordType, int* RecordID
     {
         if( g_context != nullptr && RecordID != nullptr )
         {
-            data_dictionary* dict = g_context->get_object( ParentID );
+            data_dictionary* dict = g_context->find_object( ParentID );
             if( dict != nullptr )
             {
                 dicomdir_object* dicomdir = dynamic_cast<dicomdir_object*>( dict );
@@ -175,18 +87,7 @@ MC_STATUS MC_DDH_Add_Record( int ParentID, const char* RecordType, int* RecordID
                         // Do nothing. RecordType already provided
                     }
 
-                    const int record_id = add_record( *dicomdir,
-                                                      *dicomdir,
-                                                      RecordType );
-                    if( record_id > 0 )
-                    {
-                        *RecordID = record_id;
-                        ret = MC_NORMAL_COMPLETION;
-                    }
-                    else
-                    {
-                        ret = static_cast<MC_STATUS>( -record_id );
-                    }
+                    ret = dicomdir->add_record( nullptr, RecordType, *RecordID );
                 }
                 else if( record != nullptr )
                 {
@@ -206,18 +107,7 @@ MC_STATUS MC_DDH_Add_Record( int ParentID, const char* RecordType, int* RecordID
                             // Do nothing. RecordType already initialized
                         }
 
-                        const int record_id = add_record( *dicomdir,
-                                                          *record,
-                                                          RecordType );
-                        if( record_id > 0 )
-                        {
-                            *RecordID = record_id;
-                            ret = MC_NORMAL_COMPLETION;
-                        }
-                        else
-                        {
-                            ret = static_cast<MC_STATUS>( -record_id );
-                        }
+                        ret = dicomdir->add_record( record, RecordType, *RecordID );
                     }
                     else
                     {
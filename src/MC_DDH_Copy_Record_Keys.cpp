@@ -0,0 +1,81 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+// local private
+#include "fume/library_context.h"
+#include "fume/data_dictionary.h"
+#include "fume/dicomdir_object.h"
+#include "fume/record_object.h"
+
+using fume::g_context;
+using fume::data_dictionary;
+using fume::dicomdir_object;
+using fume::record_object;
+
+MC_STATUS MC_DDH_Copy_Record_Keys( int SourceID, int RecordID )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr )
+        {
+            data_dictionary* const source = g_context->get_object( SourceID );
+            record_object* const record =
+                dynamic_cast<record_object*>( g_context->get_object( RecordID ) );
+            if( source != nullptr && record != nullptr )
+            {
+                ret = record->copy_keys( *source );
+
+                dicomdir_object* const dicomdir =
+                    ret == MC_NORMAL_COMPLETION ?
+                    dynamic_cast<dicomdir_object*>
+                    (
+                        g_context->find_object( record->get_dicomdir_file_id() )
+                    ) :
+                    nullptr;
+                if( dicomdir != nullptr )
+                {
+                    // The values the record is indexed by may have changed
+                    dicomdir->record_changed( RecordID );
+                }
+                else
+                {
+                    // Do nothing. Will return error or the DICOMDIR is gone
+                }
+            }
+            else if( source == nullptr )
+            {
+                ret = MC_INVALID_MESSAGE_ID;
+            }
+            else
+            {
+                ret = MC_INVALID_RECORD_ID;
+            }
+        }
+        else
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
@@ -10,6 +10,8 @@
  */
 
 // std
+#include <cstddef>
+#include <cstdint>
 
 // local public
 #include "mcstatus.h"
@@ -18,11 +20,50 @@
 // local private
 #include "fume/library_context.h"
 #include "fume/data_dictionary_search.h"
+#include "fume/dicomdir_object.h"
+#include "fume/record_object.h"
 
 using fume::g_context;
 using fume::data_dictionary;
+using fume::dicomdir_object;
+using fume::record_object;
 using fume::copy_values;
 
+// Whether the copy would replace a value dest maintains itself. A NULL
+// TagList copies every value, and a group length tag every value of its
+// group
+static bool copies_managed_value( const data_dictionary& dest,
+                                  const unsigned long*   TagList )
+{
+    bool ret = false;
+
+    if( TagList != nullptr )
+    {
+        for( size_t i = 0; ret == false && TagList[i] != 0; ++i )
+        {
+            if( TagList[i] > 0xFFFFFFFFul )
+            {
+                // Do nothing. Not a tag, so nothing is copied
+            }
+            else if( (TagList[i] & 0x0000FFFFul) == 0 )
+            {
+                const uint32_t group = static_cast<uint32_t>( TagList[i] );
+                ret = dest.is_managed_range( group, group | 0x0000FFFFu );
+            }
+            else
+            {
+                ret = dest.is_managed_tag( static_cast<uint32_t>( TagList[i] ) );
+            }
+        }
+    }
+    else
+    {
+        ret = dest.is_managed_range( 0x00000000u, 0xFFFFFFFFu );
+    }
+
+    return ret;
+}
+
 MC_STATUS MC_DDH_Copy_Values( int SourceID, int DestID, unsigned long* TagList )
 {
     MC_STATUS ret = MC_CANNOT_COMPLY;
@@ -33,10 +74,34 @@ MC_STATUS MC_DDH_Copy_Values( int SourceID, int DestID, unsigned long* TagList )
         {
             data_dictionary* src = g_context->get_object( SourceID );
             data_dictionary* dst = g_context->get_object( DestID );
-            if( src != nullptr && dst != nullptr )
+            if( src != nullptr &&
+                dst != nullptr &&
+                copies_managed_value( *dst, TagList ) == true )
+            {
+                ret = MC_INVALID_TAG;
+            }
+            else if( src != nullptr && dst != nullptr )
             {
                 copy_values( *dst, *src, TagList );
                 ret = MC_NORMAL_COMPLETION;
+
+                record_object* record = dynamic_cast<record_object*>( dst );
+                dicomdir_object* dicomdir =
+                    record != nullptr ?
+                    dynamic_cast<dicomdir_object*>
+                    (
+                        g_context->find_object( record->get_dicomdir_file_id() )
+                    ) :
+                    nullptr;
+                if( dicomdir != nullptr )
+                {
+                    // The values the record is indexed by may have changed
+                    dicomdir->record_changed( DestID );
+                }
+                else
+                {
+                    // Do nothing. Not a record
+                }
             }
             else
             {
@@ -0,0 +1,87 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <string>
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+// local private
+#include "fume/library_context.h"
+#include "fume/dicomdir_object.h"
+#include "fume/record_index.h"
+
+using std::string;
+
+using fume::g_context;
+using fume::dicomdir_object;
+using fume::record_index;
+
+MC_STATUS MC_DDH_Find_Record( int           DirMsgID,
+                              unsigned long Tag,
+                              const char*   Value,
+                              int*          RecordID )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr && Value != nullptr && RecordID != nullptr )
+        {
+            dicomdir_object* dicomdir =
+                dynamic_cast<dicomdir_object*>( g_context->find_object( DirMsgID ) );
+            if( dicomdir != nullptr &&
+                record_index::is_key( static_cast<uint32_t>( Tag ) ) == true )
+            {
+                int record_id = 0;
+                ret = dicomdir->find_record( static_cast<uint32_t>( Tag ),
+                                             string( Value ),
+                                             record_id );
+                if( ret == MC_NORMAL_COMPLETION && record_id > 0 )
+                {
+                    *RecordID = record_id;
+                }
+                else if( ret == MC_NORMAL_COMPLETION )
+                {
+                    ret = MC_NOT_FOUND;
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else if( dicomdir != nullptr )
+            {
+                ret = MC_INVALID_TAG;
+            }
+            else
+            {
+                ret = MC_INVALID_DICOMDIR_ID;
+            }
+        }
+        else if( g_context == nullptr )
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+        else
+        {
+            ret = MC_NULL_POINTER_PARM;
+        }
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
@@ -35,7 +35,7 @@ MC_STATUS MC_DDH_Get_First_Lower_Record( int ParentID, int* LowerID )
     {
         if( g_context != nullptr && LowerID != nullptr )
         {
-            data_dictionary* dict = g_context->get_object( ParentID );
+            data_dictionary* dict = g_context->find_object( ParentID );
             if( dict != nullptr )
             {
                 dicomdir_object* dicomdir = dynamic_cast<dicomdir_object*>( dict );
@@ -35,7 +35,7 @@ MC_STATUS MC_DDH_Get_Next_Record( int RecordID, int* NextID )
     {
         if( g_context != nullptr && NextID != nullptr )
         {
-            data_dictionary* dict = g_context->get_object( RecordID );
+            data_dictionary* dict = g_context->find_object( RecordID );
             if( dict != nullptr )
             {
                 dicomdir_object* dicomdir = dynamic_cast<dicomdir_object*>( dict );
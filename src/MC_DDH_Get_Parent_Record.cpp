@@ -33,7 +33,7 @@ MC_STATUS MC_DDH_Get_Parent_Record( int RecordID, int* ParentID )
     {
         if( g_context != nullptr && ParentID != nullptr )
         {
-            data_dictionary* dict = g_context->get_object( RecordID );
+            data_dictionary* dict = g_context->find_object( RecordID );
             if( dict != nullptr )
             {
                 dicomdir_object* dicomdir = dynamic_cast<dicomdir_object*>( dict );
@@ -16,6 +16,11 @@
 #include "mc3media.h"
 
 // local private
+#include "fume/library_context.h"
+#include "fume/dicomdir_object.h"
+
+using fume::g_context;
+using fume::dicomdir_object;
 
 MC_STATUS MC_DDH_Open( const char* FilePath, int* DirMsgIDPtr )
 {
@@ -23,7 +28,42 @@ MC_STATUS MC_DDH_Open( const char* FilePath, int* DirMsgIDPtr )
 
     try
     {
-        // TODO: implement
+        if( g_context   != nullptr &&
+            FilePath    != nullptr &&
+            DirMsgIDPtr != nullptr )
+        {
+            const int dicomdir_id =
+                g_context->create_dicomdir_object( FilePath, nullptr, nullptr );
+            if( dicomdir_id > 0 )
+            {
+                dicomdir_object* dicomdir =
+                    dynamic_cast<dicomdir_object*>
+                    (
+                        g_context->get_object( dicomdir_id )
+                    );
+                ret = dicomdir != nullptr ? dicomdir->open() : MC_SYSTEM_ERROR;
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    *DirMsgIDPtr = dicomdir_id;
+                }
+                else
+                {
+                    (void)g_context->free_file_object( dicomdir_id );
+                }
+            }
+            else
+            {
+                ret = static_cast<MC_STATUS>( -dicomdir_id );
+            }
+        }
+        else if( g_context == nullptr )
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+        else
+        {
+            ret = MC_NULL_POINTER_PARM;
+        }
     }
     catch( ... )
     {
@@ -0,0 +1,125 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+// local private
+#include "fume/library_context.h"
+#include "fume/dicomdir_object.h"
+#include "fume/record_query.h"
+
+using std::vector;
+
+using fume::g_context;
+using fume::data_dictionary;
+using fume::dicomdir_object;
+using fume::query_records;
+
+static MC_STATUS report_records( const vector<int>&  record_ids,
+                                 void*               user_data,
+                                 DDHTraverseCallback callback )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    bool stop = false;
+    for( vector<int>::const_iterator itr = record_ids.cbegin();
+         ret == MC_NORMAL_COMPLETION && stop == false && itr != record_ids.cend();
+         ++itr )
+    {
+        switch( callback( *itr, user_data ) )
+        {
+            case MC_TS_CONTINUE:
+            case MC_TS_STOP_LEVEL:
+            case MC_TS_STOP_LOWER:
+            {
+                // Do nothing. The matches aren't a tree
+                break;
+            }
+            case MC_TS_STOP:
+            {
+                stop = true;
+                break;
+            }
+            case MC_TS_ERROR:
+            {
+                ret = MC_CALLBACK_CANNOT_COMPLY;
+                break;
+            }
+            default:
+            {
+                ret = MC_CALLBACK_PARM_ERROR;
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+MC_STATUS MC_DDH_Query_Records( int                 DirMsgID,
+                                int                 QueryID,
+                                void*               UserData,
+                                DDHTraverseCallback YourQueryCallback )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr && YourQueryCallback != nullptr )
+        {
+            dicomdir_object* dicomdir =
+                dynamic_cast<dicomdir_object*>( g_context->find_object( DirMsgID ) );
+            data_dictionary* query = g_context->get_object( QueryID );
+            if( dicomdir != nullptr && query != nullptr )
+            {
+                // The whole search is done before any callback, so the
+                // callback may change or delete the records
+                vector<int> record_ids;
+                ret = query_records( *dicomdir, *query, record_ids );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    ret = report_records( record_ids, UserData, YourQueryCallback );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else if( dicomdir != nullptr )
+            {
+                ret = MC_INVALID_MESSAGE_ID;
+            }
+            else
+            {
+                ret = MC_INVALID_DICOMDIR_ID;
+            }
+        }
+        else if( g_context == nullptr )
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+        else
+        {
+            ret = MC_NULL_POINTER_PARM;
+        }
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
@@ -10,7 +10,9 @@
  */
 
 // std
-#include <deque>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 // local public
 #include "mcstatus.h"
@@ -21,81 +23,140 @@
 #include "fume/dicomdir_object.h"
 #include "fume/record_object.h"
 
-using std::deque;
+using std::shared_ptr;
+using std::vector;
 
 using fume::g_context;
 using fume::dicomdir_object;
 using fume::record_object;
 using fume::data_dictionary;
 
+// A record still to be traversed, and the record it is the next or first
+// lower record of. If records were freed since the pointer was read, the
+// link is read again from that record, or if it was freed as well the
+// record is looked up by ID
+struct pending_record
+{
+    const record_object* record;
+    int                  id;
+    int                  from_id;
+    bool                 lower;
+    uint64_t             deletion_count;
+};
+
+static pending_record make_pending( const record_object* record,
+                                    const record_object& from,
+                                    bool                 lower,
+                                    uint64_t             deletion_count )
+{
+    const pending_record ret = { record,
+                                 record != nullptr ? record->id() : 0,
+                                 from.id(),
+                                 lower,
+                                 deletion_count };
+    return ret;
+}
+
+static const record_object* find_record( const pending_record& pending )
+{
+    const record_object* ret = nullptr;
+
+    const record_object* const from =
+        dynamic_cast<const record_object*>( g_context->find_object( pending.from_id ) );
+    if( from != nullptr )
+    {
+        ret = pending.lower == true ? from->child_record() :
+                                      from->next_record();
+    }
+    else if( pending.record != nullptr )
+    {
+        ret = dynamic_cast<const record_object*>( g_context->find_object( pending.id ) );
+    }
+    else
+    {
+        // Do nothing. There was no such record
+    }
+
+    return ret;
+}
+
 template<class RecordType>
-MC_STATUS traverse_records( const RecordType&   parent,
-                            void*               user_data,
-                            DDHTraverseCallback callback )
+MC_STATUS traverse_records( const RecordType&                 parent,
+                            const shared_ptr<const uint64_t>& deletion_count,
+                            void*                             user_data,
+                            DDHTraverseCallback               callback )
 {
     MC_STATUS ret = MC_NORMAL_COMPLETION;
 
-    deque<int> children;
-    children.push_back( parent.get_child_record() );
+    // The records are followed through their links, so traversal doesn't
+    // look up each record in the library context. The callback may delete
+    // records though, so records are only looked up if records were freed
+    // since the pointer was read. A record deleted by the callback is
+    // skipped along with those below it
+    vector<pending_record> children;
+    const pending_record root = { parent.child_record(), 0, 0, true, *deletion_count };
+    children.push_back( root );
     while( ret == MC_NORMAL_COMPLETION && children.empty() == false )
     {
-        int child = children.back();
+        const pending_record pending = children.back();
         children.pop_back();
 
-        if( child > 0 )
+        const record_object* const child =
+            pending.deletion_count == *deletion_count ? pending.record :
+                                                        find_record( pending );
+
+        if( child != nullptr )
         {
-            const record_object* child_obj =
-                dynamic_cast<record_object*>( g_context->get_object( child ) );
-            if( child_obj != nullptr )
+            // Taken before the callback, which may delete the records
+            const pending_record next =
+                make_pending( child->next_record(), *child, false, *deletion_count );
+            const pending_record lower =
+                make_pending( child->child_record(), *child, true, *deletion_count );
+
+            MC_TRAVERSAL_STATUS stat = callback( child->id(), user_data );
+            switch( stat )
             {
-                MC_TRAVERSAL_STATUS stat = callback( child, user_data );
-                switch( stat )
+                case MC_TS_CONTINUE:
                 {
-                    case MC_TS_CONTINUE:
-                    {
-                        // Traverse the next record after traversing this
-                        // record's children
-                        children.push_back( child_obj->get_next_record() );
-                        children.push_back( child_obj->get_child_record() );
-                        break;
-                    }
-                    case MC_TS_STOP_LEVEL:
-                    {
-                        // Do nothing. will traverse parent's next item
-                        break;
-                    }
-                    case MC_TS_STOP_LOWER:
-                    {
-                        // Traverse the next record
-                        children.push_back( child_obj->get_next_record() );
-                        break;
-                    }
-                    case MC_TS_STOP:
-                    {
-                        // Remove all records to prematurely stop traversal
-                        children.clear();
-                        break;
-                    }
-                    case MC_TS_ERROR:
-                    {
-                        ret = MC_CALLBACK_CANNOT_COMPLY;
-                        break;
-                    }
-                    default:
-                    {
-                        ret = MC_CALLBACK_PARM_ERROR;
-                        break;
-                    }
+                    // Traverse the next record after traversing this
+                    // record's children
+                    children.push_back( next );
+                    children.push_back( lower );
+                    break;
+                }
+                case MC_TS_STOP_LEVEL:
+                {
+                    // Do nothing. will traverse parent's next item
+                    break;
+                }
+                case MC_TS_STOP_LOWER:
+                {
+                    // Traverse the next record
+                    children.push_back( next );
+                    break;
+                }
+                case MC_TS_STOP:
+                {
+                    // Remove all records to prematurely stop traversal
+                    children.clear();
+                    break;
+                }
+                case MC_TS_ERROR:
+                {
+                    ret = MC_CALLBACK_CANNOT_COMPLY;
+                    break;
+                }
+                default:
+                {
+                    ret = MC_CALLBACK_PARM_ERROR;
+                    break;
                 }
-            }
-            else
-            {
-                ret = MC_BAD_DIR_RECORD_TYPE;
             }
         }
         else
         {
-            // Do nothing. Will continue traversal
+            // Do nothing. No such record, or it was deleted. Will
+            // continue traversal
         }
     }
 
@@ -112,21 +173,35 @@ MC_STATUS MC_DDH_Traverse_Records( int                 RootID,
     {
         if( g_context != nullptr && YourTraverseCallback != nullptr )
         {
-            data_dictionary* dict = g_context->get_object( RootID );
+            data_dictionary* dict = g_context->find_object( RootID );
             if( dict != nullptr )
             {
                 dicomdir_object* dicomdir = dynamic_cast<dicomdir_object*>( dict );
                 record_object* record = dynamic_cast<record_object*>( dict );
 
-                if( dicomdir != nullptr )
+                if( record != nullptr )
                 {
-                    ret = traverse_records( *dicomdir,
+                    // The deletions counted are those of the record's
+                    // DICOMDIR
+                    dicomdir = dynamic_cast<dicomdir_object*>(
+                        g_context->find_object( record->get_dicomdir_file_id() ) );
+                }
+                else
+                {
+                    // Do nothing. Traversing from the root records
+                }
+
+                if( dicomdir != nullptr && record != nullptr )
+                {
+                    ret = traverse_records( *record,
+                                            dicomdir->get_deletion_count(),
                                             UserData,
                                             YourTraverseCallback );
                 }
-                else if( record != nullptr )
+                else if( dicomdir != nullptr )
                 {
-                    ret = traverse_records( *record,
+                    ret = traverse_records( *dicomdir,
+                                            dicomdir->get_deletion_count(),
                                             UserData,
                                             YourTraverseCallback );
                 }
@@ -137,7 +212,7 @@ MC_STATUS MC_DDH_Traverse_Records( int                 RootID,
             }
             else
             {
-                ret = ret = MC_INVALID_DICOMDIR_ID;
+                ret = MC_INVALID_DICOMDIR_ID;
             }
         }
         else if( g_context == nullptr )
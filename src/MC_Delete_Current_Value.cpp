@@ -41,8 +41,11 @@ MC_STATUS MC_Delete_Current_Value( int MsgFileItemID, unsigned long Tag )
             data_dictionary* dict = g_context->get_object( MsgFileItemID );
             if( dict != nullptr )
             {
+                const uint32_t tag_value = numeric_cast<uint32_t>( Tag );
                 value_representation* element =
-                    dict->at( numeric_cast<uint32_t>( Tag ) );
+                    dict->is_managed_tag( tag_value ) == false ?
+                    dict->at( tag_value ) :
+                    nullptr;
                 if( element != nullptr )
                 {
                     ret = element->delete_current();
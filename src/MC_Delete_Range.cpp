@@ -40,13 +40,18 @@ MC_STATUS MC_Delete_Range( int           MsgFileItemID,
         if( g_context != nullptr )
         {
             data_dictionary* dict = g_context->get_object( MsgFileItemID );
-            if( dict != nullptr )
+            const uint32_t first_tag = numeric_cast<uint32_t>( FirstTag );
+            const uint32_t last_tag = numeric_cast<uint32_t>( LastTag );
+            if( dict != nullptr &&
+                dict->is_managed_range( first_tag, last_tag ) == false )
             {
-                erase_range( *dict,
-                             numeric_cast<uint32_t>( FirstTag ),
-                             numeric_cast<uint32_t>( LastTag ) );
+                erase_range( *dict, first_tag, last_tag );
                 ret = MC_NORMAL_COMPLETION;
             }
+            else if( dict != nullptr )
+            {
+                ret = MC_INVALID_TAG;
+            }
             else
             {
                 ret = MC_INVALID_MESSAGE_ID;
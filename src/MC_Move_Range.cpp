@@ -0,0 +1,94 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+
+// boost
+#include "boost/numeric/conversion/cast.hpp"
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+
+// local private
+#include "fume/library_context.h"
+#include "fume/data_dictionary_search.h"
+
+using boost::numeric_cast;
+using boost::bad_numeric_cast;
+
+using fume::g_context;
+using fume::data_dictionary;
+using fume::move_values;
+using fume::range_contains;
+
+MC_STATUS MC_Move_Range( int           SourceMsgFileItemID,
+                         int           DestMsgFileItemID,
+                         unsigned long FirstTag,
+                         unsigned long LastTag )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr )
+        {
+            data_dictionary* src = g_context->get_object( SourceMsgFileItemID );
+            data_dictionary* dst = g_context->get_object( DestMsgFileItemID );
+            if( src != nullptr && dst != nullptr )
+            {
+                const uint32_t first_tag = numeric_cast<uint32_t>( FirstTag );
+                const uint32_t last_tag  = numeric_cast<uint32_t>( LastTag );
+                if( src == dst )
+                {
+                    // Nothing to move
+                    ret = MC_NORMAL_COMPLETION;
+                }
+                else if( src->is_managed_range( first_tag, last_tag ) == true ||
+                         dst->is_managed_range( first_tag, last_tag ) == true )
+                {
+                    ret = MC_INVALID_TAG;
+                }
+                // Only an item owned by a sequence can be inside one of
+                // the sequences being moved, which would leave it owning
+                // itself
+                else if( g_context->is_item_handle( DestMsgFileItemID ) == true &&
+                         range_contains( *src, first_tag, last_tag, *dst ) == true )
+                {
+                    ret = MC_INVALID_ITEM_ID;
+                }
+                else
+                {
+                    move_values( *dst, *src, first_tag, last_tag );
+                    ret = MC_NORMAL_COMPLETION;
+                }
+            }
+            else
+            {
+                ret = MC_INVALID_MESSAGE_ID;
+            }
+        }
+        else
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+    }
+    catch( const bad_numeric_cast& )
+    {
+        ret = MC_INVALID_TAG;
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
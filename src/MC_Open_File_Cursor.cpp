@@ -0,0 +1,91 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <memory>
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+/// local private
+#include "fume/library_context.h"
+#include "fume/file_object.h"
+#include "fume/file_cursor.h"
+
+using std::unique_ptr;
+using std::move;
+
+using fume::g_context;
+using fume::file_object;
+using fume::file_cursor;
+
+MC_STATUS MC_Open_File_Cursor( int*             CursorIDPtr,
+                               int              ApplicationID,
+                               int              FileID,
+                               void*            UserInfo,
+                               ReadFileCallback YourFromMediaFunction )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context             != nullptr &&
+            CursorIDPtr           != nullptr &&
+            YourFromMediaFunction != nullptr )
+        {
+            file_object* file =
+                dynamic_cast<file_object*>( g_context->get_object( FileID ) );
+            if( file != nullptr )
+            {
+                unique_ptr<file_cursor> cursor(
+                    new file_cursor( file->get_filename(),
+                                     YourFromMediaFunction,
+                                     UserInfo ) );
+                ret = cursor->open( *file, ApplicationID );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    const int cursor_id = g_context->create_cursor( move( cursor ) );
+                    if( cursor_id > 0 )
+                    {
+                        *CursorIDPtr = cursor_id;
+                    }
+                    else
+                    {
+                        ret = static_cast<MC_STATUS>( -cursor_id );
+                    }
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else
+            {
+                ret = MC_INVALID_FILE_ID;
+            }
+        }
+        else if( g_context == nullptr )
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+        else
+        {
+            ret = MC_NULL_POINTER_PARM;
+        }
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
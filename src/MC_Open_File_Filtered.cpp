@@ -0,0 +1,105 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <vector>
+
+// boost
+#include "boost/numeric/conversion/cast.hpp"
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+/// local private
+#include "fume/library_context.h"
+#include "fume/file_object.h"
+#include "fume/file_object_io.h"
+#include "fume/tag_filter.h"
+
+using std::vector;
+using std::move;
+
+using boost::numeric_cast;
+using boost::bad_numeric_cast;
+
+using fume::g_context;
+using fume::file_object;
+using fume::tag_range;
+using fume::tag_filter;
+using fume::open_file_filtered;
+
+// Reads the elements whose tags fall within any of the ranges
+// FirstTags[i] to LastTags[i] (inclusive). Passing the same array
+// for both reads a list of individual tags
+MC_STATUS MC_Open_File_Filtered( int                  ApplicationID,
+                                 int                  FileID,
+                                 void*                UserInfo,
+                                 const unsigned long* FirstTags,
+                                 const unsigned long* LastTags,
+                                 int                  NumRanges,
+                                 ReadFileCallback     YourFromMediaFunction )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    try
+    {
+        if( g_context != nullptr                                     &&
+            NumRanges >= 0                                           &&
+            (NumRanges == 0 || (FirstTags != nullptr && LastTags != nullptr)) )
+        {
+            file_object* file =
+                dynamic_cast<file_object*>( g_context->get_object( FileID ) );
+            if( file != nullptr )
+            {
+                vector<tag_range> ranges;
+                ranges.reserve( static_cast<size_t>( NumRanges ) );
+                for( int i = 0; i < NumRanges; ++i )
+                {
+                    ranges.emplace_back( numeric_cast<uint32_t>( FirstTags[i] ),
+                                         numeric_cast<uint32_t>( LastTags[i] ) );
+                }
+
+                ret = open_file_filtered( *file,
+                                          ApplicationID,
+                                          tag_filter( move( ranges ) ),
+                                          UserInfo,
+                                          YourFromMediaFunction );
+            }
+            else
+            {
+                ret = MC_INVALID_FILE_ID;
+            }
+        }
+        else if( g_context == nullptr )
+        {
+            ret = MC_LIBRARY_NOT_INITIALIZED;
+        }
+        else if( NumRanges < 0 )
+        {
+            ret = MC_MUST_BE_POSITIVE;
+        }
+        else
+        {
+            ret = MC_NULL_POINTER_PARM;
+        }
+    }
+    catch( const bad_numeric_cast& )
+    {
+        ret = MC_INVALID_TAG;
+    }
+    catch( ... )
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
@@ -45,8 +45,11 @@ static MC_STATUS set_next_value( int            msg,
             data_dictionary* dict = g_context->get_object( msg );
             if( dict != nullptr )
             {
+                const uint32_t tag_value = numeric_cast<uint32_t>( tag );
                 value_representation* element =
-                    dict->at( numeric_cast<uint32_t>( tag ) );
+                    dict->is_managed_tag( tag_value ) == false ?
+                    dict->at( tag_value ) :
+                    nullptr;
                 if( element != nullptr )
                 {
                     ret = element->set_next( value );
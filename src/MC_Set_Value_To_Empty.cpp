@@ -40,8 +40,10 @@ MC_STATUS MC_Set_Value_To_Empty( int MsgFileItemID, unsigned long Tag )
             data_dictionary* dict = g_context->get_object( MsgFileItemID );
             if( dict != nullptr )
             {
+                const uint32_t tag_value = numeric_cast<uint32_t>( Tag );
                 const bool value_erased =
-                    erase_tag( *dict, numeric_cast<uint32_t>( Tag ) );
+                    dict->is_managed_tag( tag_value ) == false &&
+                    erase_tag( *dict, tag_value );
                 ret = value_erased ? MC_NORMAL_COMPLETION : MC_INVALID_TAG;
             }
             else
@@ -0,0 +1,172 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// local public
+
+// local private
+#include "fume/arena.h"
+
+namespace fume
+{
+
+static const size_t ALIGNMENT = alignof(std::max_align_t);
+
+// Each allocation is preceded by the arena it came from (NULL for the
+// heap), padded so the allocation itself stays suitably aligned
+static const size_t HEADER_SIZE =
+    (sizeof(arena*) + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT;
+
+static thread_local arena* s_current_arena = nullptr;
+
+static size_t align_size( size_t size );
+
+arena* arena::create( size_t block_size )
+{
+    return new arena( block_size );
+}
+
+arena::arena( size_t block_size )
+    : m_block_size( align_size( block_size ) ),
+      m_cur( nullptr ),
+      m_end( nullptr ),
+      m_allocation_count( 0 ),
+      m_bytes_reserved( 0 ),
+      m_refs( 1u )
+{
+}
+
+arena::~arena()
+{
+    for( uint8_t* block : m_blocks )
+    {
+        ::operator delete( block );
+    }
+}
+
+void arena::release()
+{
+    remove_ref();
+}
+
+void arena::remove_ref()
+{
+    if( m_refs.fetch_sub( 1u ) == 1u )
+    {
+        delete this;
+    }
+    else
+    {
+        // Do nothing. Allocations are still live
+    }
+}
+
+void* arena::allocate( size_t size )
+{
+    const size_t total_size = HEADER_SIZE + align_size( size );
+
+    uint8_t* ret = nullptr;
+    if( static_cast<size_t>( m_end - m_cur ) >= total_size )
+    {
+        ret = m_cur;
+        m_cur += total_size;
+    }
+    else if( total_size > m_block_size )
+    {
+        // Too large to share a block. Give it its own so the remainder
+        // of the current block is not wasted
+        ret = static_cast<uint8_t*>( ::operator new( total_size ) );
+        m_blocks.push_back( ret );
+        m_bytes_reserved += total_size;
+    }
+    else
+    {
+        ret = static_cast<uint8_t*>( ::operator new( m_block_size ) );
+        m_blocks.push_back( ret );
+        m_bytes_reserved += m_block_size;
+        m_cur = ret + total_size;
+        m_end = ret + m_block_size;
+    }
+
+    ++m_allocation_count;
+    m_refs.fetch_add( 1u );
+
+    *reinterpret_cast<arena**>( ret ) = this;
+    return ret + HEADER_SIZE;
+}
+
+void* arena::allocate_object( size_t size )
+{
+    void* ret = nullptr;
+
+    if( s_current_arena != nullptr )
+    {
+        ret = s_current_arena->allocate( size );
+    }
+    else
+    {
+        uint8_t* const block =
+            static_cast<uint8_t*>( ::operator new( HEADER_SIZE + size ) );
+        *reinterpret_cast<arena**>( block ) = nullptr;
+        ret = block + HEADER_SIZE;
+    }
+
+    return ret;
+}
+
+void arena::deallocate_object( void* ptr )
+{
+    if( ptr != nullptr )
+    {
+        uint8_t* const block = static_cast<uint8_t*>( ptr ) - HEADER_SIZE;
+        arena* const owner = *reinterpret_cast<arena**>( block );
+        if( owner != nullptr )
+        {
+            owner->remove_ref();
+        }
+        else
+        {
+            ::operator delete( block );
+        }
+    }
+    else
+    {
+        // Do nothing. Nothing to free
+    }
+}
+
+bool arena::from_arena( const void* ptr )
+{
+    const uint8_t* const block = static_cast<const uint8_t*>( ptr ) - HEADER_SIZE;
+    return *reinterpret_cast<arena* const*>( block ) != nullptr;
+}
+
+arena* arena::current()
+{
+    return s_current_arena;
+}
+
+void arena::set_current( arena* value )
+{
+    s_current_arena = value;
+}
+
+size_t align_size( size_t size )
+{
+    return (size + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT;
+}
+
+}
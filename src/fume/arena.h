@@ -0,0 +1,161 @@
+#ifndef ARENA_H
+#define ARENA_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+// local public
+
+// local private
+
+namespace fume
+{
+
+// Monotonic buffer used for the values parsed into a file. Allocations
+// are bumped out of large blocks and individual deallocations only drop
+// a reference, so the blocks are released together once the owner and
+// every allocation made from the arena are gone.
+//
+// Allocations are routed to the arena made current on the calling
+// thread by arena_scope. Every allocation records the arena it came
+// from (or that it came from the heap), so memory allocated by
+// allocate_object may always be released with deallocate_object
+// regardless of which arena, if any, was current at the time.
+class arena final
+{
+public:
+    // Creates an arena holding a single reference for the caller
+    static arena* create( size_t block_size );
+
+    // Releases the reference held by the creator of the arena
+    void release();
+
+    // Allocates from the current arena of the calling thread, or from the
+    // heap if there is none. Throws std::bad_alloc on failure
+    static void* allocate_object( size_t size );
+    static void deallocate_object( void* ptr );
+
+    static arena* current();
+
+    // True if ptr was returned by allocate_object while an arena was
+    // current, so freeing it would release part of an arena
+    static bool from_arena( const void* ptr );
+
+    // Statistics for the blocks backing the arena
+    size_t allocation_count() const
+    {
+        return m_allocation_count;
+    }
+
+    size_t bytes_reserved() const
+    {
+        return m_bytes_reserved;
+    }
+
+private:
+    explicit arena( size_t block_size );
+    ~arena();
+
+    void* allocate( size_t size );
+    void remove_ref();
+
+private:
+    friend class arena_scope;
+
+    static void set_current( arena* value );
+
+private:
+    size_t                  m_block_size;
+    std::vector<uint8_t*>   m_blocks;
+    uint8_t*                m_cur;
+    uint8_t*                m_end;
+    size_t                  m_allocation_count;
+    size_t                  m_bytes_reserved;
+    // One reference for the creator plus one per live allocation
+    std::atomic<size_t>     m_refs;
+
+private:
+    arena( const arena& );
+    arena& operator=( const arena& );
+};
+
+// Makes an arena current on the calling thread for the lifetime of the
+// scope. A null arena makes allocations go to the heap
+class arena_scope final
+{
+public:
+    explicit arena_scope( arena* value )
+        : m_prev( arena::current() )
+    {
+        arena::set_current( value );
+    }
+
+    ~arena_scope()
+    {
+        arena::set_current( m_prev );
+    }
+
+private:
+    arena* m_prev;
+
+private:
+    arena_scope( const arena_scope& );
+    arena_scope& operator=( const arena_scope& );
+};
+
+// Stateless standard allocator for containers whose nodes should come
+// from the current arena
+template<class T>
+class arena_allocator
+{
+public:
+    typedef T value_type;
+
+    arena_allocator()
+    {
+    }
+
+    template<class U>
+    arena_allocator( const arena_allocator<U>& )
+    {
+    }
+
+    T* allocate( size_t n )
+    {
+        return static_cast<T*>( arena::allocate_object( n * sizeof(T) ) );
+    }
+
+    void deallocate( T* ptr, size_t )
+    {
+        arena::deallocate_object( ptr );
+    }
+};
+
+template<class T, class U>
+bool operator==( const arena_allocator<T>&, const arena_allocator<U>& )
+{
+    return true;
+}
+
+template<class T, class U>
+bool operator!=( const arena_allocator<T>&, const arena_allocator<U>& )
+{
+    return false;
+}
+
+}
+
+#endif
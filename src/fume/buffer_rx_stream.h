@@ -0,0 +1,98 @@
+#ifndef BUFFER_RX_STREAM_H
+#define BUFFER_RX_STREAM_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// local public
+#include "mcstatus.h"
+
+// local private
+#include "fume/rx_stream.h"
+
+namespace fume
+{
+
+// Reads from a block of memory owned by the caller, which must outlive
+// the stream
+class buffer_rx_stream final : public rx_stream
+{
+public:
+    buffer_rx_stream( const uint8_t* data, size_t size )
+        : m_data( data ),
+          m_size( size ),
+          m_offset( 0u )
+    {
+    }
+    ~buffer_rx_stream()
+    {
+    }
+
+// rx_stream
+public:
+    virtual MC_STATUS read( void* buffer, uint32_t buffer_bytes ) override final
+    {
+        MC_STATUS ret = peek( buffer, buffer_bytes );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            m_offset += buffer_bytes;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        return ret;
+    }
+
+    virtual MC_STATUS peek( void* buffer, uint32_t buffer_bytes ) override final
+    {
+        MC_STATUS ret = MC_CANNOT_COMPLY;
+
+        if( m_size - m_offset >= buffer_bytes )
+        {
+            memcpy( buffer, m_data + m_offset, buffer_bytes );
+            ret = MC_NORMAL_COMPLETION;
+        }
+        else if( m_offset == m_size )
+        {
+            ret = MC_END_OF_DATA;
+        }
+        else
+        {
+            ret = MC_UNEXPECTED_EOD;
+        }
+
+        return ret;
+    }
+
+    virtual uint64_t tell_read() const override final
+    {
+        return m_offset;
+    }
+
+private:
+    buffer_rx_stream( const buffer_rx_stream& );
+    buffer_rx_stream& operator=( const buffer_rx_stream& );
+
+private:
+    const uint8_t* m_data;
+    size_t         m_size;
+    size_t         m_offset;
+};
+
+}
+
+#endif
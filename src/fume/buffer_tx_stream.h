@@ -0,0 +1,118 @@
+#ifndef BUFFER_TX_STREAM_H
+#define BUFFER_TX_STREAM_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+
+// local private
+#include "fume/tx_stream.h"
+
+namespace fume
+{
+
+// Writes to a contiguous block of memory. Data already written can be
+// overwritten by seeking back to it. The data starts at origin, which is
+// its position in the eventual output
+class buffer_tx_stream final : public tx_stream
+{
+public:
+    explicit buffer_tx_stream( uint64_t origin = 0u )
+        : m_origin( origin ),
+          m_offset( 0u )
+    {
+    }
+    ~buffer_tx_stream()
+    {
+    }
+
+// tx_stream
+public:
+    virtual MC_STATUS write( const void* buffer,
+                             uint32_t    buffer_bytes ) override final
+    {
+        const uint8_t* const src = static_cast<const uint8_t*>( buffer );
+        if( m_offset == m_data.size() )
+        {
+            m_data.insert( m_data.end(), src, src + buffer_bytes );
+        }
+        else
+        {
+            if( m_data.size() - m_offset < buffer_bytes )
+            {
+                m_data.resize( m_offset + buffer_bytes );
+            }
+            else
+            {
+                // Do nothing. Overwriting existing data
+            }
+
+            memcpy( m_data.data() + m_offset, src, buffer_bytes );
+        }
+
+        m_offset += buffer_bytes;
+        return MC_NORMAL_COMPLETION;
+    }
+
+    virtual uint64_t tell_write() const override final
+    {
+        return m_origin + m_offset;
+    }
+
+public:
+    // Moves the write position, which must be within the data written
+    MC_STATUS seek( uint64_t position )
+    {
+        MC_STATUS ret = MC_CANNOT_COMPLY;
+
+        if( position >= m_origin && position - m_origin <= m_data.size() )
+        {
+            m_offset = static_cast<size_t>( position - m_origin );
+            ret = MC_NORMAL_COMPLETION;
+        }
+        else
+        {
+            ret = MC_SYSTEM_ERROR;
+        }
+
+        return ret;
+    }
+
+    const uint8_t* data() const
+    {
+        return m_data.data();
+    }
+
+    size_t size() const
+    {
+        return m_data.size();
+    }
+
+private:
+    buffer_tx_stream( const buffer_tx_stream& );
+    buffer_tx_stream& operator=( const buffer_tx_stream& );
+
+private:
+    const uint64_t       m_origin;
+    std::vector<uint8_t> m_data;
+    size_t               m_offset;
+};
+
+}
+
+#endif
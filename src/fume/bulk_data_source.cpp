@@ -0,0 +1,158 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+// local private
+#include "fume/tx_stream.h"
+#include "fume/file_rx_stream.h"
+#include "fume/value_representation.h"
+#include "fume/bulk_data_source.h"
+#include "fume/vrs/bulk_reference.h"
+
+using std::string;
+using std::min;
+using std::sort;
+using std::vector;
+using fume::vrs::bulk_reference;
+
+namespace fume
+{
+
+static const uint32_t BULK_COPY_BLOCK_SIZE = 256u * 1024u;
+
+bulk_data_source::bulk_data_source( const string&    filename,
+                                    ReadFileCallback callback,
+                                    void*            user_info,
+                                    uint32_t         min_length )
+    : m_filename( filename ),
+      m_callback( callback ),
+      m_user_info( user_info ),
+      m_min_length( min_length ),
+      m_buffer( BULK_COPY_BLOCK_SIZE )
+{
+    // Checked by caller
+    assert( m_callback != nullptr );
+}
+
+bulk_data_source::~bulk_data_source()
+{
+}
+
+void bulk_data_source::add_reference( bulk_reference* reference )
+{
+    m_references.insert( reference );
+}
+
+void bulk_data_source::remove_reference( bulk_reference* reference )
+{
+    m_references.erase( reference );
+}
+
+MC_STATUS bulk_data_source::load_references()
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    // Loading in offset order reads the source in a single pass
+    vector<bulk_reference*> references( m_references.begin(),
+                                        m_references.end() );
+    sort( references.begin(),
+          references.end(),
+          []( const bulk_reference* lhs, const bulk_reference* rhs )
+          {
+              return lhs->offset() < rhs->offset();
+          } );
+
+    for( auto it = references.begin();
+         ret == MC_NORMAL_COMPLETION && it != references.end();
+         ++it )
+    {
+        ret = (*it)->materialize();
+    }
+
+    return ret;
+}
+
+MC_STATUS bulk_data_source::seek( uint64_t offset )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    // Restart the callback from the beginning of the file if the
+    // requested offset has already been passed
+    if( m_stream == nullptr || m_stream->tell_read() > offset )
+    {
+        m_stream.reset( new file_rx_stream( m_filename,
+                                            m_callback,
+                                            m_user_info ) );
+    }
+    else
+    {
+        // Do nothing. Can skip forward from the current position
+    }
+
+    while( ret == MC_NORMAL_COMPLETION && m_stream->tell_read() < offset )
+    {
+        const uint32_t skip_bytes =
+            static_cast<uint32_t>( min( offset - m_stream->tell_read(),
+                                        static_cast<uint64_t>( m_buffer.size() ) ) );
+        ret = m_stream->read( m_buffer.data(), skip_bytes );
+    }
+
+    return ret;
+}
+
+MC_STATUS bulk_data_source::copy_range( uint64_t   offset,
+                                        uint32_t   length,
+                                        tx_stream& dest )
+{
+    MC_STATUS ret = seek( offset );
+
+    uint32_t bytes_remaining = length;
+    while( ret == MC_NORMAL_COMPLETION && bytes_remaining > 0u )
+    {
+        const uint32_t block_size =
+            min( static_cast<uint32_t>( m_buffer.size() ), bytes_remaining );
+        ret = m_stream->read( m_buffer.data(), block_size );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = dest.write( m_buffer.data(), block_size );
+            bytes_remaining -= block_size;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret;
+}
+
+MC_STATUS bulk_data_source::read_value( uint64_t              offset,
+                                        TRANSFER_SYNTAX       syntax,
+                                        value_representation& dest )
+{
+    MC_STATUS ret = seek( offset );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = dest.from_stream( *m_stream, syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+}
@@ -0,0 +1,103 @@
+#ifndef BULK_DATA_SOURCE_H
+#define BULK_DATA_SOURCE_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_set>
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+namespace fume
+{
+
+class tx_stream;
+class file_rx_stream;
+class value_representation;
+
+namespace vrs
+{
+class bulk_reference;
+}
+
+// Provides access to byte ranges of the file a file object was opened
+// from, so large values can be left in the source file rather than
+// being read into memory. Since the source can only be read sequentially
+// through the ReadFileCallback, the file is re-read from the start
+// whenever a range before the current position is requested. Values
+// written in tag order are therefore copied in a single forward pass.
+class bulk_data_source final
+{
+public:
+    // Note: the user info and callback must remain valid for the
+    // lifetime of this object
+    bulk_data_source( const std::string& filename,
+                      ReadFileCallback   callback,
+                      void*              user_info,
+                      uint32_t           min_length );
+    ~bulk_data_source();
+
+    // Minimum value length, in bytes, which is left in the source
+    uint32_t min_length() const
+    {
+        return m_min_length;
+    }
+
+    const std::string& filename() const
+    {
+        return m_filename;
+    }
+
+    // Called by bulk_reference so the references still pointing
+    // into the source can be found by load_references
+    void add_reference( vrs::bulk_reference* reference );
+    void remove_reference( vrs::bulk_reference* reference );
+
+    // Reads every value still referencing the source into memory, in
+    // offset order. Used before the source file is overwritten
+    MC_STATUS load_references();
+
+    // Copies length bytes starting at offset to the destination
+    MC_STATUS copy_range( uint64_t   offset,
+                          uint32_t   length,
+                          tx_stream& dest );
+
+    // Reads the value whose length field starts at offset into dest
+    MC_STATUS read_value( uint64_t              offset,
+                          TRANSFER_SYNTAX       syntax,
+                          value_representation& dest );
+
+private:
+    bulk_data_source( const bulk_data_source& );
+    bulk_data_source& operator=( const bulk_data_source& );
+
+    MC_STATUS seek( uint64_t offset );
+
+private:
+    // Declared before m_stream, which keeps a reference to it
+    const std::string               m_filename;
+    ReadFileCallback                m_callback;
+    void*                           m_user_info;
+    const uint32_t                  m_min_length;
+    std::unique_ptr<file_rx_stream> m_stream;
+    std::vector<uint8_t>            m_buffer;
+    std::unordered_set<vrs::bulk_reference*> m_references;
+};
+
+}
+
+#endif
@@ -115,6 +115,15 @@ static string_parm_map_t::value_type string_vals[] =
     { PEGASUS_DISP_REG_NAME, "" }
 };
 
+static int_parm_map_t::value_type int_vals[] =
+{
+    { ARENA_BLOCK_SIZE, 65536 },
+    { DEFLATE_COMPRESSION_LEVEL, 6 },
+    { DEFLATE_THREADS, 1 },
+    { LARGE_DATA_SIZE, 200 },
+    { OBJECT_POOL_SIZE, 64 },
+    { READ_SQ_DEPTH_LIMIT, 128 }
+};
 
 
 
@@ -124,6 +133,7 @@ config_maps create_config_maps()
 
     ret.strings.insert( begin(string_vals), end(string_vals) );
 
+    ret.ints.insert( begin(int_vals), end(int_vals) );
 
 
 
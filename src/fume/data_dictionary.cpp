@@ -13,6 +13,7 @@
 #include <cassert>
 #include <memory>
 #include <limits>
+#include <utility>
 
 // local public
 
@@ -24,6 +25,7 @@
 #include "fume/vr_field.h"
 
 using std::numeric_limits;
+using std::move;
 
 namespace fume
 {
@@ -50,6 +52,16 @@ dictionary_iter data_dictionary::find( uint32_t tag )
     return m_value_dict.find( tag );
 }
 
+dictionary_iter data_dictionary::lower_bound( uint32_t tag )
+{
+    return m_value_dict.lower_bound( tag );
+}
+
+dictionary_iter data_dictionary::upper_bound( uint32_t tag )
+{
+    return m_value_dict.upper_bound( tag );
+}
+
 // NOTE: this internal function asserts that the Tag is valid. It
 // is intended as an internal function where the caller is absolutely
 // sure that the tag id is valid and an invalid tag id represents an
@@ -124,6 +136,15 @@ void data_dictionary::clear()
     m_value_dict.clear();
 }
 
+void data_dictionary::reset( int id )
+{
+    m_value_dict.clear();
+    m_nonstandard_vr_dict.clear();
+    m_id = id;
+    m_created_empty = true;
+    m_application_id = -1;
+}
+
 void data_dictionary::erase( dictionary_iter itr )
 {
     m_value_dict.erase( itr );
@@ -231,19 +252,57 @@ void data_dictionary::insert( value_dict&& values )
 {
     value_dict tmp_values( move( values ) );
 
-    for( value_dict::reference source_elem : tmp_values )
+    if( m_value_dict.empty() == true )
     {
-        if( source_elem.second != nullptr )
+        // Nothing to merge with (eg. a newly read item). Take the nodes
+        // rather than reinserting each value
+        m_value_dict.swap( tmp_values );
+
+        value_dict::iterator itr = m_value_dict.begin();
+        while( itr != m_value_dict.end() )
         {
-            m_value_dict[source_elem.first].swap( source_elem.second );
+            if( itr->second == nullptr )
+            {
+                itr = m_value_dict.erase( itr );
+            }
+            else
+            {
+                ++itr;
+            }
         }
-        else
+    }
+    else
+    {
+        for( value_dict::reference source_elem : tmp_values )
         {
-            // If value is NULL do not modify original value
+            if( source_elem.second != nullptr )
+            {
+                m_value_dict[source_elem.first].swap( source_elem.second );
+            }
+            else
+            {
+                // If value is NULL do not modify original value
+            }
         }
     }
 }
 
+void data_dictionary::extract( dictionary_iter begin,
+                               dictionary_iter end,
+                               value_dict&     values )
+{
+    // Erasing an empty range converts the iterator to a mutable one
+    for( value_dict::iterator itr = m_value_dict.erase( begin, begin );
+         itr != end;
+         ++itr )
+    {
+        // Tags are ascending, so each insert goes to the end of values
+        values.emplace_hint( values.end(), itr->first, move( itr->second ) );
+    }
+
+    m_value_dict.erase( begin, end );
+}
+
 MC_STATUS data_dictionary::get_vr_type( uint32_t tag, MC_VR& type )
 {
     MC_STATUS ret = MC_CANNOT_COMPLY;
@@ -12,6 +12,7 @@
  */
 
 // std
+#include <cstddef>
 #include <cstdint>
 
 // local public
@@ -20,6 +21,7 @@
 
 // local private
 #include "fume/data_dictionary_types.h"
+#include "fume/arena.h"
 
 namespace fume
 {
@@ -32,6 +34,17 @@ public:
     data_dictionary( int id, bool created_empty );
     virtual ~data_dictionary();
 
+    // Items read from a file are allocated from the file's arena
+    static void* operator new( size_t size )
+    {
+        return arena::allocate_object( size );
+    }
+
+    static void operator delete( void* ptr )
+    {
+        arena::deallocate_object( ptr );
+    }
+
     // Will attempt to create a value_representation if is empty
     value_representation* at( uint32_t tag );
 
@@ -44,6 +57,10 @@ public:
     bool has_tag( uint32_t tag ) const;
     dictionary_iter find( uint32_t tag );
 
+    // First value with a tag not less than / greater than tag
+    dictionary_iter lower_bound( uint32_t tag );
+    dictionary_iter upper_bound( uint32_t tag );
+
     void erase( dictionary_iter itr );
     void erase( dictionary_iter begin, dictionary_iter end );
 
@@ -67,6 +84,11 @@ public:
 
     void insert( value_dict&& new_vals );
 
+    // Moves the values in [begin, end) to the end of values and removes
+    // them from this object. The values themselves are not copied.
+    // Tags in the range must be greater than any tag already in values
+    void extract( dictionary_iter begin, dictionary_iter end, value_dict& values );
+
     bool created_empty() const
     {
         return m_created_empty;
@@ -74,6 +96,36 @@ public:
 
     MC_STATUS set_callbacks( int application_id );
 
+    // Reads values whose parsing was deferred when the object was read
+    // (eg. records of a DICOMDIR opened with MC_DDH_Open). Must be done
+    // before the values are accessed. library_context::get_object does
+    // this for objects looked up by ID
+    virtual MC_STATUS load_values()
+    {
+        return MC_NORMAL_COMPLETION;
+    }
+
+    // Called by library_context::get_object once the values are
+    // available, since the object was looked up for the API and any of
+    // its values may be changed from then on
+    virtual void values_may_change()
+    {
+    }
+
+    // Whether any tag in [first_tag, last_tag] holds a value the object
+    // maintains itself, which the value functions of the API must not
+    // change (eg. the Directory Record Sequence of a DICOMDIR, which its
+    // records are linked into)
+    virtual bool is_managed_range( uint32_t first_tag, uint32_t last_tag ) const
+    {
+        return false;
+    }
+
+    bool is_managed_tag( uint32_t tag ) const
+    {
+        return is_managed_range( tag, tag );
+    }
+
     virtual MC_STATUS set_transfer_syntax( TRANSFER_SYNTAX syntax ) = 0;
     virtual MC_STATUS get_transfer_syntax( TRANSFER_SYNTAX& syntax ) = 0;
 
@@ -82,11 +134,23 @@ public:
         return m_id;
     }
 
+    // Items owned by a sequence have no ID until one is requested.
+    // Only library_context should call this
+    void set_id( int id )
+    {
+        m_id = id;
+    }
+
     int application_id() const
     {
         return m_application_id;
     }
 
+protected:
+    // Returns a recycled object to the state of a newly created empty
+    // object with the given ID
+    void reset( int id );
+
 private:
     data_dictionary( const data_dictionary& );
     data_dictionary& operator=( const data_dictionary& );
@@ -95,7 +159,7 @@ private:
 
 private:
     value_dict          m_value_dict;
-    const int           m_id;
+    int                 m_id;
     bool                m_created_empty;
     nonstandard_vr_dict m_nonstandard_vr_dict;
     int                 m_application_id;
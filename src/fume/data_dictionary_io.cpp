@@ -12,6 +12,10 @@
 
 // std
 #include <cstdint>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
 
 // local public
 #include "mcstatus.h"
@@ -29,15 +33,24 @@
 #include "fume/data_dictionary_io.h"
 #include "fume/data_dictionary_search.h"
 #include "fume/vr_factory.h"
+#include "fume/vr_field.h"
+#include "fume/implicit_vr_cache.h"
+#include "fume/sequence_reader.h"
+#include "fume/tag_filter.h"
+#include "fume/bulk_data_source.h"
+#include "fume/vrs/bulk_reference.h"
+
+using std::shared_ptr;
+using std::unique_ptr;
+using std::vector;
+using std::array;
+using std::min;
+
+using fume::vrs::bulk_reference;
 
 namespace fume
 {
 
-static MC_STATUS create_vr_from_stream( rx_stream&      stream,
-                                        TRANSFER_SYNTAX syntax,
-                                        uint32_t        tag,
-                                        unique_vr_ptr&  element );
-
 static MC_STATUS write_values( tx_stream&       stream,
                                TRANSFER_SYNTAX  syntax,
                                data_dictionary& dict,
@@ -45,12 +58,40 @@ static MC_STATUS write_values( tx_stream&       stream,
                                dictionary_iter  begin,
                                dictionary_iter  end );
 
-static MC_STATUS read_element( rx_stream&         stream,
-                               TRANSFER_SYNTAX    syntax,
-                               uint32_t           tag,
-                               int                dict_id,
-                               value_dict&        dict,
-                               const application* app );
+static MC_STATUS read_element( rx_stream&                          stream,
+                               TRANSFER_SYNTAX                     syntax,
+                               uint32_t                            tag,
+                               int                                 dict_id,
+                               value_dict&                         dict,
+                               const application*                  app,
+                               const shared_ptr<bulk_data_source>& bulk );
+
+static MC_STATUS read_bulk_reference( rx_stream&                          stream,
+                                      TRANSFER_SYNTAX                     syntax,
+                                      const shared_ptr<bulk_data_source>& bulk,
+                                      unique_vr_ptr&                      element );
+
+static MC_STATUS skip_bytes( rx_stream& stream, uint32_t length );
+
+// Skips the items of an undefined length sequence or encapsulated value,
+// including any sequences nested in them
+static MC_STATUS skip_items( rx_stream& stream, TRANSFER_SYNTAX syntax );
+
+static const uint32_t UNDEFINED_LENGTH = 0xFFFFFFFFu;
+
+// A sequence being skipped by skip_items, and whether the stream is in one
+// of its items
+struct skip_level
+{
+    explicit skip_level( TRANSFER_SYNTAX item_syntax )
+        : syntax( item_syntax ),
+          in_item( false )
+    {
+    }
+
+    TRANSFER_SYNTAX syntax;
+    bool            in_item;
+};
 
 MC_STATUS write_values( tx_stream&           stream,
                         TRANSFER_SYNTAX      syntax,
@@ -98,6 +139,29 @@ MC_STATUS write_values( tx_stream&           stream,
                          dict.end() );
 }
 
+MC_STATUS write_fixed_ul( tx_stream&       stream,
+                          TRANSFER_SYNTAX  syntax,
+                          data_dictionary& dict,
+                          uint32_t         tag,
+                          uint64_t&        position )
+{
+    value_representation& element = dict[tag];
+    if( element.count() != 1 )
+    {
+        (void)element.set( static_cast<unsigned long>( 0x00000000u ) );
+    }
+    else
+    {
+        // Do nothing. Already a single value
+    }
+
+    const MC_STATUS ret = write_values( stream, syntax, dict, tag, tag );
+    // The value is the last thing written
+    position = stream.tell_write() - sizeof(uint32_t);
+
+    return ret;
+}
+
 MC_STATUS write_values( tx_stream&       stream,
                         TRANSFER_SYNTAX  syntax,
                         data_dictionary& dict,
@@ -186,6 +250,8 @@ MC_STATUS read_values_from_item( rx_stream&       stream,
     const application* const app = g_context->get_application( app_id );
 
     value_dict tmp_value_dict;
+    // Resolves the VRs of the elements if the stream is implicit VR
+    const implicit_vr_scope vr_scope( syntax );
 
     while( ret == MC_NORMAL_COMPLETION &&
            ((stream.tell_read() - start_offset) + 1) < size )
@@ -203,7 +269,8 @@ MC_STATUS read_values_from_item( rx_stream&       stream,
                                     tag,
                                     dict.id(),
                                     tmp_value_dict,
-                                    app );
+                                    app,
+                                    nullptr );
             }
             // If we've reached an item delimiter
             else if( tag == MC_ATT_ITEM_DELIMITATION_ITEM )
@@ -250,6 +317,8 @@ MC_STATUS read_values( rx_stream&       stream,
     const application* const app = g_context->get_application( app_id );
 
     value_dict tmp_value_dict;
+    // Resolves the VRs of the elements if the stream is implicit VR
+    const implicit_vr_scope vr_scope( syntax );
 
     while( ret == MC_NORMAL_COMPLETION )
     {
@@ -266,7 +335,8 @@ MC_STATUS read_values( rx_stream&       stream,
                                     tag,
                                     dict.id(),
                                     tmp_value_dict,
-                                    app );
+                                    app,
+                                    nullptr );
             }
             else
             {
@@ -298,6 +368,16 @@ MC_STATUS read_values_upto( rx_stream&       stream,
                             data_dictionary& dict,
                             int              app_id,
                             uint32_t         end_tag )
+{
+    return read_values_upto( stream, syntax, dict, app_id, end_tag, nullptr );
+}
+
+MC_STATUS read_values_upto( rx_stream&                          stream,
+                            TRANSFER_SYNTAX                     syntax,
+                            data_dictionary&                    dict,
+                            int                                 app_id,
+                            uint32_t                            end_tag,
+                            const shared_ptr<bulk_data_source>& bulk )
 {
     MC_STATUS ret = MC_NORMAL_COMPLETION;
     bool graceful_end_of_data = false;
@@ -305,6 +385,8 @@ MC_STATUS read_values_upto( rx_stream&       stream,
     const application* const app = g_context->get_application( app_id );
 
     value_dict tmp_value_dict;
+    // Resolves the VRs of the elements if the stream is implicit VR
+    const implicit_vr_scope vr_scope( syntax );
 
     while( MC_NORMAL_COMPLETION == ret )
     {
@@ -326,7 +408,8 @@ MC_STATUS read_values_upto( rx_stream&       stream,
                                         tag,
                                         dict.id(),
                                         tmp_value_dict,
-                                        app );
+                                        app,
+                                        bulk );
                 }
                 else
                 {
@@ -363,6 +446,101 @@ MC_STATUS read_values_upto( rx_stream&       stream,
     return ret;
 }
 
+MC_STATUS read_values_filtered( rx_stream&        stream,
+                                TRANSFER_SYNTAX   syntax,
+                                data_dictionary&  dict,
+                                int               app_id,
+                                const tag_filter& filter )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    bool graceful_end_of_data = false;
+
+    const application* const app = g_context->get_application( app_id );
+    const uint32_t end_tag = filter.last_tag();
+
+    value_dict tmp_value_dict;
+    // Resolves the VRs of the elements if the stream is implicit VR
+    const implicit_vr_scope vr_scope( syntax );
+
+    while( MC_NORMAL_COMPLETION == ret )
+    {
+        uint32_t tag = 0;
+        ret = stream.peek_tag( tag, syntax );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            if( tag == MC_ATT_ITEM_DELIMITATION_ITEM ||
+                tag == MC_ATT_ITEM                   ||
+                tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM )
+            {
+                // We're not expecting to get delimiter tags
+                ret = MC_INVALID_TAG;
+            }
+            else if( tag > end_tag )
+            {
+                graceful_end_of_data = true;
+                ret = MC_END_OF_DATA;
+            }
+            else if( filter.contains( tag ) == true )
+            {
+                // This shouldn't fail if the peek succeeded
+                (void)stream.read_tag( tag, syntax );
+
+                ret = read_element( stream,
+                                    syntax,
+                                    tag,
+                                    dict.id(),
+                                    tmp_value_dict,
+                                    app,
+                                    nullptr );
+            }
+            else
+            {
+                // This shouldn't fail if the peek succeeded
+                (void)stream.read_tag( tag, syntax );
+
+                MC_VR vr = UNKNOWN_VR;
+                uint32_t length = 0;
+                ret = read_element_header( stream,
+                                           syntax,
+                                           tag,
+                                           vr,
+                                           length );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    ret = skip_value( stream, syntax, vr, length );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+        }
+        else if( ret == MC_END_OF_DATA )
+        {
+            // No more data when trying to read the start of a tag.
+            // terminate gracefully
+            graceful_end_of_data = true;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    // Upon success, copy the values into the dictionary
+    if( ret == MC_END_OF_DATA && graceful_end_of_data == true )
+    {
+        dict.insert( move( tmp_value_dict ) );
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
 MC_STATUS create_vr_from_stream( rx_stream&      stream,
                                  TRANSFER_SYNTAX syntax,
                                  uint32_t        tag,
@@ -395,20 +573,43 @@ MC_STATUS create_vr_from_stream( rx_stream&      stream,
     }
     else
     {
-        assert( g_context != nullptr );
-        element = g_context->create_vr( tag, nullptr );
+        implicit_vr_cache* const cache = implicit_vr_cache::current();
+        assert( cache != nullptr );
+
+        MC_VR vr = UNKNOWN_VR;
+        unsigned short min_vals = 0;
+        unsigned short max_vals = 0;
+        unsigned short multiple = 0;
+        cache->get_vr_info( tag, vr, min_vals, max_vals, multiple );
+
+        // An unknown element of undefined length can only be a sequence,
+        // whose items are always implicit little endian (PS3.5 6.2.2)
+        uint32_t length = 0;
+        if( vr == UNKNOWN_VR &&
+            stream.peek_val( length, syntax ) == MC_NORMAL_COMPLETION &&
+            length == UNDEFINED_LENGTH )
+        {
+            vr = SQ;
+        }
+        else
+        {
+            // Do nothing. Use the VR from the cache
+        }
+
+        element = create_vr( vr, min_vals, max_vals, multiple );
         ret = MC_NORMAL_COMPLETION;
     }
 
     return ret;
 }
 
-MC_STATUS read_element( rx_stream&         stream,
-                        TRANSFER_SYNTAX    syntax,
-                        uint32_t           tag,
-                        int                dict_id,
-                        value_dict&        dict,
-                        const application* app )
+MC_STATUS read_element( rx_stream&                          stream,
+                        TRANSFER_SYNTAX                     syntax,
+                        uint32_t                            tag,
+                        int                                 dict_id,
+                        value_dict&                         dict,
+                        const application*                  app,
+                        const shared_ptr<bulk_data_source>& bulk )
 {
     MC_STATUS ret = MC_CANNOT_COMPLY;
 
@@ -446,8 +647,22 @@ MC_STATUS read_element( rx_stream&         stream,
         ret = create_vr_from_stream( stream, syntax, tag, element );
         if( ret == MC_NORMAL_COMPLETION && element != nullptr )
         {
-            ret = element->from_stream( stream, syntax );
-            if( ret == MC_NORMAL_COMPLETION )
+            if( bulk != nullptr )
+            {
+                ret = read_bulk_reference( stream, syntax, bulk, element );
+            }
+            else
+            {
+                ret = element->from_stream( stream, syntax );
+            }
+
+            if( ret == MC_NORMAL_COMPLETION &&
+                syntax == IMPLICIT_LITTLE_ENDIAN )
+            {
+                implicit_vr_cache::current()->value_read( tag, *element );
+                dict[tag].swap( element );
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
             {
                 dict[tag].swap( element );
             }
@@ -469,4 +684,316 @@ MC_STATUS read_element( rx_stream&         stream,
     return ret;
 }
 
-}
\ No newline at end of file
+MC_STATUS read_bulk_reference( rx_stream&                          stream,
+                               TRANSFER_SYNTAX                     syntax,
+                               const shared_ptr<bulk_data_source>& bulk,
+                               unique_vr_ptr&                      element )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    const MC_VR vr = element->vr();
+    uint32_t length = 0;
+    bool is_bulk = false;
+    if( (vr == OB || vr == OW || vr == OD) &&
+        stream.peek_val( length, syntax ) == MC_NORMAL_COMPLETION )
+    {
+        // Undefined length values are encapsulated and are read normally
+        is_bulk = length != UNDEFINED_LENGTH && length >= bulk->min_length();
+    }
+    else
+    {
+        // Do nothing. Not a bulk data value
+    }
+
+    if( is_bulk == true )
+    {
+        const uint64_t offset = stream.tell_read();
+
+        // This shouldn't fail if the peek succeeded
+        (void)stream.read_val( length, syntax );
+
+        ret = skip_bytes( stream, length );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            element.reset( new bulk_reference( vr,
+                                               bulk,
+                                               syntax,
+                                               offset,
+                                               length ) );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = element->from_stream( stream, syntax );
+    }
+
+    return ret;
+}
+
+MC_STATUS skip_bytes( rx_stream& stream, uint32_t length )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    array<uint8_t, 4096> buffer;
+
+    uint32_t bytes_remaining = length;
+    while( ret == MC_NORMAL_COMPLETION && bytes_remaining > 0u )
+    {
+        const uint32_t block_size =
+            min( static_cast<uint32_t>( buffer.size() ), bytes_remaining );
+        ret = stream.read( buffer.data(), block_size );
+        bytes_remaining -= block_size;
+    }
+
+    // A value which is cut short is an error even if no bytes remained
+    return ret == MC_END_OF_DATA ? MC_UNEXPECTED_EOD : ret;
+}
+
+MC_STATUS read_element_header( rx_stream&      stream,
+                               TRANSFER_SYNTAX syntax,
+                               uint32_t        tag,
+                               MC_VR&          vr,
+                               uint32_t&       length )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( syntax == IMPLICIT_LITTLE_ENDIAN )
+    {
+        implicit_vr_cache* const cache = implicit_vr_cache::current();
+        assert( cache != nullptr );
+
+        // Private and unknown attributes are UNKNOWN_VR
+        vr = cache->get_vr( tag );
+        ret = stream.read_val( length, syntax );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            cache->header_read( stream, tag, length );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = stream.read_vr( vr, syntax );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            vr_value_t vr_value;
+            uint8_t field_size = 0;
+            ret = get_vr_field_value( vr, vr_value, field_size );
+            if( ret == MC_NORMAL_COMPLETION && field_size > vr_value.size() )
+            {
+                // read_vr already consumed the reserved bytes
+                ret = stream.read_val( length, syntax );
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                uint16_t length_16u = 0;
+                ret = stream.read_val( length_16u, syntax );
+                length = length_16u;
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret;
+}
+
+MC_STATUS skip_value( rx_stream&      stream,
+                      TRANSFER_SYNTAX syntax,
+                      MC_VR           vr,
+                      uint32_t        length )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( length != UNDEFINED_LENGTH )
+    {
+        ret = skip_bytes( stream, length );
+    }
+    // UN sequences of undefined length are always encoded as implicit
+    // little endian (PS3.5 6.2.2)
+    else if( vr == UNKNOWN_VR )
+    {
+        ret = skip_items( stream, IMPLICIT_LITTLE_ENDIAN );
+    }
+    else
+    {
+        ret = skip_items( stream, syntax );
+    }
+
+    return ret;
+}
+
+MC_STATUS find_element( rx_stream&      stream,
+                        TRANSFER_SYNTAX syntax,
+                        uint32_t        tag,
+                        uint64_t&       offset,
+                        MC_VR&          vr,
+                        uint32_t&       length )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    bool found = false;
+
+    // Resolves the VRs of the elements if the stream is implicit VR
+    const implicit_vr_scope vr_scope( syntax );
+
+    while( ret == MC_NORMAL_COMPLETION && found == false )
+    {
+        uint32_t read_tag = 0;
+        ret = stream.read_tag( read_tag, syntax );
+        if( ret == MC_NORMAL_COMPLETION && read_tag <= tag )
+        {
+            const uint64_t header_offset = stream.tell_read();
+            ret = read_element_header( stream,
+                                       syntax,
+                                       read_tag,
+                                       vr,
+                                       length );
+            if( ret == MC_NORMAL_COMPLETION && read_tag == tag )
+            {
+                offset = header_offset;
+                found = true;
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = skip_value( stream, syntax, vr, length );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        // Elements are stored in ascending order, so the element is
+        // not present once a larger tag has been read
+        else if( ret == MC_NORMAL_COMPLETION || ret == MC_END_OF_DATA )
+        {
+            ret = MC_NOT_FOUND;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret;
+}
+
+MC_STATUS skip_items( rx_stream& stream, TRANSFER_SYNTAX syntax )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    // The items of UN sequences are implicit VR even in an explicit VR
+    // data set, so may need a cache of their own
+    unique_ptr<implicit_vr_scope> vr_scope;
+    if( syntax == IMPLICIT_LITTLE_ENDIAN )
+    {
+        vr_scope.reset( new implicit_vr_scope( syntax ) );
+    }
+    else
+    {
+        // Do nothing. VRs are read from the stream
+    }
+
+    // The undefined length sequences being skipped, innermost last. They
+    // are kept on a stack rather than skipped by recursing, so stack usage
+    // does not depend on the nesting depth of the input. The limit is only
+    // looked up once sequences nest
+    vector<skip_level> levels( 1u, skip_level( syntax ) );
+    int depth_limit = 0;
+    while( ret == MC_NORMAL_COMPLETION && levels.empty() == false )
+    {
+        const TRANSFER_SYNTAX level_syntax = levels.back().syntax;
+        uint32_t tag = 0;
+        uint32_t length = 0;
+        ret = stream.read_tag( tag, level_syntax );
+        if( ret == MC_NORMAL_COMPLETION && levels.back().in_item == false )
+        {
+            ret = stream.read_val( length, level_syntax );
+            if( ret == MC_NORMAL_COMPLETION &&
+                tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM )
+            {
+                levels.pop_back();
+            }
+            else if( ret == MC_NORMAL_COMPLETION &&
+                     tag == MC_ATT_ITEM &&
+                     length == UNDEFINED_LENGTH )
+            {
+                levels.back().in_item = true;
+            }
+            else if( ret == MC_NORMAL_COMPLETION && tag == MC_ATT_ITEM )
+            {
+                // Defined length items and encapsulated fragments
+                ret = skip_bytes( stream, length );
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = MC_INVALID_TAG;
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else if( ret == MC_NORMAL_COMPLETION &&
+                 tag == MC_ATT_ITEM_DELIMITATION_ITEM )
+        {
+            ret = stream.read_val( length, level_syntax );
+            levels.back().in_item = false;
+        }
+        else if( ret == MC_NORMAL_COMPLETION )
+        {
+            MC_VR vr = UNKNOWN_VR;
+            ret = read_element_header( stream, level_syntax, tag, vr, length );
+            if( ret == MC_NORMAL_COMPLETION && length != UNDEFINED_LENGTH )
+            {
+                ret = skip_bytes( stream, length );
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                depth_limit = depth_limit > 0 ? depth_limit :
+                                                get_sequence_depth_limit();
+                // UN sequences of undefined length are always encoded as
+                // implicit little endian (PS3.5 6.2.2)
+                const TRANSFER_SYNTAX item_syntax =
+                    vr == UNKNOWN_VR ? IMPLICIT_LITTLE_ENDIAN : level_syntax;
+                if( levels.size() + 1u > static_cast<size_t>( depth_limit ) )
+                {
+                    ret = MC_VALUE_TOO_LARGE;
+                }
+                else if( item_syntax == IMPLICIT_LITTLE_ENDIAN &&
+                         vr_scope == nullptr )
+                {
+                    vr_scope.reset( new implicit_vr_scope( item_syntax ) );
+                    levels.push_back( skip_level( item_syntax ) );
+                }
+                else
+                {
+                    levels.push_back( skip_level( item_syntax ) );
+                }
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret == MC_END_OF_DATA ? MC_UNEXPECTED_EOD : ret;
+}
+
+}
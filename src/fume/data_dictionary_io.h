@@ -14,17 +14,23 @@
 
 // std
 #include <cstdint>
+#include <memory>
 
 // local public
 #include "mcstatus.h"
 #include "mc3msg.h"
 
+// local private
+#include "fume/data_dictionary_types.h"
+
 namespace fume
 {
 
 class tx_stream;
 class rx_stream;
 class data_dictionary;
+class bulk_data_source;
+class tag_filter;
 
 MC_STATUS write_values( tx_stream&       stream,
                         TRANSFER_SYNTAX  syntax,
@@ -44,6 +50,16 @@ MC_STATUS write_values( tx_stream&           stream,
                         data_dictionary&     dict,
                         int                  app_id );
 
+// Writes tag as a single UL, first setting it to zero if it does not
+// have exactly one value. position is set to the stream position of the
+// value, so it can be overwritten in place once the actual value is
+// known (eg. DICOMDIR record offsets)
+MC_STATUS write_fixed_ul( tx_stream&       stream,
+                          TRANSFER_SYNTAX  syntax,
+                          data_dictionary& dict,
+                          uint32_t         tag,
+                          uint64_t&        position );
+
 MC_STATUS read_values_from_item( rx_stream&       stream,
                                  TRANSFER_SYNTAX  syntax,
                                  data_dictionary& dict,
@@ -61,6 +77,63 @@ MC_STATUS read_values_upto( rx_stream&       stream,
                             int              app_id,
                             uint32_t         end_tag );
 
+// Reads only the elements accepted by filter, stopping after the last
+// tag the filter accepts. The values of other elements are skipped
+// without being parsed
+MC_STATUS read_values_filtered( rx_stream&        stream,
+                                TRANSFER_SYNTAX   syntax,
+                                data_dictionary&  dict,
+                                int               app_id,
+                                const tag_filter& filter );
+
+// Creates the element for tag, reading its VR from the stream for
+// explicit syntaxes. For implicit syntaxes the VR is resolved by the
+// current implicit_vr_cache, which must exist. The value itself is not
+// read
+MC_STATUS create_vr_from_stream( rx_stream&      stream,
+                                 TRANSFER_SYNTAX syntax,
+                                 uint32_t        tag,
+                                 unique_vr_ptr&  element );
+
+// Reads the VR and value length of an element whose tag has already
+// been read. For implicit syntaxes the VR is resolved by the current
+// implicit_vr_cache, which must exist, and is UNKNOWN_VR for private and
+// unknown attributes
+MC_STATUS read_element_header( rx_stream&      stream,
+                               TRANSFER_SYNTAX syntax,
+                               uint32_t        tag,
+                               MC_VR&          vr,
+                               uint32_t&       length );
+
+// Skips over a value whose header has been read by read_element_header,
+// including sequences and encapsulated values of undefined length
+MC_STATUS skip_value( rx_stream&      stream,
+                      TRANSFER_SYNTAX syntax,
+                      MC_VR           vr,
+                      uint32_t        length );
+
+// Scans the top-level elements of a data set for tag. On success offset
+// is the stream position immediately following the tag and the stream
+// is left positioned at the start of the value. Returns MC_NOT_FOUND
+// if the element is not present
+MC_STATUS find_element( rx_stream&      stream,
+                        TRANSFER_SYNTAX syntax,
+                        uint32_t        tag,
+                        uint64_t&       offset,
+                        MC_VR&          vr,
+                        uint32_t&       length );
+
+// Reads values as above, but leaves OB, OW and OD values of at least
+// bulk->min_length() bytes in the source file. The values are then
+// copied from the source when written. stream must be positioned
+// relative to the start of the file bulk reads from
+MC_STATUS read_values_upto( rx_stream&                               stream,
+                            TRANSFER_SYNTAX                          syntax,
+                            data_dictionary&                         dict,
+                            int                                      app_id,
+                            uint32_t                                 end_tag,
+                            const std::shared_ptr<bulk_data_source>& bulk );
+
 }
 
 #endif
@@ -24,12 +24,15 @@
 #include "fume/data_dictionary_search.h"
 #include "fume/data_dictionary.h"
 #include "fume/value_representation.h"
+#include "fume/vrs/sq.h"
 
 using boost::numeric_cast;
 using boost::bad_numeric_cast;
 
 using std::move;
 
+using fume::vrs::sq;
+
 namespace fume
 {
 
@@ -42,20 +45,11 @@ dictionary_value_range get_value_range( data_dictionary& dict,
                                         uint32_t         begin_tag,
                                         uint32_t         end_tag )
 {
-    dictionary_iter itr_begin =
-        find_if( dict.begin(),
-                 dict.end(),
-                 [begin_tag]( value_dict::const_reference val )
-                 {
-                     return val.first >= begin_tag;
-                 } );
-    dictionary_iter itr_end =
-        find_if( itr_begin,
-                 dict.end(),
-                 [end_tag]( value_dict::const_reference val )
-                 {
-                     return val.first > end_tag;
-                 } );
+    const dictionary_iter itr_begin = dict.lower_bound( begin_tag );
+    // An inverted range is empty
+    const dictionary_iter itr_end = end_tag >= begin_tag ?
+                                    dict.upper_bound( end_tag ) :
+                                    itr_begin;
 
     return dictionary_value_range( itr_begin, itr_end );
 }
@@ -139,6 +133,110 @@ void copy_values( data_dictionary& dest,
     dest.insert( move( tmp_vals ) );
 }
 
+void copy_values( data_dictionary& dest,
+                  data_dictionary& source,
+                  const uint32_t*  tags_begin,
+                  const uint32_t*  tags_end )
+{
+    value_dict to_add;
+
+    if( tags_begin != tags_end )
+    {
+        const dictionary_value_range& range( get_value_range( source,
+                                                              *tags_begin,
+                                                              *(tags_end - 1) ) );
+
+        dictionary_iter source_itr = range.begin();
+        const uint32_t* tag = tags_begin;
+        while( source_itr != range.end() && tag != tags_end )
+        {
+            if( source_itr->first < *tag )
+            {
+                ++source_itr;
+                if( source_itr != range.end() && source_itr->first < *tag )
+                {
+                    // Skip a run of values which aren't copied rather
+                    // than stepping through it
+                    source_itr = source.lower_bound( *tag );
+                }
+                else
+                {
+                    // Do nothing. Next value is checked against the tag
+                }
+            }
+            else if( source_itr->first > *tag )
+            {
+                ++tag;
+            }
+            else
+            {
+                if( source_itr->second != nullptr )
+                {
+                    // Copied in order, so each value goes at the end
+                    to_add.emplace_hint( to_add.end(),
+                                         *tag,
+                                         source_itr->second->clone() );
+                }
+                else
+                {
+                    // Do nothing. Nothing to copy
+                }
+
+                ++source_itr;
+                ++tag;
+            }
+        }
+    }
+    else
+    {
+        // Do nothing. No tags to copy
+    }
+
+    dest.insert( move( to_add ) );
+}
+
+void move_values( data_dictionary& dest,
+                  data_dictionary& source,
+                  uint32_t         first_tag,
+                  uint32_t         last_tag )
+{
+    const dictionary_value_range& range( get_value_range( source,
+                                                          first_tag,
+                                                          last_tag ) );
+
+    value_dict tmp_vals;
+    source.extract( range.begin(), range.end(), tmp_vals );
+
+    dest.insert( move( tmp_vals ) );
+}
+
+bool range_contains( data_dictionary&       source,
+                     uint32_t               first_tag,
+                     uint32_t               last_tag,
+                     const data_dictionary& dict )
+{
+    const dictionary_value_range& range( get_value_range( source,
+                                                          first_tag,
+                                                          last_tag ) );
+
+    bool found = false;
+    for( dictionary_iter itr = range.begin();
+         found == false && itr != range.end();
+         ++itr )
+    {
+        if( itr->second != nullptr && itr->second->vr() == SQ )
+        {
+            found = static_cast<const sq&>( *itr->second ).contains( dict );
+        }
+        else
+        {
+            // Do nothing. Only sequences contain other objects
+        }
+    }
+
+    return found;
+}
+
 void copy_values( value_dict&      dest,
                   data_dictionary& source,
                   uint32_t         first_tag,
@@ -50,6 +50,29 @@ void copy_values( data_dictionary& dest,
                   uint32_t         first_tag,
                   uint32_t         last_tag );
 
+// Copies the values of source with the tags in [tags_begin, tags_end),
+// which must be in ascending order. The tags and source are walked
+// together in a single pass, skipping over the values which aren't
+// copied
+void copy_values( data_dictionary& dest,
+                  data_dictionary& source,
+                  const uint32_t*  tags_begin,
+                  const uint32_t*  tags_end );
+
+// Moves the values in the tag range from source to dest without copying
+// them. Values already in dest are replaced
+void move_values( data_dictionary& dest,
+                  data_dictionary& source,
+                  uint32_t         first_tag,
+                  uint32_t         last_tag );
+
+// True if dict is an item nested within a sequence in the tag range of
+// source
+bool range_contains( data_dictionary&       source,
+                     uint32_t               first_tag,
+                     uint32_t               last_tag,
+                     const data_dictionary& dict );
+
 }
 
 #endif
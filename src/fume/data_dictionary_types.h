@@ -16,6 +16,8 @@
 #include <cstdint>
 #include <memory>
 #include <map>
+#include <functional>
+#include <utility>
 #include <unordered_map>
 
 // local public
@@ -23,6 +25,7 @@
 #include "mc3msg.h"
 
 // local private
+#include "fume/arena.h"
 
 namespace fume
 {
@@ -30,7 +33,12 @@ namespace fume
 class value_representation;
 
 typedef std::unique_ptr<value_representation> unique_vr_ptr;
-typedef std::map<uint32_t, unique_vr_ptr>     value_dict;
+// Map nodes come from the arena of the file being read, if any
+typedef std::map<uint32_t,
+                 unique_vr_ptr,
+                 std::less<uint32_t>,
+                 arena_allocator<std::pair<const uint32_t,
+                                           unique_vr_ptr>>> value_dict;
 typedef value_dict::value_type                value_dict_item;
 typedef value_dict::const_iterator            dictionary_iter;
 
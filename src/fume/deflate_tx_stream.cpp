@@ -0,0 +1,157 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstring>
+
+// local private
+#include "fume/deflate_tx_stream.h"
+
+namespace fume
+{
+
+static const uint32_t DEFLATE_CHUNK_SIZE = 16u * 1024u;
+// Negative window bits indicates a raw deflate stream with no zlib
+// header or trailer, as required by PS3.5 Annex A.5
+static const int DEFLATE_WINDOW_BITS = -15;
+static const int DEFLATE_MEM_LEVEL = 8;
+
+deflate_tx_stream::deflate_tx_stream( tx_stream& dest, int level )
+    : m_dest( dest ),
+      m_out_buffer( DEFLATE_CHUNK_SIZE ),
+      m_bytes_written( 0 ),
+      m_compressed_bytes( 0 ),
+      m_initialized( false )
+{
+    memset( &m_zstream, 0, sizeof(m_zstream) );
+    m_zstream.zalloc = Z_NULL;
+    m_zstream.zfree = Z_NULL;
+    m_zstream.opaque = Z_NULL;
+
+    m_initialized = deflateInit2( &m_zstream,
+                                  level,
+                                  Z_DEFLATED,
+                                  DEFLATE_WINDOW_BITS,
+                                  DEFLATE_MEM_LEVEL,
+                                  Z_DEFAULT_STRATEGY ) == Z_OK;
+}
+
+deflate_tx_stream::~deflate_tx_stream()
+{
+    if( m_initialized == true )
+    {
+        (void)deflateEnd( &m_zstream );
+    }
+}
+
+MC_STATUS deflate_tx_stream::write( const void* buffer, uint32_t buffer_bytes )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( buffer != nullptr && m_initialized == true )
+    {
+        m_zstream.next_in = static_cast<Bytef*>( const_cast<void*>( buffer ) );
+        m_zstream.avail_in = buffer_bytes;
+
+        ret = run_deflate( Z_NO_FLUSH );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            m_bytes_written += buffer_bytes;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else if( buffer == nullptr )
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+    else
+    {
+        ret = MC_ZLIB_ERROR;
+    }
+
+    return ret;
+}
+
+MC_STATUS deflate_tx_stream::finalize()
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( m_initialized == true )
+    {
+        m_zstream.next_in = Z_NULL;
+        m_zstream.avail_in = 0;
+
+        ret = run_deflate( Z_FINISH );
+        // The deflated data set must have an even length. Pad with a
+        // single trailing NULL byte if necessary
+        if( ret == MC_NORMAL_COMPLETION && m_compressed_bytes % 2u != 0u )
+        {
+            const uint8_t pad = 0u;
+            ret = m_dest.write( &pad, sizeof(pad) );
+            m_compressed_bytes += sizeof(pad);
+        }
+        else
+        {
+            // Do nothing. Either already even or will return error
+        }
+    }
+    else
+    {
+        ret = MC_ZLIB_ERROR;
+    }
+
+    return ret;
+}
+
+MC_STATUS deflate_tx_stream::run_deflate( int flush )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    bool done = false;
+
+    // Keep running the compressor until it has consumed all of its input
+    // and (when finishing) has emitted the end of the deflate stream
+    while( ret == MC_NORMAL_COMPLETION && done == false )
+    {
+        m_zstream.next_out = m_out_buffer.data();
+        m_zstream.avail_out = static_cast<uInt>( m_out_buffer.size() );
+
+        const int zret = deflate( &m_zstream, flush );
+        if( zret == Z_OK || zret == Z_STREAM_END || zret == Z_BUF_ERROR )
+        {
+            const uint32_t produced =
+                static_cast<uint32_t>( m_out_buffer.size() -
+                                       m_zstream.avail_out );
+            if( produced > 0u )
+            {
+                ret = m_dest.write( m_out_buffer.data(), produced );
+                m_compressed_bytes += produced;
+            }
+            else
+            {
+                // Do nothing. No output generated
+            }
+
+            done = flush == Z_FINISH ? zret == Z_STREAM_END :
+                                       m_zstream.avail_out != 0u;
+        }
+        else
+        {
+            ret = MC_ZLIB_ERROR;
+        }
+    }
+
+    return ret;
+}
+
+}
@@ -0,0 +1,71 @@
+#ifndef DEFLATE_TX_STREAM_H
+#define DEFLATE_TX_STREAM_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <vector>
+
+// zlib
+#include <zlib.h>
+
+// local public
+#include "mcstatus.h"
+
+// local private
+#include "fume/tx_stream.h"
+
+namespace fume
+{
+
+// Compresses everything written to it as raw deflate (RFC 1951) data and
+// forwards the compressed bytes to the destination stream. finalize must
+// be called once all data has been written in order to flush the
+// compressor
+class deflate_tx_stream final : public tx_stream
+{
+public:
+    // Note: the destination stream must have a lifetime exceeding that
+    // of this object
+    deflate_tx_stream( tx_stream& dest, int level );
+    ~deflate_tx_stream();
+
+    MC_STATUS finalize();
+
+// tx_stream
+public:
+    virtual MC_STATUS write( const void* buffer,
+                             uint32_t    buffer_bytes ) override final;
+
+    virtual uint64_t tell_write() const override final
+    {
+        return m_bytes_written;
+    }
+
+private:
+    deflate_tx_stream( const deflate_tx_stream& );
+    deflate_tx_stream& operator=( const deflate_tx_stream& );
+
+    MC_STATUS run_deflate( int flush );
+
+private:
+    tx_stream&           m_dest;
+    z_stream             m_zstream;
+    std::vector<uint8_t> m_out_buffer;
+    uint64_t             m_bytes_written;
+    uint64_t             m_compressed_bytes;
+    bool                 m_initialized;
+};
+
+}
+
+#endif
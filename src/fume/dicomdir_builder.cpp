@@ -0,0 +1,850 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// platform
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// local public
+#include "mcstatus.h"
+#include "diction.h"
+
+// local private
+#include "fume/dicomdir_builder.h"
+#include "fume/dicomdir_object.h"
+#include "fume/record_object.h"
+#include "fume/file_object.h"
+#include "fume/file_object_io.h"
+#include "fume/library_context.h"
+#include "fume/record_keys.h"
+#include "fume/tag_filter.h"
+#include "fume/thread_pool.h"
+#include "fume/value_representation.h"
+
+using std::array;
+using std::deque;
+using std::future;
+using std::max;
+using std::min;
+using std::packaged_task;
+using std::pair;
+using std::sort;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace fume
+{
+
+// An element of a file and the element of its record it is copied to
+struct record_key
+{
+    uint32_t file_tag;
+    uint32_t record_tag;
+};
+
+// Elements of the File Meta Information copied to the image record, in
+// addition to the key attributes of the record type
+static const record_key REFERENCED_FILE_KEYS[] =
+{
+    { MC_ATT_MEDIA_STORAGE_SOP_CLASS_UID,
+      MC_ATT_REFERENCED_SOP_CLASS_UID_IN_FILE },
+    { MC_ATT_MEDIA_STORAGE_SOP_INSTANCE_UID,
+      MC_ATT_REFERENCED_SOP_INSTANCE_UID_IN_FILE },
+    { MC_ATT_TRANSFER_SYNTAX_UID,
+      MC_ATT_REFERENCED_TRANSFER_SYNTAX_UID_IN_FILE }
+};
+
+// Types of the records created for each file, from the top level down
+static const MC_DIR_RECORD_TYPE RECORD_TYPES[] =
+{
+    MC_REC_TYPE_PATIENT,
+    MC_REC_TYPE_STUDY,
+    MC_REC_TYPE_SERIES,
+    MC_REC_TYPE_IMAGE
+};
+
+// The elements identifying the record at each level. Files without all
+// of them are skipped
+static const uint32_t REQUIRED_TAGS[] =
+{
+    MC_ATT_PATIENT_ID,
+    MC_ATT_STUDY_INSTANCE_UID,
+    MC_ATT_SERIES_INSTANCE_UID,
+    MC_ATT_MEDIA_STORAGE_SOP_INSTANCE_UID
+};
+
+// A File ID has at most 8 components of at most 8 characters
+static const size_t MAX_FILE_ID_COMPONENTS = 8u;
+static const size_t MAX_FILE_ID_COMPONENT_LENGTH = 8u;
+
+// Number of files read by each task. Large enough that queueing the task
+// costs little next to reading the files
+static const size_t FILES_PER_TASK = 64u;
+
+// Only the start of each file is needed, so the reads are kept small
+static const size_t READ_BUFFER_SIZE = 16384u;
+
+// Initial size of the buffer values are read into. Doubled until the
+// longest value fits
+static const size_t VALUE_BUFFER_SIZE = 256u;
+
+// All of the values of each element read from a file, without padding,
+// ordered by tag
+typedef vector<pair<uint32_t, vector<string> > > file_values;
+
+struct scanned_file
+{
+    // Components separated by backslashes, as written to the record
+    string      file_id;
+    file_values values;
+};
+
+struct stdio_source
+{
+    FILE*                            file;
+    array<uint8_t, READ_BUFFER_SIZE> buffer;
+};
+
+static bool is_file_id_component( const string& name )
+{
+    bool ret = name.empty() == false &&
+               name.size() <= MAX_FILE_ID_COMPONENT_LENGTH;
+
+    for( string::const_iterator itr = name.cbegin();
+         ret == true && itr != name.cend();
+         ++itr )
+    {
+        ret = ( *itr >= 'A' && *itr <= 'Z' ) ||
+              ( *itr >= '0' && *itr <= '9' ) ||
+              *itr == '_';
+    }
+
+    return ret;
+}
+
+// Kinds of directory entry, as far as the file-set is concerned
+enum entry_type
+{
+    DIRECTORY_ENTRY,
+    FILE_ENTRY,
+    OTHER_ENTRY
+};
+
+typedef vector<pair<string, entry_type> > directory_entries;
+
+#ifdef _WIN32
+// Appends the entries of the directory path whose names are valid File
+// ID components to entries. Returns false if the directory can't be read
+static bool read_directory( const string& path, directory_entries& entries )
+{
+    WIN32_FIND_DATAA data;
+    const HANDLE find = FindFirstFileA( ( path + "/*" ).c_str(), &data );
+    if( find != INVALID_HANDLE_VALUE )
+    {
+        do
+        {
+            const string name( data.cFileName );
+            if( is_file_id_component( name ) == false )
+            {
+                // Do nothing. Can't be referenced by a File ID
+            }
+            else if( ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0u )
+            {
+                entries.emplace_back( name, DIRECTORY_ENTRY );
+            }
+            else if( ( data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE ) == 0u )
+            {
+                entries.emplace_back( name, FILE_ENTRY );
+            }
+            else
+            {
+                entries.emplace_back( name, OTHER_ENTRY );
+            }
+        } while( FindNextFileA( find, &data ) != FALSE );
+        (void)FindClose( find );
+    }
+    else
+    {
+        // Do nothing. Will return false
+    }
+
+    return find != INVALID_HANDLE_VALUE;
+}
+#else
+// Appends the entries of the directory path whose names are valid File
+// ID components to entries. Returns false if the directory can't be read
+static bool read_directory( const string& path, directory_entries& entries )
+{
+    DIR* const dir = opendir( path.c_str() );
+    if( dir != nullptr )
+    {
+        for( const dirent* entry = readdir( dir );
+             entry != nullptr;
+             entry = readdir( dir ) )
+        {
+            const string name( entry->d_name );
+            struct stat info;
+            if( is_file_id_component( name ) == false )
+            {
+                // Do nothing. Can't be referenced by a File ID
+            }
+            else if( stat( ( path + '/' + name ).c_str(), &info ) != 0 )
+            {
+                // Do nothing. Removed since the directory was read
+            }
+            else if( S_ISDIR( info.st_mode ) )
+            {
+                entries.emplace_back( name, DIRECTORY_ENTRY );
+            }
+            else if( S_ISREG( info.st_mode ) )
+            {
+                entries.emplace_back( name, FILE_ENTRY );
+            }
+            else
+            {
+                entries.emplace_back( name, OTHER_ENTRY );
+            }
+        }
+        (void)closedir( dir );
+    }
+    else
+    {
+        // Do nothing. Will return false
+    }
+
+    return dir != nullptr;
+}
+#endif
+
+// Appends the files under the directory root/relative whose paths are
+// valid File IDs to files, in sorted order. Returns false if the
+// directory can't be read
+static bool list_files( const string&   root,
+                        const string&   relative,
+                        size_t          depth,
+                        vector<string>& files )
+{
+    const string path = relative.empty() == true ? root : root + '/' + relative;
+
+    directory_entries entries;
+    const bool ret = read_directory( path, entries );
+
+    sort( entries.begin(), entries.end() );
+    for( const pair<string, entry_type>& entry : entries )
+    {
+        const string child = relative.empty() == true ?
+                             entry.first :
+                             relative + '/' + entry.first;
+        if( entry.second == DIRECTORY_ENTRY &&
+            depth + 1u < MAX_FILE_ID_COMPONENTS )
+        {
+            (void)list_files( root, child, depth + 1u, files );
+        }
+        else if( entry.second == FILE_ENTRY && entry.first != "DICOMDIR" )
+        {
+            files.push_back( child );
+        }
+        else
+        {
+            // Do nothing. Not part of the file-set
+        }
+    }
+
+    return ret;
+}
+
+static MC_STATUS read_using_stdio( char*  Cbfilename,
+                                   void*  CbuserInfo,
+                                   int*   CbdataSize,
+                                   void** CbdataBuffer,
+                                   int    CbisFirst,
+                                   int*   CbisLast )
+{
+    assert( CbuserInfo != nullptr );
+    stdio_source* const source = static_cast<stdio_source*>( CbuserInfo );
+
+    const size_t bytes_read = fread( source->buffer.data(),
+                                     1u,
+                                     source->buffer.size(),
+                                     source->file );
+
+    // Check for the end of the file so a full buffer at the end of the
+    // file isn't followed by an empty one
+    const int next = fgetc( source->file );
+    if( next != EOF )
+    {
+        (void)ungetc( next, source->file );
+    }
+    else
+    {
+        // Do nothing. End of file
+    }
+
+    *CbdataSize = static_cast<int>( bytes_read );
+    *CbdataBuffer = source->buffer.data();
+    *CbisLast = static_cast<int>( next == EOF );
+
+    return ferror( source->file ) == 0 ? MC_NORMAL_COMPLETION :
+                                         MC_CANNOT_COMPLY;
+}
+
+static tag_filter create_key_filter()
+{
+    vector<tag_range> ranges;
+
+    for( const MC_DIR_RECORD_TYPE type : RECORD_TYPES )
+    {
+        for( const uint32_t tag : get_record_keys( type ) )
+        {
+            ranges.push_back( tag_range( tag, tag ) );
+        }
+    }
+
+    for( const record_key& key : REFERENCED_FILE_KEYS )
+    {
+        ranges.push_back( tag_range( key.file_tag, key.file_tag ) );
+    }
+
+    return tag_filter( ranges );
+}
+
+static void trim_padding( string& value )
+{
+    const string::size_type end = value.find_last_not_of( " \0", string::npos, 2 );
+    value.erase( end != string::npos ? end + 1u : 0u );
+}
+
+static const vector<string>* find_value( const file_values& values, uint32_t tag )
+{
+    const file_values::const_iterator itr =
+        std::lower_bound( values.cbegin(),
+                          values.cend(),
+                          tag,
+                          []( const pair<uint32_t, vector<string> >& value, uint32_t key )
+                          {
+                              return value.first < key;
+                          } );
+
+    return itr != values.cend() && itr->first == tag ? &itr->second : nullptr;
+}
+
+// Values which can't be read as strings. Getting the value of a sequence
+// would also register its items with the library, which mustn't happen
+// on the threads files are read on
+static bool is_string_vr( MC_VR vr )
+{
+    return vr != SQ &&
+           vr != OB &&
+           vr != OW &&
+           vr != OD &&
+           vr != OF &&
+           vr != OL &&
+           vr != UNKNOWN_VR;
+}
+
+// Reads all of the values of element, growing buffer until the longest
+// fits. Returns false if they can't be read as strings
+static bool get_string_values( value_representation& element,
+                               vector<string>&       values,
+                               vector<char>&         buffer )
+{
+    values.clear();
+    buffer.resize( max( buffer.size(), VALUE_BUFFER_SIZE ) );
+
+    MC_STATUS stat = MC_NORMAL_COMPLETION;
+    bool next = false;
+    while( stat == MC_NORMAL_COMPLETION )
+    {
+        // get sets the second member to the length of the value, so the
+        // parameters are made again for each value
+        get_string_parms parms( buffer.data(), buffer.size() );
+        stat = next == true ? element.get_next( parms ) : element.get( parms );
+        if( stat == MC_NORMAL_COMPLETION )
+        {
+            values.emplace_back( buffer.data(), parms.second );
+            trim_padding( values.back() );
+            next = true;
+        }
+        else if( stat == MC_BUFFER_TOO_SMALL )
+        {
+            // get starts again from the first value
+            buffer.resize( buffer.size() * 2u );
+            values.clear();
+            next = false;
+            stat = MC_NORMAL_COMPLETION;
+        }
+        else
+        {
+            // Do nothing. No more values or they can't be read as strings
+        }
+    }
+
+    return stat == MC_NO_MORE_VALUES;
+}
+
+// Reads the values of the key elements of file which aren't empty
+static void get_file_values( file_object&      file,
+                             const tag_filter& keys,
+                             file_values&      values )
+{
+    vector<string> element_values;
+    vector<char> buffer;
+
+    for( dictionary_iter itr = file.begin(); itr != file.end(); ++itr )
+    {
+        if( keys.contains( itr->first ) == true &&
+            itr->second != nullptr &&
+            itr->second->is_null() == false &&
+            is_string_vr( itr->second->vr() ) == true &&
+            get_string_values( *itr->second, element_values, buffer ) == true &&
+            std::any_of( element_values.cbegin(),
+                         element_values.cend(),
+                         []( const string& value )
+                         {
+                             return value.empty() == false;
+                         } ) )
+        {
+            values.push_back( file_values::value_type( itr->first,
+                                                       element_values ) );
+        }
+        else
+        {
+            // Do nothing. Nothing to copy
+        }
+    }
+}
+
+// Reads the key values of the file at root/relative. Returns false if
+// the file isn't a DICOM file with the required values
+static bool scan_file( const string&     root,
+                       const string&     relative,
+                       const tag_filter& filter,
+                       scanned_file&     scanned )
+{
+    bool ret = false;
+
+    const string path = root + '/' + relative;
+    unique_ptr<stdio_source> source( new stdio_source() );
+    source->file = fopen( path.c_str(), "rb" );
+    if( source->file != nullptr )
+    {
+        // Not registered with the library, so files can be read on any
+        // thread
+        file_object file( 0, path.c_str(), false );
+        const MC_STATUS stat = open_file_filtered( file,
+                                                   -1,
+                                                   filter,
+                                                   source.get(),
+                                                   read_using_stdio );
+        (void)fclose( source->file );
+
+        if( stat == MC_NORMAL_COMPLETION )
+        {
+            get_file_values( file, filter, scanned.values );
+            ret = std::all_of( std::begin( REQUIRED_TAGS ),
+                               std::end( REQUIRED_TAGS ),
+                               [&scanned]( uint32_t tag )
+                               {
+                                   return find_value( scanned.values,
+                                                      tag ) != nullptr;
+                               } );
+        }
+        else
+        {
+            ret = false;
+        }
+    }
+    else
+    {
+        ret = false;
+    }
+
+    if( ret == true )
+    {
+        scanned.file_id = relative;
+        std::replace( scanned.file_id.begin(), scanned.file_id.end(), '/', '\\' );
+    }
+    else
+    {
+        // Do nothing. File is skipped
+    }
+
+    return ret;
+}
+
+static vector<scanned_file> scan_files( const string&         root,
+                                        const vector<string>& files,
+                                        const tag_filter&     filter )
+{
+    vector<scanned_file> ret;
+    ret.reserve( files.size() );
+
+    for( const string& relative : files )
+    {
+        scanned_file scanned;
+        if( scan_file( root, relative, filter, scanned ) == true )
+        {
+            ret.push_back( std::move( scanned ) );
+        }
+        else
+        {
+            // Do nothing. Not a DICOM file with the required values
+        }
+    }
+
+    return ret;
+}
+
+// Sets all of the values of element, in order
+static MC_STATUS set_string_values( value_representation& element,
+                                    const vector<string>& values )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    for( vector<string>::const_iterator itr = values.cbegin();
+         ret == MC_NORMAL_COMPLETION && itr != values.cend();
+         ++itr )
+    {
+        ret = itr == values.cbegin() ? element.set( itr->c_str() ) :
+                                       element.set_next( itr->c_str() );
+    }
+
+    return ret;
+}
+
+// Sets the values of the key attributes of record from the values of
+// file. Both are in ascending order, so they're walked together
+static MC_STATUS set_key_values( record_object&          record,
+                                 const scanned_file&     file,
+                                 const record_key_range& keys )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    file_values::const_iterator value = file.values.cbegin();
+    record_key_range::const_iterator key = keys.begin();
+    while( ret == MC_NORMAL_COMPLETION &&
+           value != file.values.cend() &&
+           key != keys.end() )
+    {
+        if( value->first < *key )
+        {
+            ++value;
+        }
+        else if( value->first > *key )
+        {
+            // File has no value for the key. Element is left empty
+            ++key;
+        }
+        else
+        {
+            ret = set_string_values( record[*key], value->second );
+            ++value;
+            ++key;
+        }
+    }
+
+    return ret;
+}
+
+static MC_STATUS set_record_values( record_object&      record,
+                                    const scanned_file& file,
+                                    const record_key*   begin,
+                                    const record_key*   end )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    for( const record_key* key = begin;
+         ret == MC_NORMAL_COMPLETION && key != end;
+         ++key )
+    {
+        const vector<string>* const value = find_value( file.values, key->file_tag );
+        if( value != nullptr )
+        {
+            ret = set_string_values( record[key->record_tag], *value );
+        }
+        else
+        {
+            // Do nothing. Element is left empty
+        }
+    }
+
+    return ret;
+}
+
+// Finds the record under parent whose key_tag has the value of the
+// file, creating it with the values of keys if there isn't one
+static MC_STATUS get_record( dicomdir_object&        dicomdir,
+                             record_object*          parent,
+                             const char*             record_type,
+                             uint32_t                key_tag,
+                             const record_key_range& keys,
+                             const scanned_file&     file,
+                             record_object*&         record )
+{
+    assert( g_context != nullptr );
+
+    // The identifying elements have a single value
+    const vector<string>* const key = find_value( file.values, key_tag );
+    assert( key != nullptr && key->empty() == false );
+
+    // The same key may be under more than one parent (ie. a study whose
+    // files have inconsistent Patient IDs), so the record under parent
+    // is looked for among all the records with the key
+    vector<int> record_ids;
+    MC_STATUS ret = dicomdir.find_records( key_tag, key->front(), record_ids );
+    const int parent_id = parent != nullptr ? parent->id() : dicomdir.id();
+    int record_id = 0;
+    for( vector<int>::const_iterator itr = record_ids.cbegin();
+         ret == MC_NORMAL_COMPLETION && record_id <= 0 && itr != record_ids.cend();
+         ++itr )
+    {
+        record = dynamic_cast<record_object*>( g_context->find_object( *itr ) );
+        if( record != nullptr && record->get_parent_record() == parent_id )
+        {
+            record_id = *itr;
+        }
+        else
+        {
+            // Do nothing. Same key under another parent, so not the same
+            // entity
+        }
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && record_id <= 0 )
+    {
+        ret = dicomdir.add_record( parent, record_type, record_id );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            record = dynamic_cast<record_object*>( g_context->find_object( record_id ) );
+            ret = record != nullptr ?
+                      set_key_values( *record, file, keys ) :
+                      MC_INVALID_RECORD_ID;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error or the record was found
+    }
+
+    return ret;
+}
+
+static MC_STATUS add_file_records( dicomdir_object&    dicomdir,
+                                   const scanned_file& file,
+                                   int&                files_added )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    const vector<string>* const sop_instance_uid =
+        find_value( file.values, MC_ATT_MEDIA_STORAGE_SOP_INSTANCE_UID );
+    assert( sop_instance_uid != nullptr && sop_instance_uid->empty() == false );
+
+    int existing_id = 0;
+    ret = dicomdir.find_record( MC_ATT_REFERENCED_SOP_INSTANCE_UID_IN_FILE,
+                                sop_instance_uid->front(),
+                                existing_id );
+    if( ret == MC_NORMAL_COMPLETION && existing_id <= 0 )
+    {
+        record_object* patient = nullptr;
+        record_object* study = nullptr;
+        record_object* series = nullptr;
+        record_object* image = nullptr;
+
+        ret = get_record( dicomdir,
+                          nullptr,
+                          "PATIENT",
+                          MC_ATT_PATIENT_ID,
+                          get_record_keys( MC_REC_TYPE_PATIENT ),
+                          file,
+                          patient );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = get_record( dicomdir,
+                              patient,
+                              "STUDY",
+                              MC_ATT_STUDY_INSTANCE_UID,
+                              get_record_keys( MC_REC_TYPE_STUDY ),
+                              file,
+                              study );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = get_record( dicomdir,
+                              study,
+                              "SERIES",
+                              MC_ATT_SERIES_INSTANCE_UID,
+                              get_record_keys( MC_REC_TYPE_SERIES ),
+                              file,
+                              series );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        int image_id = 0;
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = dicomdir.add_record( series, "IMAGE", image_id );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            image = dynamic_cast<record_object*>( g_context->find_object( image_id ) );
+            ret = image != nullptr ?
+                      (*image)[MC_ATT_REFERENCED_FILE_ID].set( file.file_id.c_str() ) :
+                      MC_INVALID_RECORD_ID;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = set_key_values( *image,
+                                  file,
+                                  get_record_keys( MC_REC_TYPE_IMAGE ) );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = set_record_values( *image,
+                                     file,
+                                     std::begin( REFERENCED_FILE_KEYS ),
+                                     std::end( REFERENCED_FILE_KEYS ) );
+            files_added += static_cast<int>( ret == MC_NORMAL_COMPLETION );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error or the file is already referenced
+    }
+
+    return ret;
+}
+
+MC_STATUS add_directory_records( dicomdir_object& dicomdir,
+                                 const string&    root,
+                                 size_t           num_threads,
+                                 int&             files_added )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    files_added = 0;
+
+    vector<string> files;
+    if( list_files( root, string(), 0u, files ) == true )
+    {
+        ret = MC_NORMAL_COMPLETION;
+
+        // Declared before the pool so it outlives the tasks
+        const tag_filter filter( create_key_filter() );
+        unique_ptr<thread_pool> pool( num_threads > 1u ?
+                                          new thread_pool( num_threads ) :
+                                          nullptr );
+
+        // Files are read ahead of the records being created by at most
+        // two tasks per thread, which bounds the memory used
+        const size_t max_pending = pool != nullptr ? pool->size() * 2u : 1u;
+        deque<future<vector<scanned_file> > > pending;
+        size_t next = 0u;
+        while( ret == MC_NORMAL_COMPLETION &&
+               ( next < files.size() || pending.empty() == false ) )
+        {
+            if( next < files.size() && pending.size() < max_pending )
+            {
+                const size_t last = min( next + FILES_PER_TASK, files.size() );
+                const vector<string> batch( files.cbegin() + next,
+                                            files.cbegin() + last );
+                next = last;
+
+                const auto job = [&root, &filter, batch]()
+                {
+                    return scan_files( root, batch, filter );
+                };
+
+                if( pool != nullptr )
+                {
+                    pending.push_back( pool->submit( job ) );
+                }
+                else
+                {
+                    packaged_task<vector<scanned_file>()> task( job );
+                    pending.push_back( task.get_future() );
+                    task();
+                }
+            }
+            else
+            {
+                const vector<scanned_file> scanned( pending.front().get() );
+                pending.pop_front();
+
+                for( vector<scanned_file>::const_iterator itr = scanned.cbegin();
+                     ret == MC_NORMAL_COMPLETION && itr != scanned.cend();
+                     ++itr )
+                {
+                    ret = add_file_records( dicomdir, *itr, files_added );
+                }
+            }
+        }
+    }
+    else
+    {
+        ret = MC_CANNOT_COMPLY;
+    }
+
+    return ret;
+}
+
+}
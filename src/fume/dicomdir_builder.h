@@ -0,0 +1,47 @@
+#ifndef DICOMDIR_BUILDER_H
+#define DICOMDIR_BUILDER_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <string>
+
+// local public
+#include "mcstatus.h"
+
+namespace fume
+{
+
+class dicomdir_object;
+
+// Adds PATIENT, STUDY, SERIES and IMAGE records to dicomdir for every
+// DICOM file in the directory tree under root whose path is a valid
+// File ID. Referenced File IDs are relative to root, which should be the
+// directory the DICOMDIR is in. Existing patient, study and series
+// records are reused, and files already referenced are skipped.
+//
+// Only the elements needed for the records are read from each file. The
+// files are read on num_threads threads, while the records are created
+// on the calling thread in path order so the result doesn't depend on
+// the number of threads. files_added is the number of IMAGE records
+// created.
+//
+// Directories are listed with the POSIX functions. Where they aren't
+// available MC_CANNOT_COMPLY is returned
+MC_STATUS add_directory_records( dicomdir_object&   dicomdir,
+                                 const std::string& root,
+                                 size_t             num_threads,
+                                 int&               files_added );
+
+}
+
+#endif
@@ -10,9 +10,25 @@
  */
 
 // std
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// platform
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 // local public
 #include "mc3msg.h"
@@ -22,25 +38,498 @@
 // local private
 #include "fume/library_context.h"
 #include "fume/dicomdir_object.h"
-#include "fume/null_tx_stream.h"
+#include "fume/buffer_tx_stream.h"
+#include "fume/file_tx_stream.h"
 #include "fume/value_representation.h"
 #include "fume/record_object.h"
 #include "fume/data_dictionary_search.h"
 #include "fume/file_object_io.h"
+#include "fume/data_dictionary_io.h"
+#include "fume/implicit_vr_cache.h"
+#include "fume/buffer_rx_stream.h"
+#include "fume/record_source.h"
+#include "fume/record_index.h"
+#include "fume/arena.h"
+#include "fume/vrs/sq.h"
 
 using std::unordered_map;
+using std::unordered_set;
+using std::min;
+using std::numeric_limits;
+using std::shared_ptr;
+using std::unique_ptr;
+using std::make_shared;
+using std::string;
+using std::pair;
+using std::vector;
+
+using fume::vrs::sq;
 
 namespace fume
 {
 
-typedef unordered_map<int, uint32_t> offset_map_t;
+typedef unordered_set<const record_object*> record_set_t;
+
+static const uint32_t UNDEFINED_LENGTH = 0xFFFFFFFFu;
+
+// Index of a scanned record which doesn't exist
+static const size_t NO_RECORD = numeric_limits<size_t>::max();
 
-struct root_record_offet_context
+// A directory record found by scanning the Directory Record Sequence
+// of a DICOMDIR being opened. Only the offsets needed to link the
+// records are read. The rest of the record is read when it is used
+struct scanned_record
 {
-    const dicomdir_object& dicomdir;
-    const offset_map_t&    offsets;
+    // Offset of the item tag, which is what other records refer to
+    uint32_t offset;
+    // Position of the encoded values of the record in the file
+    uint64_t values_offset;
+    uint32_t values_length;
+    uint32_t next_offset;
+    uint32_t lower_offset;
+    // Positions of the offset values in the file
+    uint64_t next_offset_position;
+    uint64_t lower_offset_position;
+    // Indexes of the linked records
+    size_t   parent;
+    size_t   next;
+    size_t   first_child;
+    size_t   last_child;
+    // ID of the record object once created
+    int      id;
 };
 
+static MC_STATUS read_whole_file( const string& filename, vector<uint8_t>& data )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    FILE* f = fopen( filename.c_str(), "rb" );
+    if( f != nullptr )
+    {
+        long size = -1;
+        if( fseek( f, 0, SEEK_END ) == 0 )
+        {
+            size = ftell( f );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( size >= 0 && fseek( f, 0, SEEK_SET ) == 0 )
+        {
+            vector<uint8_t> tmp_data( static_cast<size_t>( size ) );
+            if( tmp_data.empty() == true ||
+                fread( tmp_data.data(), tmp_data.size(), 1, f ) == 1u )
+            {
+                data.swap( tmp_data );
+                ret = MC_NORMAL_COMPLETION;
+            }
+            else
+            {
+                ret = MC_CANNOT_COMPLY;
+            }
+        }
+        else
+        {
+            ret = MC_CANNOT_COMPLY;
+        }
+
+        fclose( f );
+    }
+    else
+    {
+        ret = MC_CANNOT_COMPLY;
+    }
+
+    return ret;
+}
+
+// Reads the offsets of a record whose item header has been read,
+// skipping the rest of its values
+static MC_STATUS scan_record( rx_stream&      stream,
+                              TRANSFER_SYNTAX syntax,
+                              uint32_t        item_length,
+                              scanned_record& record )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    record.values_offset = stream.tell_read();
+
+    bool finished = false;
+    while( ret == MC_NORMAL_COMPLETION && finished == false )
+    {
+        const uint64_t element_offset = stream.tell_read();
+        const uint64_t bytes_read = element_offset - record.values_offset;
+        if( item_length != UNDEFINED_LENGTH && bytes_read >= item_length )
+        {
+            record.values_length = item_length;
+            finished = true;
+            ret = bytes_read == item_length ? MC_NORMAL_COMPLETION :
+                                              MC_INVALID_DICOMDIR_FILE;
+        }
+        else
+        {
+            uint32_t tag = 0;
+            ret = stream.read_tag( tag, syntax );
+            if( ret == MC_NORMAL_COMPLETION &&
+                tag == MC_ATT_ITEM_DELIMITATION_ITEM &&
+                item_length == UNDEFINED_LENGTH )
+            {
+                // Read the length (which should be zero, but we aren't going
+                // to check)
+                uint32_t delim_length = 0;
+                ret = stream.read_val( delim_length, syntax );
+                record.values_length = static_cast<uint32_t>( bytes_read );
+                finished = true;
+            }
+            else if( ret == MC_NORMAL_COMPLETION &&
+                     (tag == MC_ATT_ITEM_DELIMITATION_ITEM ||
+                      tag == MC_ATT_ITEM ||
+                      tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM) )
+            {
+                ret = MC_INVALID_DICOMDIR_FILE;
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                MC_VR vr = UNKNOWN_VR;
+                uint32_t length = 0;
+                ret = read_element_header( stream,
+                                           syntax,
+                                           tag,
+                                           vr,
+                                           length );
+                if( ret == MC_NORMAL_COMPLETION &&
+                    (tag == MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD ||
+                     tag == MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY) )
+                {
+                    const uint64_t position = stream.tell_read();
+                    uint32_t offset = 0;
+                    if( length == sizeof(offset) )
+                    {
+                        ret = stream.read_val( offset, syntax );
+                    }
+                    else
+                    {
+                        ret = MC_INVALID_DICOMDIR_FILE;
+                    }
+
+                    if( tag == MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD )
+                    {
+                        record.next_offset = offset;
+                        record.next_offset_position = position;
+                    }
+                    else
+                    {
+                        record.lower_offset = offset;
+                        record.lower_offset_position = position;
+                    }
+                }
+                else if( ret == MC_NORMAL_COMPLETION )
+                {
+                    ret = skip_value( stream, syntax, vr, length );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+    }
+
+    return ret;
+}
+
+// Scans the items of the Directory Record Sequence, whose header has
+// been read
+static MC_STATUS scan_records( rx_stream&              stream,
+                               TRANSFER_SYNTAX         syntax,
+                               uint32_t                length,
+                               vector<scanned_record>& records )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    const uint64_t start_offset = stream.tell_read();
+
+    bool finished = false;
+    while( ret == MC_NORMAL_COMPLETION && finished == false )
+    {
+        const uint64_t item_offset = stream.tell_read();
+        if( length != UNDEFINED_LENGTH && item_offset - start_offset >= length )
+        {
+            finished = true;
+        }
+        else
+        {
+            uint32_t tag = 0;
+            uint32_t item_length = 0;
+            ret = stream.read_tag( tag, syntax );
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = stream.read_val( item_length, syntax );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+
+            if( ret == MC_NORMAL_COMPLETION &&
+                tag == MC_ATT_ITEM &&
+                item_offset <= numeric_limits<uint32_t>::max() )
+            {
+                scanned_record record = { static_cast<uint32_t>( item_offset ),
+                                          0u,
+                                          0u,
+                                          0u,
+                                          0u,
+                                          0u,
+                                          0u,
+                                          NO_RECORD,
+                                          NO_RECORD,
+                                          NO_RECORD,
+                                          NO_RECORD,
+                                          0 };
+                ret = scan_record( stream, syntax, item_length, record );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    records.push_back( record );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else if( ret == MC_NORMAL_COMPLETION &&
+                     tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM &&
+                     length == UNDEFINED_LENGTH )
+            {
+                finished = true;
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                // An unexpected tag, or a record which can't be referred
+                // to by a 32-bit offset
+                ret = MC_INVALID_DICOMDIR_FILE;
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+    }
+
+    return ret;
+}
+
+// Links the records by following the chains of next records starting
+// at the root. order receives the indexes of the records such that each
+// record comes after its parent. Records not referred to by any other
+// record (eg. inactive records) are kept, so they are written back out,
+// at the root level but aren't part of a chain. Their indexes are
+// appended to unreferenced
+static MC_STATUS link_records( uint32_t                root_offset,
+                               vector<scanned_record>& records,
+                               vector<size_t>&         order,
+                               vector<size_t>&         unreferenced,
+                               size_t&                 root_first,
+                               size_t&                 root_last )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    unordered_map<uint32_t, size_t> indexes( records.size() );
+    for( size_t i = 0; i < records.size(); ++i )
+    {
+        indexes[records[i].offset] = i;
+    }
+
+    vector<bool> linked( records.size(), false );
+    order.reserve( records.size() );
+
+    // The offset of the first record of each chain still to be linked
+    // and the index of the parent of the chain
+    vector<pair<uint32_t, size_t>> chains;
+    chains.emplace_back( root_offset, NO_RECORD );
+    while( ret == MC_NORMAL_COMPLETION && chains.empty() == false )
+    {
+        uint32_t offset = chains.back().first;
+        const size_t parent = chains.back().second;
+        chains.pop_back();
+
+        size_t prev = NO_RECORD;
+        while( ret == MC_NORMAL_COMPLETION && offset != 0u )
+        {
+            const unordered_map<uint32_t, size_t>::const_iterator itr =
+                indexes.find( offset );
+            if( itr != indexes.cend() && linked[itr->second] == false )
+            {
+                const size_t index = itr->second;
+                scanned_record& record = records[index];
+
+                linked[index] = true;
+                order.push_back( index );
+                record.parent = parent;
+                if( prev != NO_RECORD )
+                {
+                    records[prev].next = index;
+                }
+                else if( parent != NO_RECORD )
+                {
+                    records[parent].first_child = index;
+                }
+                else
+                {
+                    root_first = index;
+                }
+
+                if( record.lower_offset != 0u )
+                {
+                    chains.emplace_back( record.lower_offset, index );
+                }
+                else
+                {
+                    // Do nothing. No lower level records
+                }
+
+                prev = index;
+                offset = record.next_offset;
+            }
+            else if( itr != indexes.cend() )
+            {
+                // A record referred to twice would make a loop
+                ret = MC_INVALID_DICOMDIR_FILE;
+            }
+            else
+            {
+                ret = MC_INVALID_DIRECTORY_RECORD_OFFSET;
+            }
+        }
+
+        if( parent != NO_RECORD )
+        {
+            records[parent].last_child = prev;
+        }
+        else
+        {
+            root_last = prev;
+        }
+    }
+
+    for( size_t i = 0; i < records.size(); ++i )
+    {
+        if( linked[i] == false )
+        {
+            order.push_back( i );
+            unreferenced.push_back( i );
+        }
+        else
+        {
+            // Do nothing. Already in order
+        }
+    }
+
+    return ret;
+}
+
+static record_object* get_record( const vector<record_object*>& objects,
+                                  size_t                        index )
+{
+    return index != NO_RECORD ? objects[index] : nullptr;
+}
+
+// Creates the record objects, parents first, and adds them to the
+// Directory Record Sequence in the order they appear in the file
+static MC_STATUS create_records( dicomdir_object&                 dicomdir,
+                                 const shared_ptr<record_source>& source,
+                                 vector<scanned_record>&          records,
+                                 const vector<size_t>&            order,
+                                 vector<record_object*>&          objects )
+{
+    assert( g_context != nullptr );
+
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    objects.assign( records.size(), nullptr );
+    for( vector<size_t>::const_iterator itr = order.cbegin();
+         ret == MC_NORMAL_COMPLETION && itr != order.cend();
+         ++itr )
+    {
+        scanned_record& record = records[*itr];
+        const int parent_id = record.parent != NO_RECORD ?
+                              records[record.parent].id :
+                              dicomdir.id();
+
+        const int id = g_context->create_record_object( dicomdir.id(),
+                                                        parent_id,
+                                                        nullptr );
+        if( id > 0 )
+        {
+            record.id = id;
+            objects[*itr] =
+                dynamic_cast<record_object*>( g_context->find_object( id ) );
+            assert( objects[*itr] != nullptr );
+            objects[*itr]->set_source( source,
+                                       record.values_offset,
+                                       record.values_length );
+            objects[*itr]->set_file_position( record.offset,
+                                              record.next_offset_position,
+                                              record.lower_offset_position );
+        }
+        else
+        {
+            ret = static_cast<MC_STATUS>( -id );
+        }
+    }
+
+    value_representation& sequence = dicomdir[MC_ATT_DIRECTORY_RECORD_SEQUENCE];
+    for( size_t i = 0; ret == MC_NORMAL_COMPLETION && i < records.size(); ++i )
+    {
+        record_object* const next = get_record( objects, records[i].next );
+        objects[i]->set_next_record( next );
+        if( next != nullptr )
+        {
+            next->set_prev_record( objects[i] );
+        }
+        else
+        {
+            // Do nothing. Last record in its chain
+        }
+        objects[i]->set_child_record( get_record( objects,
+                                                  records[i].first_child ) );
+        objects[i]->set_last_child_record( get_record( objects,
+                                                       records[i].last_child ) );
+
+        ret = i == 0 ? sequence.set( records[i].id ) :
+                       sequence.set_next( records[i].id );
+    }
+
+    if( ret != MC_NORMAL_COMPLETION )
+    {
+        // Records added to the sequence are freed with the DICOMDIR.
+        // This only releases their IDs
+        for( const scanned_record& record : records )
+        {
+            if( record.id > 0 )
+            {
+                (void)g_context->free_item_object( record.id );
+            }
+            else
+            {
+                // Do nothing. Record was not created
+            }
+        }
+    }
+    else
+    {
+        // Do nothing. Records belong to the DICOMDIR
+    }
+
+    return ret;
+}
+
 static MC_STATUS write_using_stdio( char* Cbfilename,
                                     void* CbuserInfo,
                                     int   CbdataSize,
@@ -109,231 +598,1646 @@ static MC_STATUS write_using_stdio( char* Cbfilename,
     return ret;
 }
 
-static MC_STATUS write_record_offset( int                 parent_id,
-                                      uint32_t            tag,
-                                      int                 record_id_to_write,
-                                      const offset_map_t& offsets )
+// Offsets are taken from the linked records themselves rather than
+// looked up by ID, since the ID of a record can be released while the
+// record is still linked
+static uint32_t get_record_offset( const record_object* record )
 {
-    const offset_map_t::const_iterator itr = offsets.find( record_id_to_write );
-    const bool has_record = record_id_to_write > 0 && itr != offsets.cend();
-    const uint32_t offset = has_record ? itr->second : 0u;
-
-    return MC_Set_Value_From_ULongInt( parent_id, tag, offset );
+    return record != nullptr ? record->get_offset() : 0u;
 }
 
-static MC_TRAVERSAL_STATUS update_record_offsets( int   CurrentRecID,
-                                                  void* UserData )
+// Positions of the values of a written DICOMDIR which are changed once
+// its records have been written
+struct dicomdir_positions
 {
-    MC_TRAVERSAL_STATUS ret = MC_TS_CONTINUE;
+    uint64_t first_root;
+    uint64_t last_root;
+    uint64_t consistency_flag;
+};
 
-    assert( UserData != nullptr );
-    const offset_map_t& offset_map( *static_cast<offset_map_t*>( UserData ) );
-    record_object* record =
-        dynamic_cast<record_object*>( g_context->get_object( CurrentRecID ) );
-    if( record != nullptr )
+static MC_STATUS write_consistency_flag( tx_stream&       stream,
+                                         TRANSFER_SYNTAX  syntax,
+                                         dicomdir_object& dicomdir,
+                                         uint64_t&        position )
+{
+    value_representation& element = dicomdir[MC_ATT_FILE_SET_CONSISTENCY_FLAG];
+    if( element.count() != 1 )
     {
-        MC_STATUS stat = write_record_offset
-                         (
-                             CurrentRecID,
-                             MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD,
-                             record->get_next_record(),
-                             offset_map
-                         );
-        if( stat == MC_NORMAL_COMPLETION )
-        {
-            stat = write_record_offset
-                   (
-                       CurrentRecID,
-                       MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY,
-                       record->get_child_record(),
-                       offset_map
-                   );
-            ret = stat == MC_NORMAL_COMPLETION ? MC_TS_CONTINUE : MC_TS_ERROR;
-        }
-        else
-        {
-            ret = MC_TS_ERROR;
-        }
+        (void)element.set( 0u );
     }
     else
     {
-        ret = MC_TS_ERROR;
+        // Do nothing. Already a single value
     }
 
+    const MC_STATUS ret = write_values( stream,
+                                        syntax,
+                                        dicomdir,
+                                        dicomdir.application_id(),
+                                        MC_ATT_FILE_SET_CONSISTENCY_FLAG,
+                                        MC_ATT_FILE_SET_CONSISTENCY_FLAG );
+    // The value is the last thing written
+    position = stream.tell_write() - sizeof(uint16_t);
+
     return ret;
 }
 
-static MC_TRAVERSAL_STATUS update_root_offsets( int   CurrentRecID,
-                                                void* UserData )
+// Writes the part of the DICOMDIR in front of the Directory Record
+// Sequence
+static MC_STATUS write_dicomdir_header( tx_stream&          stream,
+                                        TRANSFER_SYNTAX     syntax,
+                                        dicomdir_object&    dicomdir,
+                                        dicomdir_positions& positions )
 {
-    assert( UserData != nullptr );
+    const int app_id = dicomdir.application_id();
+
+    MC_STATUS ret = write_file_header( stream, dicomdir, app_id );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_values( stream,
+                            syntax,
+                            dicomdir,
+                            app_id,
+                            0x00030000u,
+                            MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY - 1u );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
 
-    const root_record_offet_context& context
-    (
-        *static_cast<root_record_offet_context*>( UserData )
-    );
-    const bool is_first = context.dicomdir.get_child_record() == CurrentRecID;
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_fixed_ul( stream,
+                              syntax,
+                              dicomdir,
+                              MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY,
+                              positions.first_root );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
 
-    MC_STATUS stat = MC_CANNOT_COMPLY;
-    if( is_first == true )
+    if( ret == MC_NORMAL_COMPLETION )
     {
-        stat = write_record_offset
-               (
-                   context.dicomdir.id(),
-                   MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY,
-                   CurrentRecID,
-                   context.offsets
-               );
+        ret = write_values( stream,
+                            syntax,
+                            dicomdir,
+                            app_id,
+                            MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY + 1u,
+                            MC_ATT_OFFSET_OF_THE_LAST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY - 1u );
     }
     else
     {
-        // Not first record. Write to last record item but not first
-        stat = MC_NORMAL_COMPLETION;
+        // Do nothing. Will return error
     }
 
-    if( stat == MC_NORMAL_COMPLETION )
+    if( ret == MC_NORMAL_COMPLETION )
     {
-        stat = write_record_offset
-               (
-                   context.dicomdir.id(),
-                   MC_ATT_OFFSET_OF_THE_LAST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY,
-                   CurrentRecID,
-                   context.offsets
-               );
+        ret = write_fixed_ul( stream,
+                              syntax,
+                              dicomdir,
+                              MC_ATT_OFFSET_OF_THE_LAST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY,
+                              positions.last_root );
     }
     else
     {
-        // Do nothing. Return error
+        // Do nothing. Will return error
     }
 
-    // Either traverse the next item or report an error
-    return stat == MC_NORMAL_COMPLETION ? MC_TS_STOP_LOWER : MC_TS_ERROR;
-}
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_values( stream,
+                            syntax,
+                            dicomdir,
+                            app_id,
+                            MC_ATT_OFFSET_OF_THE_LAST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY + 1u,
+                            MC_ATT_FILE_SET_CONSISTENCY_FLAG - 1u );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
 
-static MC_STATUS update_offset_values( dicomdir_object&    dicomdir,
-                                       const offset_map_t& offsets )
-{
-    root_record_offet_context root_context = { dicomdir, offsets };
-    // Update the record offsets pointing to the root records
-    MC_STATUS ret = MC_DDH_Traverse_Records( dicomdir.id(),
-                                             static_cast<void*>( &root_context ),
-                                             update_root_offsets );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_consistency_flag( stream,
+                                      syntax,
+                                      dicomdir,
+                                      positions.consistency_flag );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
 
     if( ret == MC_NORMAL_COMPLETION )
     {
-        // Update the record offsets in the records themselves
-        ret = MC_DDH_Traverse_Records( dicomdir.id(),
-                                       const_cast<offset_map_t*>( &offsets ),
-                                       update_record_offsets );
+        ret = write_values( stream,
+                            syntax,
+                            dicomdir,
+                            app_id,
+                            MC_ATT_FILE_SET_CONSISTENCY_FLAG + 1u,
+                            MC_ATT_DIRECTORY_RECORD_SEQUENCE - 1u );
+    }
+    else
+    {
+        // Do nothing. Will return error
     }
 
     return ret;
 }
 
-static MC_STATUS get_record_offsets( value_representation& record_sequence,
-                                     offset_map_t&         record_offsets )
+// Writes the DICOMDIR, recording the positions of the root record
+// offsets so they can be patched once the records have been written
+static MC_STATUS write_dicomdir( tx_stream&          stream,
+                                 TRANSFER_SYNTAX     syntax,
+                                 dicomdir_object&    dicomdir,
+                                 dicomdir_positions& positions )
 {
-    MC_STATUS ret = MC_CANNOT_COMPLY;
-    offset_map_t tmp_offsets;
-
-    int cur_record_id = 0;
-    if( record_sequence.is_null() == false )
+    MC_STATUS ret = write_dicomdir_header( stream, syntax, dicomdir, positions );
+    if( ret == MC_NORMAL_COMPLETION )
     {
-        ret = record_sequence.get( cur_record_id );
-        while( ret == MC_NORMAL_COMPLETION )
-        {
-            assert( g_context != nullptr );
-            const record_object* record =
-                dynamic_cast<record_object*>( g_context->get_object( cur_record_id ) );
-            if( record != nullptr )
-            {
-                tmp_offsets[cur_record_id] = record->get_offset();
-                ret = record_sequence.get_next( cur_record_id );
-            }
-            else
-            {
-                ret = MC_INVALID_RECORD_ID;
-            }
-        }
-
-        if( ret == MC_NO_MORE_VALUES )
-        {
-            // Only update output upon successful completion
-            record_offsets.swap( tmp_offsets );
-            ret = MC_NORMAL_COMPLETION;
-        }
-        else
-        {
-            // Do nothing. Will return error
-        }
+        // Includes the records, which save their own offsets
+        ret = write_values( stream,
+                            syntax,
+                            dicomdir,
+                            dicomdir.application_id(),
+                            MC_ATT_DIRECTORY_RECORD_SEQUENCE,
+                            0xFFFFFFFFu );
     }
     else
     {
-        record_offsets.swap( tmp_offsets );
-        ret = MC_NORMAL_COMPLETION;
+        // Do nothing. Will return error
     }
 
     return ret;
 }
 
-dicomdir_object::dicomdir_object( int                    id,
-                                  const char*            filename,
-                                  data_dictionary* source,
-                                  bool                   created_empty )
-    : file_object( id, filename, created_empty )
+// Sets an offset value both in the written data and in the object it
+// was written from
+static MC_STATUS patch_offset( buffer_tx_stream& stream,
+                               TRANSFER_SYNTAX   syntax,
+                               data_dictionary&  dict,
+                               uint32_t          tag,
+                               uint64_t          position,
+                               uint32_t          offset )
 {
-    if( source != nullptr )
+    MC_STATUS ret = dict[tag].set( static_cast<unsigned long>( offset ) );
+    if( ret == MC_NORMAL_COMPLETION )
     {
-        // Just copy tags from groups 2 through 4
-        // TODO: remove when we have message templates based on IOD type
-        // Do before we assign DICOMDIR values to prevent these values from
-        // overwriting ours
-        copy_values( *this, *source, 0x00020000u, 0x0004FFFFu );
+        ret = stream.seek( position );
     }
-
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = stream.write_val( offset, syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+// Gets the items of the Directory Record Sequence
+static void get_record_items( dicomdir_object&      dicomdir,
+                              vector<item_object*>& items )
+{
+    const value_representation* const sequence =
+        dicomdir.at( MC_ATT_DIRECTORY_RECORD_SEQUENCE );
+    if( sequence != nullptr && sequence->vr() == SQ )
+    {
+        static_cast<const sq*>( sequence )->get_items( items );
+    }
+    else
+    {
+        // Do nothing. No records
+    }
+}
+
+static MC_STATUS get_records( dicomdir_object&        dicomdir,
+                              vector<record_object*>& records )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    // The records are taken straight from the sequence rather than
+    // looked up by ID
+    vector<item_object*> items;
+    get_record_items( dicomdir, items );
+
+    records.reserve( items.size() );
+    for( vector<item_object*>::const_iterator itr = items.cbegin();
+         ret == MC_NORMAL_COMPLETION && itr != items.cend();
+         ++itr )
+    {
+        record_object* const record = dynamic_cast<record_object*>( *itr );
+        if( record != nullptr )
+        {
+            records.push_back( record );
+        }
+        else
+        {
+            ret = MC_INVALID_RECORD_ID;
+        }
+    }
+
+    return ret;
+}
+
+// Fills in the offsets of the records written to stream from the
+// offsets saved while writing them
+static MC_STATUS patch_record_offsets( buffer_tx_stream&         stream,
+                                       TRANSFER_SYNTAX           syntax,
+                                       dicomdir_object&          dicomdir,
+                                       const dicomdir_positions& positions )
+{
+    vector<record_object*> records;
+    MC_STATUS ret = get_records( dicomdir, records );
+
+    for( vector<record_object*>::const_iterator itr = records.cbegin();
+         ret == MC_NORMAL_COMPLETION && itr != records.cend();
+         ++itr )
+    {
+        record_object& record = **itr;
+        ret = patch_offset( stream,
+                            syntax,
+                            record,
+                            MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD,
+                            record.get_next_offset_position(),
+                            get_record_offset( record.next_record() ) );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = patch_offset( stream,
+                                syntax,
+                                record,
+                                MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY,
+                                record.get_lower_offset_position(),
+                                get_record_offset( record.child_record() ) );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = patch_offset( stream,
+                            syntax,
+                            dicomdir,
+                            MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY,
+                            positions.first_root,
+                            get_record_offset( dicomdir.child_record() ) );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = patch_offset( stream,
+                            syntax,
+                            dicomdir,
+                            MC_ATT_OFFSET_OF_THE_LAST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY,
+                            positions.last_root,
+                            get_record_offset( dicomdir.last_child_record() ) );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+// Passes the contents of stream to the file
+static MC_STATUS copy_to_file( const buffer_tx_stream& source,
+                               const string&           filename )
+{
+    // Passed to the callback in pieces so the size fits in its int
+    static const size_t CHUNK_SIZE = 1024u * 1024u;
+
+    FILE* f = nullptr;
+    file_tx_stream dest( filename, write_using_stdio, static_cast<void*>( &f ) );
+
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    for( size_t offset = 0;
+         ret == MC_NORMAL_COMPLETION && offset < source.size();
+         offset += CHUNK_SIZE )
+    {
+        const size_t chunk_size = min( CHUNK_SIZE, source.size() - offset );
+        ret = dest.write( source.data() + offset,
+                          static_cast<uint32_t>( chunk_size ) );
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = dest.finalize();
+    }
+    else
+    {
+        // Call finalize so the file is closed
+        (void)dest.finalize();
+    }
+
+    return ret;
+}
+
+// A change made to a DICOMDIR file when records are appended to it
+struct file_change
+{
+    uint64_t       position;
+    const uint8_t* data;
+    size_t         size;
+};
+
+// Sorts the records of the sequence into those read from source, which
+// must come first and all still be there, and those added since
+static MC_STATUS get_appended_records( dicomdir_object&        dicomdir,
+                                       const record_source&    source,
+                                       size_t                  source_record_count,
+                                       vector<record_object*>& source_records,
+                                       vector<record_object*>& new_records,
+                                       bool&                   appendable )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    vector<item_object*> items;
+    get_record_items( dicomdir, items );
+
+    source_records.reserve( min( items.size(), source_record_count ) );
+    for( vector<item_object*>::const_iterator itr = items.cbegin();
+         ret == MC_NORMAL_COMPLETION && appendable == true && itr != items.cend();
+         ++itr )
+    {
+        record_object* const record = dynamic_cast<record_object*>( *itr );
+        if( record == nullptr )
+        {
+            ret = MC_INVALID_RECORD_ID;
+        }
+        else if( record->is_from( source ) == true )
+        {
+            // A record read from the file after a new one means the
+            // records were rearranged
+            appendable = new_records.empty();
+            source_records.push_back( record );
+        }
+        else
+        {
+            new_records.push_back( record );
+        }
+    }
+
+    if( source_records.size() != source_record_count )
+    {
+        // Records were deleted
+        appendable = false;
+    }
+    else
+    {
+        // Do nothing. All the records of the file are still there
+    }
+
+    return ret;
+}
+
+// Checks that the part of the DICOMDIR in front of the records would be
+// written the same as it is in source, and that nothing follows the
+// records
+static MC_STATUS header_matches_source( TRANSFER_SYNTAX      syntax,
+                                        dicomdir_object&     dicomdir,
+                                        const record_source& source,
+                                        uint64_t             sequence_offset,
+                                        dicomdir_positions&  positions,
+                                        bool&                matches )
+{
+    buffer_tx_stream header;
+    MC_STATUS ret = write_dicomdir_header( header, syntax, dicomdir, positions );
+
+    buffer_tx_stream trailing;
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_values( trailing,
+                            syntax,
+                            dicomdir,
+                            dicomdir.application_id(),
+                            MC_ATT_DIRECTORY_RECORD_SEQUENCE + 1u,
+                            0xFFFFFFFFu );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    // A file left inconsistent by an earlier update is written again
+    // rather than added to. Zero is encoded the same in any byte order
+    const uint8_t* const flag = header.data() + positions.consistency_flag;
+    matches = ret == MC_NORMAL_COMPLETION &&
+              trailing.size() == 0u &&
+              header.size() == sequence_offset &&
+              sequence_offset <= source.size() &&
+              memcmp( header.data(), source.data(), header.size() ) == 0 &&
+              flag[0] == 0u &&
+              flag[1] == 0u;
+
+    return ret;
+}
+
+// Writes the records added to the DICOMDIR, filling in the offsets
+// between them. The records written are kept in written
+static MC_STATUS write_new_records( buffer_tx_stream&             stream,
+                                    TRANSFER_SYNTAX               syntax,
+                                    const vector<record_object*>& new_records,
+                                    record_set_t&                 written,
+                                    bool&                         appendable )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    written.reserve( new_records.size() );
+    for( vector<record_object*>::const_iterator itr = new_records.cbegin();
+         ret == MC_NORMAL_COMPLETION && itr != new_records.cend();
+         ++itr )
+    {
+        ret = (*itr)->to_stream( stream, syntax );
+        written.insert( *itr );
+    }
+
+    // New records are added to the end of chains, so they only refer to
+    // other new records
+    for( vector<record_object*>::const_iterator itr = new_records.cbegin();
+         ret == MC_NORMAL_COMPLETION && appendable == true && itr != new_records.cend();
+         ++itr )
+    {
+        record_object& record = **itr;
+        const record_object* const next = record.next_record();
+        const record_object* const child = record.child_record();
+        appendable = (next == nullptr || written.count( next ) != 0u) &&
+                     (child == nullptr || written.count( child ) != 0u);
+        if( appendable == true )
+        {
+            ret = patch_offset( stream,
+                                syntax,
+                                record,
+                                MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD,
+                                record.get_next_offset_position(),
+                                get_record_offset( next ) );
+        }
+        else
+        {
+            // Do nothing. The file has to be written again
+        }
+
+        if( ret == MC_NORMAL_COMPLETION && appendable == true )
+        {
+            ret = patch_offset( stream,
+                                syntax,
+                                record,
+                                MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY,
+                                record.get_lower_offset_position(),
+                                get_record_offset( child ) );
+        }
+        else
+        {
+            // Do nothing. Will return error or write the file again
+        }
+    }
+
+    return ret;
+}
+
+// Sets an offset of an existing record that now refers to a new record,
+// adding the position of the value in the file to patches
+static MC_STATUS patch_source_offset( record_object&                    record,
+                                      uint32_t                          tag,
+                                      uint64_t                          position,
+                                      uint32_t                          offset,
+                                      vector<pair<uint64_t, uint32_t>>& patches,
+                                      bool&                             appendable )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    if( position != 0u )
+    {
+        // The record is read so its values stay the same as the file
+        ret = record.load_values();
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = record[tag].set( static_cast<unsigned long>( offset ) );
+            patches.emplace_back( position, offset );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // The record doesn't have the offset in the file
+        appendable = false;
+    }
+
+    return ret;
+}
+
+// Finds the existing records whose offsets refer to new records
+static MC_STATUS patch_source_records( const vector<record_object*>&     source_records,
+                                       const record_set_t&               new_records,
+                                       vector<pair<uint64_t, uint32_t>>& patches,
+                                       bool&                             appendable )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    for( vector<record_object*>::const_iterator itr = source_records.cbegin();
+         ret == MC_NORMAL_COMPLETION && appendable == true && itr != source_records.cend();
+         ++itr )
+    {
+        record_object& record = **itr;
+        const record_object* const next = record.next_record();
+        if( next != nullptr && new_records.count( next ) != 0u )
+        {
+            ret = patch_source_offset( record,
+                                       MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD,
+                                       record.get_next_offset_position(),
+                                       next->get_offset(),
+                                       patches,
+                                       appendable );
+        }
+        else
+        {
+            // Do nothing. Next record is unchanged
+        }
+
+        const record_object* const child = record.child_record();
+        if( ret == MC_NORMAL_COMPLETION &&
+            child != nullptr &&
+            new_records.count( child ) != 0u )
+        {
+            ret = patch_source_offset( record,
+                                       MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY,
+                                       record.get_lower_offset_position(),
+                                       child->get_offset(),
+                                       patches,
+                                       appendable );
+        }
+        else
+        {
+            // Do nothing. Lower level records are unchanged or an error
+            // will be returned
+        }
+    }
+
+    return ret;
+}
+
+static MC_STATUS write_to_file( FILE*          f,
+                                uint64_t       position,
+                                const uint8_t* data,
+                                size_t         size )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( position <= static_cast<uint64_t>( numeric_limits<long>::max() ) &&
+        fseek( f, static_cast<long>( position ), SEEK_SET ) == 0 &&
+        fwrite( data, size, 1, f ) == 1u )
+    {
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = MC_CANNOT_COMPLY;
+    }
+
+    return ret;
+}
+
+// Flushes the changes written to f to the storage device, so that they
+// can't be reordered with later writes if the system fails
+static MC_STATUS sync_file( FILE* f )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+#ifdef _WIN32
+    const bool synced = fflush( f ) == 0 && _commit( _fileno( f ) ) == 0;
+#else
+    const bool synced = fflush( f ) == 0 && fsync( fileno( f ) ) == 0;
+#endif
+    if( synced == true )
+    {
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = MC_CANNOT_COMPLY;
+    }
+
+    return ret;
+}
+
+// Makes changes to the file in place. The File-set Consistency Flag is
+// set while the file is changed so an interrupted update can be detected.
+// The file is synced after the flag is set and before it is cleared, so
+// the flag is still set on disk if the system fails part way through
+static MC_STATUS change_file( const string&              filename,
+                              TRANSFER_SYNTAX            syntax,
+                              uint64_t                   flag_position,
+                              const vector<file_change>& changes )
+{
+    buffer_tx_stream flags;
+    MC_STATUS ret = flags.write_val( static_cast<uint16_t>( 0xFFFFu ), syntax );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = flags.write_val( static_cast<uint16_t>( 0x0000u ), syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    FILE* f = ret == MC_NORMAL_COMPLETION ? fopen( filename.c_str(), "r+b" ) :
+                                            nullptr;
+    if( f != nullptr )
+    {
+        ret = write_to_file( f, flag_position, flags.data(), sizeof(uint16_t) );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = sync_file( f );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        for( vector<file_change>::const_iterator itr = changes.cbegin();
+             ret == MC_NORMAL_COMPLETION && itr != changes.cend();
+             ++itr )
+        {
+            ret = write_to_file( f, itr->position, itr->data, itr->size );
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = sync_file( f );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            // Only cleared once everything else is written
+            ret = write_to_file( f,
+                                 flag_position,
+                                 flags.data() + sizeof(uint16_t),
+                                 sizeof(uint16_t) );
+        }
+        else
+        {
+            // Do nothing. Flag is left set
+        }
+
+        if( fclose( f ) != 0 && ret == MC_NORMAL_COMPLETION )
+        {
+            ret = MC_CANNOT_COMPLY;
+        }
+        else
+        {
+            // Do nothing. Closed or an error will be returned
+        }
+    }
+    else if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = MC_CANNOT_COMPLY;
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+template<class RecordType>
+static void append_record( RecordType& parent, record_object& child )
+{
+    // The parent keeps the tail of its child chain so the chain doesn't
+    // need to be walked
+    record_object* const last = parent.last_child_record();
+    if( last != nullptr )
+    {
+        last->set_next_record( &child );
+        child.set_prev_record( last );
+    }
+    else
+    {
+        // No child elements in chain
+        parent.set_child_record( &child );
+    }
+
+    parent.set_last_child_record( &child );
+}
+
+template<class RecordType>
+static MC_STATUS unlink_record( RecordType& parent, record_object& child )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    record_object* const prev = child.prev_record();
+    record_object* const next = child.next_record();
+    // The ends of the chain are checked against the parent, which is
+    // all that can be checked without walking it
+    if( ( prev != nullptr ? prev->next_record() == &child :
+                            parent.child_record() == &child ) &&
+        ( next != nullptr ? next->prev_record() == &child :
+                            parent.last_child_record() == &child ) )
+    {
+        if( prev != nullptr )
+        {
+            prev->set_next_record( next );
+        }
+        else
+        {
+            parent.set_child_record( next );
+        }
+
+        if( next != nullptr )
+        {
+            next->set_prev_record( prev );
+        }
+        else
+        {
+            parent.set_last_child_record( prev );
+        }
+
+        child.set_prev_record( nullptr );
+        child.set_next_record( nullptr );
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        // Child isn't in the chain of its supposed parent. Indicate
+        // serious error
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
+
+// Appends the records of the chain starting at first and every record
+// below them to records
+static void get_records_below( record_object*          first,
+                               vector<record_object*>& records )
+{
+    vector<record_object*> pending;
+    if( first != nullptr )
+    {
+        pending.push_back( first );
+    }
+    else
+    {
+        // Do nothing. No records
+    }
+
+    while( pending.empty() == false )
+    {
+        record_object* const record = pending.back();
+        pending.pop_back();
+        records.push_back( record );
+
+        if( record->next_record() != nullptr )
+        {
+            pending.push_back( record->next_record() );
+        }
+        else
+        {
+            // Do nothing. End of chain
+        }
+
+        if( record->child_record() != nullptr )
+        {
+            pending.push_back( record->child_record() );
+        }
+        else
+        {
+            // Do nothing. No lower level records
+        }
+    }
+}
+
+dicomdir_object::dicomdir_object( int                    id,
+                                  const char*            filename,
+                                  data_dictionary* source,
+                                  bool                   created_empty )
+    : file_object( id, filename, created_empty ),
+      m_child_record( nullptr ),
+      m_last_child_record( nullptr ),
+      m_sequence_offset( 0u ),
+      m_sequence_length_position( 0u ),
+      m_sequence_length( 0u ),
+      m_records_end( 0u ),
+      m_source_record_count( 0u ),
+      m_deletion_count( make_shared<uint64_t>( 0u ) )
+{
+    if( source != nullptr )
+    {
+        // Just copy tags from groups 2 through 4
+        // TODO: remove when we have message templates based on IOD type
+        // Do before we assign DICOMDIR values to prevent these values from
+        // overwriting ours
+        copy_values( *this, *source, 0x00020000u, 0x0004FFFFu );
+    }
+
     (*this)[MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY].set( 0u );
     (*this)[MC_ATT_OFFSET_OF_THE_LAST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY].set( 0u );
     (*this)[MC_ATT_FILE_SET_CONSISTENCY_FLAG].set( 0u );
     (*this)[MC_ATT_MEDIA_STORAGE_SOP_CLASS_UID].set( "1.2.840.10008.1.3.10" );
 
-    set_transfer_syntax( EXPLICIT_LITTLE_ENDIAN );
+    set_transfer_syntax( EXPLICIT_LITTLE_ENDIAN );
+}
+
+int dicomdir_object::get_child_record() const
+{
+    return m_child_record != nullptr ? m_child_record->id() : -1;
+}
+
+int dicomdir_object::get_last_child_record() const
+{
+    return m_last_child_record != nullptr ? m_last_child_record->id() : -1;
+}
+
+void dicomdir_object::empty_file()
+{
+    m_child_record = nullptr;
+    m_last_child_record = nullptr;
+    m_unreferenced_records.clear();
+    m_source.reset();
+    m_source_record_count = 0u;
+    m_index.reset();
+    ++(*m_deletion_count);
+
+    file_object::empty_file();
+}
+
+bool dicomdir_object::is_managed_range( uint32_t first_tag,
+                                        uint32_t last_tag ) const
+{
+    return first_tag <= MC_ATT_DIRECTORY_RECORD_SEQUENCE &&
+           last_tag >= MC_ATT_DIRECTORY_RECORD_SEQUENCE;
+}
+
+MC_STATUS dicomdir_object::open()
+{
+    vector<uint8_t> data;
+    MC_STATUS ret = read_whole_file( get_filename(), data );
+
+    // The stream remains valid once the data is given to the record
+    // source, since the buffer itself doesn't move
+    buffer_rx_stream stream( data.data(), data.size() );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = read_file_header( stream, *this, 0 );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = get_transfer_syntax( syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && syntax == DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+    {
+        // Records are read from the file as they are used, which isn't
+        // possible for a deflated data set
+        ret = MC_INVALID_TRANSFER_SYNTAX;
+    }
+    else if( ret == MC_NORMAL_COMPLETION )
+    {
+        const arena_scope scope( get_arena() );
+        ret = read_values_upto( stream,
+                                syntax,
+                                *this,
+                                0,
+                                MC_ATT_DIRECTORY_RECORD_SEQUENCE - 1u );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    // Resolves the VRs of the record headers if the file is implicit VR
+    const implicit_vr_scope vr_scope( syntax );
+
+    vector<scanned_record> records;
+    // Where the sequence is, for appending records to it later
+    bool sequence_read = false;
+    uint64_t sequence_offset = 0;
+    uint64_t sequence_length_position = 0;
+    uint32_t sequence_length = 0;
+    uint64_t records_end = 0;
+    uint64_t sequence_end = 0;
+    uint32_t tag = 0;
+    if( ret == MC_NORMAL_COMPLETION &&
+        stream.peek_tag( tag, syntax ) == MC_NORMAL_COMPLETION &&
+        tag == MC_ATT_DIRECTORY_RECORD_SEQUENCE )
+    {
+        MC_VR vr = UNKNOWN_VR;
+        sequence_offset = stream.tell_read();
+        ret = stream.read_tag( tag, syntax );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = read_element_header( stream,
+                                       syntax,
+                                       tag,
+                                       vr,
+                                       sequence_length );
+            // The length is the last part of the header
+            sequence_length_position = stream.tell_read() - sizeof(uint32_t);
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION && vr == SQ )
+        {
+            ret = scan_records( stream, syntax, sequence_length, records );
+            sequence_end = stream.tell_read();
+            // An undefined length sequence ends with a delimiter, which
+            // new records go in front of
+            records_end = sequence_length == UNDEFINED_LENGTH ?
+                          sequence_end - 2u * sizeof(uint32_t) :
+                          sequence_end;
+            sequence_read = true;
+        }
+        else if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = MC_INVALID_DICOMDIR_FILE;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. There are no records or an error will be returned
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        // Any elements following the records
+        const arena_scope scope( get_arena() );
+        ret = read_values( stream, syntax, *this, 0 );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    unsigned long root_offset = 0;
+    if( ret == MC_NORMAL_COMPLETION && records.empty() == false )
+    {
+        value_representation* root =
+            at( MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY );
+        if( root == nullptr ||
+            root->get( root_offset ) != MC_NORMAL_COMPLETION ||
+            root_offset == 0u )
+        {
+            // Treat the first record as the start of the root chain
+            root_offset = records.front().offset;
+        }
+        else
+        {
+            // Do nothing. Root offset was read
+        }
+    }
+    else
+    {
+        // Do nothing. No records or an error will be returned
+    }
+
+    // Whether records can be appended by writing after the sequence
+    const bool sequence_at_end = sequence_read == true &&
+                                 sequence_end == data.size();
+
+    shared_ptr<record_source> source;
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        size_t root_first = NO_RECORD;
+        size_t root_last = NO_RECORD;
+        vector<size_t> order;
+        vector<size_t> unreferenced;
+        vector<record_object*> objects;
+        ret = link_records( static_cast<uint32_t>( root_offset ),
+                            records,
+                            order,
+                            unreferenced,
+                            root_first,
+                            root_last );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            source = make_shared<record_source>( data, syntax );
+            ret = create_records( *this, source, records, order, objects );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            m_child_record = get_record( objects, root_first );
+            m_last_child_record = get_record( objects, root_last );
+            m_unreferenced_records.clear();
+            for( const size_t index : unreferenced )
+            {
+                m_unreferenced_records.push_back( objects[index] );
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && sequence_at_end == true )
+    {
+        m_source = source;
+        m_source_filename = get_filename();
+        m_sequence_offset = sequence_offset;
+        m_sequence_length_position = sequence_length_position;
+        m_sequence_length = sequence_length;
+        m_records_end = records_end;
+        m_source_record_count = records.size();
+    }
+    else
+    {
+        // Do nothing. Records can't be appended to the file
+    }
+
+    return ret;
+}
+
+MC_STATUS dicomdir_object::append_records( TRANSFER_SYNTAX syntax,
+                                           bool&           appended )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    // The file must still be the one read, or last written, by this
+    // object and only have had records added
+    bool appendable = m_source != nullptr &&
+                      m_source->syntax() == syntax &&
+                      m_source_filename == get_filename();
+
+    vector<record_object*> source_records;
+    vector<record_object*> new_records;
+    if( appendable == true )
+    {
+        ret = get_appended_records( *this,
+                                    *m_source,
+                                    m_source_record_count,
+                                    source_records,
+                                    new_records,
+                                    appendable );
+    }
+    else
+    {
+        // Do nothing. The file has to be written again
+    }
+
+    dicomdir_positions positions = { 0u, 0u, 0u };
+    if( ret == MC_NORMAL_COMPLETION && appendable == true )
+    {
+        ret = header_matches_source( syntax,
+                                     *this,
+                                     *m_source,
+                                     m_sequence_offset,
+                                     positions,
+                                     appendable );
+    }
+    else
+    {
+        // Do nothing. The file has to be written again or an error will
+        // be returned
+    }
+
+    // Only records which have been read can have been changed
+    for( vector<record_object*>::const_iterator itr = source_records.cbegin();
+         ret == MC_NORMAL_COMPLETION && appendable == true && itr != source_records.cend();
+         ++itr )
+    {
+        ret = (*itr)->matches_source( appendable );
+    }
+
+    // The new records go where the records of the file end. The
+    // delimiter of an undefined length sequence is written after them
+    buffer_tx_stream records( m_records_end );
+    record_set_t written;
+    if( ret == MC_NORMAL_COMPLETION && appendable == true )
+    {
+        ret = write_new_records( records,
+                                 syntax,
+                                 new_records,
+                                 written,
+                                 appendable );
+    }
+    else
+    {
+        // Do nothing. The file has to be written again or an error will
+        // be returned
+    }
+
+    const uint64_t records_size = records.size();
+    if( ret == MC_NORMAL_COMPLETION &&
+        appendable == true &&
+        m_sequence_length == UNDEFINED_LENGTH )
+    {
+        // Filling in the offsets left the stream inside the records
+        ret = records.seek( m_records_end + records_size );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = records.write_tag( MC_ATT_SEQUENCE_DELIMITATION_ITEM, syntax );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = records.write_val( static_cast<uint32_t>( 0x00000000u ), syntax );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else if( ret == MC_NORMAL_COMPLETION && appendable == true )
+    {
+        // The records must fit in the length of the sequence
+        appendable = records_size < UNDEFINED_LENGTH - m_sequence_length;
+    }
+    else
+    {
+        // Do nothing. The file has to be written again or an error will
+        // be returned
+    }
+
+    // Offsets are 32-bit
+    appendable = appendable == true &&
+                 m_records_end + records_size <= numeric_limits<uint32_t>::max();
+
+    vector<pair<uint64_t, uint32_t>> patches;
+    if( ret == MC_NORMAL_COMPLETION && appendable == true )
+    {
+        ret = patch_source_records( source_records,
+                                    written,
+                                    patches,
+                                    appendable );
+    }
+    else
+    {
+        // Do nothing. The file has to be written again or an error will
+        // be returned
+    }
+
+    if( ret == MC_NORMAL_COMPLETION &&
+        appendable == true &&
+        m_child_record != nullptr &&
+        written.count( m_child_record ) != 0u )
+    {
+        // Root chain was empty
+        const uint32_t first_root = m_child_record->get_offset();
+        ret = (*this)[MC_ATT_OFFSET_OF_THE_FIRST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY].set
+        (
+            static_cast<unsigned long>( first_root )
+        );
+        patches.emplace_back( positions.first_root, first_root );
+    }
+    else
+    {
+        // Do nothing. First root record is unchanged
+    }
+
+    if( ret == MC_NORMAL_COMPLETION &&
+        appendable == true &&
+        m_last_child_record != nullptr &&
+        written.count( m_last_child_record ) != 0u )
+    {
+        const uint32_t last_root = m_last_child_record->get_offset();
+        ret = (*this)[MC_ATT_OFFSET_OF_THE_LAST_DIRECTORY_RECORD_OF_THE_ROOT_DIRECTORY_ENTITY].set
+        (
+            static_cast<unsigned long>( last_root )
+        );
+        patches.emplace_back( positions.last_root, last_root );
+    }
+    else
+    {
+        // Do nothing. Last root record is unchanged
+    }
+
+    const uint32_t sequence_length =
+        m_sequence_length == UNDEFINED_LENGTH ?
+        UNDEFINED_LENGTH :
+        m_sequence_length + static_cast<uint32_t>( records_size );
+    if( sequence_length != m_sequence_length )
+    {
+        patches.emplace_back( m_sequence_length_position, sequence_length );
+    }
+    else
+    {
+        // Do nothing. Length is undefined or no records were added
+    }
+
+    // Everything written to the file is also made to the source so the
+    // values of the records can still be read from it
+    buffer_tx_stream patch_data;
+    vector<file_change> changes;
+    if( ret == MC_NORMAL_COMPLETION &&
+        appendable == true &&
+        new_records.empty() == false )
+    {
+        changes.reserve( patches.size() + 1u );
+        changes.push_back( file_change{ m_records_end,
+                                        records.data(),
+                                        records.size() } );
+        for( vector<pair<uint64_t, uint32_t>>::const_iterator itr = patches.cbegin();
+             ret == MC_NORMAL_COMPLETION && itr != patches.cend();
+             ++itr )
+        {
+            ret = patch_data.write_val( itr->second, syntax );
+        }
+
+        for( size_t i = 0; i < patches.size(); ++i )
+        {
+            changes.push_back( file_change{ patches[i].first,
+                                            patch_data.data() + i * sizeof(uint32_t),
+                                            sizeof(uint32_t) } );
+        }
+    }
+    else
+    {
+        // Do nothing. Nothing to write, the file has to be written again
+        // or an error will be returned
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && changes.empty() == false )
+    {
+        ret = change_file( get_filename(),
+                           syntax,
+                           positions.consistency_flag,
+                           changes );
+    }
+    else
+    {
+        // Do nothing. Nothing to write or an error will be returned
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && appendable == true )
+    {
+        for( const file_change& change : changes )
+        {
+            m_source->write( change.position, change.data, change.size );
+        }
+
+        // The new records are now part of the file. Each is an item
+        // header, the values and an item delimiter
+        const uint64_t records_end = m_records_end + records_size;
+        for( size_t i = 0; i < new_records.size(); ++i )
+        {
+            const uint64_t item_offset = new_records[i]->get_offset();
+            const uint64_t item_end = i + 1u < new_records.size() ?
+                                      new_records[i + 1u]->get_offset() :
+                                      records_end;
+            new_records[i]->set_written_source
+            (
+                m_source,
+                item_offset + 2u * sizeof(uint32_t),
+                static_cast<uint32_t>( item_end - item_offset - 4u * sizeof(uint32_t) )
+            );
+        }
+
+        m_records_end = records_end;
+        m_sequence_length = sequence_length;
+        m_source_record_count += new_records.size();
+        appended = true;
+    }
+    else if( ret != MC_NORMAL_COMPLETION )
+    {
+        // The file may have been partly changed
+        m_source.reset();
+        appended = false;
+    }
+    else
+    {
+        appended = false;
+    }
+
+    return ret;
 }
 
 MC_STATUS dicomdir_object::update()
 {
-    null_tx_stream null_stream;
+    TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
+    MC_STATUS ret = get_transfer_syntax( syntax );
+    if( ret == MC_NORMAL_COMPLETION && syntax == DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+    {
+        // Offsets are patched into the written data, which can't be done
+        // once it is compressed
+        ret = MC_INVALID_TRANSFER_SYNTAX;
+    }
+    else
+    {
+        // Do nothing. Either the syntax is supported or an error will be
+        // returned
+    }
 
-    // Update all offset values using the NULL stream.
-    // Note we don't use the callback function. There shouldn't
-    // be anything in a DICOMDIR which would use a callback
-    MC_STATUS ret = write_file( null_stream, *this, -1 );
+    bool appended = false;
     if( ret == MC_NORMAL_COMPLETION )
     {
-        offset_map_t record_offsets;
-        ret = get_record_offsets( (*this)[MC_ATT_DIRECTORY_RECORD_SEQUENCE],
-                                  record_offsets );
+        ret = append_records( syntax, appended );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && appended == false )
+    {
+        // The records are about to move, so they can't be appended to
+        // again until the DICOMDIR is opened again
+        m_source.reset();
+
+        // The DICOMDIR is only serialized once. Offsets are always
+        // written as a single UL, so the size of the records doesn't
+        // depend on them and they can be filled in once the offsets of
+        // all records are known
+        buffer_tx_stream stream;
+        dicomdir_positions positions = { 0u, 0u, 0u };
+        ret = write_dicomdir( stream, syntax, *this, positions );
         if( ret == MC_NORMAL_COMPLETION )
         {
-            ret = update_offset_values( *this, record_offsets );
-            if( ret == MC_NORMAL_COMPLETION )
+            ret = patch_record_offsets( stream, syntax, *this, positions );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = copy_to_file( stream, get_filename() );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Records were appended or an error will be returned
+    }
+
+    return ret;
+}
+
+MC_STATUS dicomdir_object::add_record( record_object* parent,
+                                       const char*    record_type,
+                                       int&           record_id )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    const int parent_id = parent != nullptr ? parent->id() : id();
+    const int new_id = g_context->create_record_object( id(),
+                                                        parent_id,
+                                                        record_type );
+    if( new_id > 0 )
+    {
+        record_object* const record =
+            dynamic_cast<record_object*>( g_context->find_object( new_id ) );
+        value_representation* const sequence =
+            at( MC_ATT_DIRECTORY_RECORD_SEQUENCE );
+        if( record != nullptr && sequence != nullptr )
+        {
+            if( parent != nullptr )
             {
-                FILE* f = nullptr;
-                ret = write_file( *this,
-                                  0,
-                                  static_cast<void*>( &f ),
-                                  write_using_stdio );
+                append_record( *parent, *record );
             }
             else
             {
-                // Do nothing. Will return error
+                append_record( *this, *record );
+            }
+
+            ret = sequence->is_null() == false ? sequence->set_next( new_id ) :
+                                                 sequence->set( new_id );
+        }
+        else if( record != nullptr )
+        {
+            ret = MC_INVALID_TAG;
+        }
+        else
+        {
+            ret = MC_INVALID_RECORD_ID;
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            // Indexed once its values have been set
+            record_changed( new_id );
+            record_id = new_id;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = static_cast<MC_STATUS>( -new_id );
+    }
+
+    return ret;
+}
+
+MC_STATUS dicomdir_object::delete_record( record_object& record )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    const int parent_id = record.get_parent_record();
+    const vector<record_object*>::iterator unreferenced =
+        std::find( m_unreferenced_records.begin(),
+                   m_unreferenced_records.end(),
+                   &record );
+    if( unreferenced != m_unreferenced_records.end() )
+    {
+        // Not in any chain, so there is nothing to unlink it from
+        m_unreferenced_records.erase( unreferenced );
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else if( parent_id == id() )
+    {
+        ret = unlink_record( *this, record );
+    }
+    else
+    {
+        record_object* const parent =
+            dynamic_cast<record_object*>( g_context->find_object( parent_id ) );
+        ret = parent != nullptr ? unlink_record( *parent, record ) :
+                                  MC_SYSTEM_ERROR;
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        // The record is unlinked, so its next record is no longer part of
+        // the chain walked here
+        vector<record_object*> records( 1u, &record );
+        get_records_below( record.child_record(), records );
+        ret = remove_records( records );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+MC_STATUS dicomdir_object::delete_all_records()
+{
+    vector<record_object*> records( m_unreferenced_records );
+    get_records_below( m_child_record, records );
+
+    m_child_record = nullptr;
+    m_last_child_record = nullptr;
+    m_unreferenced_records.clear();
+
+    return remove_records( records );
+}
+
+MC_STATUS dicomdir_object::remove_records( const vector<record_object*>& records )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    unordered_set<const item_object*> items( records.size() );
+    for( record_object* const record : records )
+    {
+        record_removed( *record );
+        items.insert( record );
+    }
+
+    value_representation* const sequence = at( MC_ATT_DIRECTORY_RECORD_SEQUENCE );
+    if( sequence != nullptr && sequence->vr() == SQ )
+    {
+        vector<item_object_ptr> removed;
+        static_cast<sq*>( sequence )->remove_items( items, removed );
+        // Every record belongs to the sequence, so anything missing from
+        // it means the tree and the sequence disagree
+        ret = removed.size() == records.size() ? MC_NORMAL_COMPLETION :
+                                                 MC_SYSTEM_ERROR;
+        ++(*m_deletion_count);
+        g_context->free_items( removed );
+    }
+    else if( records.empty() == true )
+    {
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
+
+MC_STATUS dicomdir_object::build_index()
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    if( m_index == nullptr )
+    {
+        unique_ptr<record_index> index( new record_index( id() ) );
+
+        vector<item_object*> items;
+        get_record_items( *this, items );
+        for( vector<item_object*>::const_iterator itr = items.cbegin();
+             ret == MC_NORMAL_COMPLETION && itr != items.cend();
+             ++itr )
+        {
+            record_object* const record = dynamic_cast<record_object*>( *itr );
+            if( record != nullptr )
+            {
+                ret = index->add( *record );
+            }
+            else
+            {
+                ret = MC_INVALID_RECORD_ID;
             }
         }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            m_index.swap( index );
+        }
         else
         {
             // Do nothing. Will return error
         }
     }
     else
+    {
+        // Do nothing. Index already built
+    }
+
+    return ret;
+}
+
+MC_STATUS dicomdir_object::find_record( uint32_t      tag,
+                                        const string& value,
+                                        int&          record_id )
+{
+    MC_STATUS ret = build_index();
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = m_index->find( tag, value, record_id );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+MC_STATUS dicomdir_object::find_records( uint32_t      tag,
+                                         const string& value,
+                                         vector<int>&  record_ids )
+{
+    MC_STATUS ret = build_index();
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = m_index->find_all( tag, value, record_ids );
+    }
+    else
     {
         // Do nothing. Will return error
     }
@@ -341,4 +2245,28 @@ MC_STATUS dicomdir_object::update()
     return ret;
 }
 
+void dicomdir_object::record_changed( int record_id )
+{
+    if( m_index != nullptr )
+    {
+        m_index->mark_changed( record_id );
+    }
+    else
+    {
+        // Do nothing. Index isn't used
+    }
+}
+
+void dicomdir_object::record_removed( record_object& record )
+{
+    if( m_index != nullptr )
+    {
+        m_index->remove( record );
+    }
+    else
+    {
+        // Do nothing. Index isn't used
+    }
+}
+
 }
@@ -12,7 +12,12 @@
  */
 
 // std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 // local public
 #include "mcstatus.h"
@@ -20,10 +25,14 @@
 
 // local private
 #include "fume/file_object.h"
+#include "fume/record_index.h"
 
 namespace fume
 {
 
+class record_source;
+class record_object;
+
 class dicomdir_object : public file_object
 {
 public:
@@ -33,23 +42,125 @@ public:
                      bool                   created_empty );
     virtual ~dicomdir_object()
     {
+        // Freeing the DICOMDIR frees its records
+        ++(*m_deletion_count);
     }
 
-    MC_STATUS set_child_record( int child_record )
+    // The root records, linked as the records link their children
+    void set_child_record( record_object* record )
     {
-        // Caller performs validation
-        m_child_record = child_record;
-        return MC_NORMAL_COMPLETION;
+        m_child_record = record;
     }
-    int get_child_record() const
+    record_object* child_record() const
     {
         return m_child_record;
     }
 
+    void set_last_child_record( record_object* record )
+    {
+        m_last_child_record = record;
+    }
+    record_object* last_child_record() const
+    {
+        return m_last_child_record;
+    }
+
+    // IDs of the root records, or -1 if there are none
+    int get_child_record() const;
+    int get_last_child_record() const;
+
+    // Counts the times records of the DICOMDIR were freed, so a caller
+    // holding record pointers across a callback can tell whether they may
+    // have been freed. The count outlives the DICOMDIR, whose own freeing
+    // is counted too
+    std::shared_ptr<const uint64_t> get_deletion_count() const
+    {
+        return m_deletion_count;
+    }
+
+    // The records are freed along with the Directory Record Sequence
+    virtual void empty_file() override;
+
+    // The Directory Record Sequence is only changed by the MC_DDH
+    // functions, since the records link directly to each other
+    virtual bool is_managed_range( uint32_t first_tag,
+                                   uint32_t last_tag ) const override;
+
+    // Reads the DICOMDIR named by the object, replacing its values.
+    // Only the links between records are read. The values of each
+    // record are read when the record is first used
+    MC_STATUS open();
+
+    // Writes the DICOMDIR to its file. If the DICOMDIR was opened from
+    // the file and records have only been added since, the new records
+    // are appended to the file rather than writing it again
     MC_STATUS update();
 
+    // Creates a record of record_type at the end of the child records of
+    // parent, or at the end of the root records if parent is NULL
+    MC_STATUS add_record( record_object* parent,
+                          const char*    record_type,
+                          int&           record_id );
+
+    // Deletes record and every record below it. The record is unlinked
+    // from its parent, and the deleted records are removed from the
+    // Directory Record Sequence in a single pass and freed together
+    MC_STATUS delete_record( record_object& record );
+
+    // Deletes all of the records
+    MC_STATUS delete_all_records();
+
+    // Finds a record by one of the attributes indexed by record_index.
+    // The index is built the first time a record is looked up, and from
+    // then on is kept up to date through record_changed and
+    // record_removed. record_id is zero if there is no such record
+    MC_STATUS find_record( uint32_t           tag,
+                           const std::string& value,
+                           int&               record_id );
+
+    // Appends the IDs of all of the records whose value of tag, which
+    // must be indexed by record_index, is value to record_ids
+    MC_STATUS find_records( uint32_t           tag,
+                            const std::string& value,
+                            std::vector<int>&  record_ids );
+
+    // Called when the values of a record may have changed, or it has
+    // been added
+    void record_changed( int record_id );
+
+    // Called before a record is deleted
+    void record_removed( record_object& record );
+
+private:
+    MC_STATUS append_records( TRANSFER_SYNTAX syntax, bool& appended );
+
+    // Removes records, which must already be unlinked from the rest of
+    // the tree, from the index and the sequence and frees them
+    MC_STATUS remove_records( const std::vector<record_object*>& records );
+
+    // Builds m_index if it hasn't been built yet
+    MC_STATUS build_index();
+
 private:
-    int m_child_record;
+    record_object* m_child_record;
+    // Tail of the root record chain
+    record_object* m_last_child_record;
+    // Records read from the file which no other record refers to. They
+    // are written back out but aren't part of any chain
+    std::vector<record_object*> m_unreferenced_records;
+    // The contents of the file the DICOMDIR was opened from, as last
+    // written, and where its Directory Record Sequence is. Records are
+    // appended at m_records_end
+    std::shared_ptr<record_source> m_source;
+    std::string                    m_source_filename;
+    uint64_t                       m_sequence_offset;
+    uint64_t                       m_sequence_length_position;
+    uint32_t                       m_sequence_length;
+    uint64_t                       m_records_end;
+    size_t                         m_source_record_count;
+    // Built by the first call to find_record
+    std::unique_ptr<record_index>  m_index;
+    std::shared_ptr<uint64_t>      m_deletion_count;
 };
 
 }
@@ -0,0 +1,107 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <utility>
+
+// local public
+#include "mc3msg.h"
+
+// local private
+#include "fume/dictionary_pool.h"
+
+using std::vector;
+using std::move;
+
+namespace fume
+{
+
+dictionary_pool::dictionary_pool()
+    : m_capacity( 0 ),
+      m_stats()
+{
+}
+
+dictionary_pool::~dictionary_pool()
+{
+}
+
+void dictionary_pool::set_capacity( size_t capacity )
+{
+    m_capacity = capacity;
+    for( vector<data_dictionary_ptr>& objects : m_objects )
+    {
+        if( objects.size() > m_capacity )
+        {
+            objects.resize( m_capacity );
+        }
+        else
+        {
+            // Do nothing. Within the new capacity
+        }
+
+        objects.reserve( m_capacity );
+    }
+}
+
+dictionary_pool::data_dictionary_ptr dictionary_pool::take( object_kind kind )
+{
+    assert( kind < NUM_OBJECT_KINDS );
+
+    data_dictionary_ptr ret;
+
+    vector<data_dictionary_ptr>& objects = m_objects[kind];
+    if( objects.empty() == false )
+    {
+        ret.swap( objects.back() );
+        objects.pop_back();
+        ++m_stats.Hits;
+    }
+    else
+    {
+        ++m_stats.Misses;
+    }
+
+    return ret;
+}
+
+void dictionary_pool::put( object_kind kind, data_dictionary_ptr& obj )
+{
+    assert( kind < NUM_OBJECT_KINDS );
+
+    vector<data_dictionary_ptr>& objects = m_objects[kind];
+    if( obj != nullptr && objects.size() < m_capacity )
+    {
+        // Storage was reserved up front, so this does not allocate
+        objects.push_back( move( obj ) );
+        ++m_stats.Recycled;
+    }
+    else
+    {
+        ++m_stats.Discarded;
+    }
+}
+
+void dictionary_pool::get_statistics( POOL_STATS& stats ) const
+{
+    stats = m_stats;
+    stats.Pooled = 0;
+    for( const vector<data_dictionary_ptr>& objects : m_objects )
+    {
+        stats.Pooled += static_cast<unsigned long>( objects.size() );
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef DICTIONARY_POOL_H
+#define DICTIONARY_POOL_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// local public
+#include "mc3msg.h"
+
+// local private
+#include "fume/data_dictionary.h"
+
+namespace fume
+{
+
+// Keeps freed file, item and record objects so later creates can reuse
+// them instead of allocating. Objects are emptied before they are
+// returned to the pool.
+//
+// The pool does no locking of its own. library_context guards it with
+// its mutex
+class dictionary_pool final
+{
+public:
+    enum object_kind
+    {
+        FILE_OBJECT,
+        ITEM_OBJECT,
+        RECORD_OBJECT,
+        NUM_OBJECT_KINDS
+    };
+
+    typedef std::unique_ptr<data_dictionary> data_dictionary_ptr;
+
+public:
+    dictionary_pool();
+    ~dictionary_pool();
+
+    // Maximum number of objects of each kind kept by the pool
+    void set_capacity( size_t capacity );
+
+    // Returns an empty object of the given kind, or NULL if there are
+    // none. The caller must reset the object before use
+    data_dictionary_ptr take( object_kind kind );
+
+    // Takes an emptied object if there is room for it. Otherwise obj is
+    // left unchanged for the caller to destroy
+    void put( object_kind kind, data_dictionary_ptr& obj );
+
+    // Records an object which was freed without being offered to the
+    // pool (eg. it was allocated from a file arena)
+    void discard()
+    {
+        ++m_stats.Discarded;
+    }
+
+    void get_statistics( POOL_STATS& stats ) const;
+
+private:
+    std::vector<data_dictionary_ptr> m_objects[NUM_OBJECT_KINDS];
+    size_t                           m_capacity;
+    POOL_STATS                       m_stats;
+
+private:
+    dictionary_pool( const dictionary_pool& );
+    dictionary_pool& operator=( const dictionary_pool& );
+};
+
+}
+
+#endif
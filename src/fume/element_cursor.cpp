@@ -0,0 +1,425 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+// local public
+#include "diction.h"
+
+// local private
+#include "fume/rx_stream.h"
+#include "fume/data_dictionary_io.h"
+#include "fume/sequence_reader.h"
+#include "fume/element_cursor.h"
+
+using std::numeric_limits;
+using std::max;
+using std::min;
+
+namespace fume
+{
+
+static const uint32_t UNDEFINED_LENGTH = numeric_limits<uint32_t>::max();
+static const uint64_t UNDEFINED_END = numeric_limits<uint64_t>::max();
+
+// Size of the first read of a value. Each further read is as large as
+// what has been read so far
+static const uint32_t VALUE_CHUNK_SIZE = 64u * 1024u;
+
+element_cursor::element_cursor( rx_stream& stream, TRANSFER_SYNTAX syntax )
+    : m_stream( stream ),
+      m_tag( 0 ),
+      m_vr( UNKNOWN_VR ),
+      m_length( 0 ),
+      m_value_pending( false ),
+      m_depth_limit( get_sequence_depth_limit() )
+{
+    const level data_set = { DATA_SET_LEVEL, syntax, UNDEFINED_END, UNKNOWN_VR, false, -1 };
+    m_levels.push_back( data_set );
+}
+
+element_cursor::~element_cursor()
+{
+}
+
+MC_STATUS element_cursor::next( uint32_t& tag, MC_VR& vr, uint32_t& length )
+{
+    const implicit_vr_scope vr_scope( m_vr_cache );
+
+    MC_STATUS ret = skip_current();
+
+    assert( m_levels.empty() == false );
+    level& current_level = m_levels.back();
+    if( ret == MC_NORMAL_COMPLETION                &&
+        current_level.end_offset != UNDEFINED_END &&
+        m_stream.tell_read() >= current_level.end_offset )
+    {
+        current_level.finished = true;
+    }
+    else
+    {
+        // Do nothing. Not at the end of a defined length level
+    }
+
+    if( ret != MC_NORMAL_COMPLETION )
+    {
+        // Do nothing. Will return error
+    }
+    else if( current_level.finished == true )
+    {
+        ret = MC_NO_MORE_ATTRIBUTES;
+    }
+    else if( current_level.type == SEQUENCE_LEVEL ||
+             current_level.type == FRAGMENT_LEVEL )
+    {
+        ret = read_item_header( current_level );
+    }
+    else
+    {
+        ret = read_element( current_level );
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        tag = m_tag;
+        vr = m_vr;
+        length = m_length;
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+MC_STATUS element_cursor::read_value( const void*& data, uint32_t& size )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    const level& current_level = m_levels.back();
+    const bool is_item = current_level.type == SEQUENCE_LEVEL;
+    if( m_value_pending == true       &&
+        is_item == false              &&
+        m_vr != SQ                    &&
+        m_length != UNDEFINED_LENGTH )
+    {
+        // The length is read from the stream, so it is checked against the
+        // enclosing sequences and items, and the buffer is grown as the
+        // value is read rather than to the length up front. The buffer
+        // only grows, so reading a series of values of similar size does
+        // not allocate
+        const uint64_t value_end = m_stream.tell_read() + m_length;
+        ret = MC_NORMAL_COMPLETION;
+        for( const level& enclosing : m_levels )
+        {
+            if( value_end > enclosing.end_offset )
+            {
+                ret = MC_VALUE_TOO_LARGE;
+            }
+            else
+            {
+                // Do nothing. The value fits in the level
+            }
+        }
+
+        uint32_t bytes_read = 0;
+        while( ret == MC_NORMAL_COMPLETION && bytes_read < m_length )
+        {
+            const uint32_t chunk_size =
+                min( m_length - bytes_read, max( bytes_read, VALUE_CHUNK_SIZE ) );
+            if( m_buffer.size() < bytes_read + chunk_size )
+            {
+                m_buffer.resize( bytes_read + chunk_size );
+            }
+            else
+            {
+                // Do nothing. Buffer is already large enough
+            }
+
+            ret = m_stream.read( m_buffer.data() + bytes_read, chunk_size );
+            bytes_read += chunk_size;
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            data = m_buffer.data();
+            size = m_length;
+            m_value_pending = false;
+        }
+        else
+        {
+            ret = ret == MC_END_OF_DATA ? MC_UNEXPECTED_EOD : ret;
+        }
+    }
+    else if( m_value_pending == true )
+    {
+        // Sequences, items and encapsulated values are read using
+        // descend
+        ret = MC_INCOMPATIBLE_VR;
+    }
+    else
+    {
+        ret = MC_NO_MORE_VALUES;
+    }
+
+    return ret;
+}
+
+MC_STATUS element_cursor::descend()
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    const level current_level = m_levels.back();
+    const uint64_t end_offset =
+        m_length == UNDEFINED_LENGTH ? UNDEFINED_END :
+                                       m_stream.tell_read() + m_length;
+    if( m_value_pending == false )
+    {
+        ret = MC_NO_MORE_VALUES;
+    }
+    else if( current_level.type == SEQUENCE_LEVEL )
+    {
+        const level item = { ITEM_LEVEL,
+                             current_level.syntax,
+                             end_offset,
+                             current_level.vr,
+                             false,
+                             m_vr_cache.pixel_representation() };
+        m_levels.push_back( item );
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else if( current_level.type == FRAGMENT_LEVEL )
+    {
+        ret = MC_INCOMPATIBLE_VR;
+    }
+    else if( (m_vr == SQ || m_length == UNDEFINED_LENGTH) &&
+             (m_levels.size() - 1u) / 2u + 1u > static_cast<size_t>( m_depth_limit ) )
+    {
+        // The data set and items alternate with the sequences they are in
+        ret = MC_VALUE_TOO_LARGE;
+    }
+    else if( m_vr == SQ || (m_vr == UNKNOWN_VR && m_length == UNDEFINED_LENGTH) )
+    {
+        // UN sequences of undefined length are always encoded as
+        // implicit little endian (PS3.5 6.2.2)
+        const level sequence = { SEQUENCE_LEVEL,
+                                 m_vr == SQ ? current_level.syntax :
+                                              IMPLICIT_LITTLE_ENDIAN,
+                                 end_offset,
+                                 m_vr,
+                                 false,
+                                 m_vr_cache.pixel_representation() };
+        m_levels.push_back( sequence );
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else if( m_length == UNDEFINED_LENGTH )
+    {
+        const level fragments = { FRAGMENT_LEVEL,
+                                  current_level.syntax,
+                                  UNDEFINED_END,
+                                  m_vr,
+                                  false,
+                                  m_vr_cache.pixel_representation() };
+        m_levels.push_back( fragments );
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = MC_INCOMPATIBLE_VR;
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        m_value_pending = false;
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+MC_STATUS element_cursor::ascend()
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( m_levels.size() > 1u )
+    {
+        // Skip over anything remaining at this level
+        ret = MC_NORMAL_COMPLETION;
+        while( ret == MC_NORMAL_COMPLETION )
+        {
+            uint32_t tag = 0;
+            MC_VR vr = UNKNOWN_VR;
+            uint32_t length = 0;
+            ret = next( tag, vr, length );
+        }
+
+        if( ret == MC_NO_MORE_ATTRIBUTES )
+        {
+            m_vr_cache.set_pixel_representation( m_levels.back().pixel_representation );
+            m_levels.pop_back();
+            m_value_pending = false;
+            ret = MC_NORMAL_COMPLETION;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Already at the top level
+        ret = MC_CANNOT_COMPLY;
+    }
+
+    return ret;
+}
+
+MC_STATUS element_cursor::skip_current()
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    if( m_value_pending == false )
+    {
+        // Do nothing. Value has already been consumed
+    }
+    else if( m_levels.back().type == SEQUENCE_LEVEL )
+    {
+        // The elements of an item are skipped through next, which skips
+        // any sequences in it without descending, so this recurses at
+        // most once
+        ret = descend();
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = ascend();
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = skip_value( m_stream,
+                          m_levels.back().syntax,
+                          m_vr,
+                          m_length );
+        m_value_pending = false;
+    }
+
+    return ret;
+}
+
+MC_STATUS element_cursor::read_item_header( level& current_level )
+{
+    uint32_t tag = 0;
+    uint32_t length = 0;
+    MC_STATUS ret = m_stream.read_tag( tag, current_level.syntax );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = m_stream.read_val( length, current_level.syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM )
+    {
+        current_level.finished = true;
+        ret = MC_NO_MORE_ATTRIBUTES;
+    }
+    else if( ret == MC_NORMAL_COMPLETION && tag == MC_ATT_ITEM )
+    {
+        m_tag = tag;
+        m_vr = current_level.vr;
+        m_length = length;
+        m_value_pending = true;
+    }
+    else if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = MC_INVALID_TAG;
+    }
+    else
+    {
+        ret = ret == MC_END_OF_DATA ? MC_UNEXPECTED_EOD : ret;
+    }
+
+    return ret;
+}
+
+MC_STATUS element_cursor::read_element( level& current_level )
+{
+    uint32_t tag = 0;
+    MC_STATUS ret = m_stream.read_tag( tag, current_level.syntax );
+    if( ret == MC_END_OF_DATA && current_level.type == DATA_SET_LEVEL )
+    {
+        // No more data when trying to read the start of a tag.
+        // terminate gracefully
+        current_level.finished = true;
+        ret = MC_NO_MORE_ATTRIBUTES;
+    }
+    else if( ret == MC_NORMAL_COMPLETION &&
+             tag == MC_ATT_ITEM_DELIMITATION_ITEM &&
+             current_level.type == ITEM_LEVEL )
+    {
+        uint32_t delim_length = 0;
+        ret = m_stream.read_val( delim_length, current_level.syntax );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            current_level.finished = true;
+            ret = MC_NO_MORE_ATTRIBUTES;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else if( ret == MC_NORMAL_COMPLETION &&
+             (tag == MC_ATT_ITEM_DELIMITATION_ITEM ||
+              tag == MC_ATT_ITEM                   ||
+              tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM) )
+    {
+        // We're not expecting to get delimiter tags
+        ret = MC_INVALID_TAG;
+    }
+    else if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = read_element_header( m_stream,
+                                   current_level.syntax,
+                                   tag,
+                                   m_vr,
+                                   m_length );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            m_tag = tag;
+            m_value_pending = true;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret == MC_END_OF_DATA ? MC_UNEXPECTED_EOD : ret;
+}
+
+}
@@ -0,0 +1,105 @@
+#ifndef ELEMENT_CURSOR_H
+#define ELEMENT_CURSOR_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+
+// local private
+#include "fume/implicit_vr_cache.h"
+
+namespace fume
+{
+
+class rx_stream;
+
+// Reads the elements of a data set one at a time on request. Only the
+// header of each element is decoded by next; its value is read by
+// read_value or skipped by the following call to next. Sequences (and
+// encapsulated values) are entered with descend, after which next
+// returns their items (and fragments). ascend skips whatever remains of
+// the current sequence or item and returns to the enclosing level.
+class element_cursor final
+{
+public:
+    // Note: the stream must have a lifetime exceeding that of this
+    // object
+    element_cursor( rx_stream& stream, TRANSFER_SYNTAX syntax );
+    ~element_cursor();
+
+    // Returns MC_NO_MORE_ATTRIBUTES at the end of the current level
+    MC_STATUS next( uint32_t& tag, MC_VR& vr, uint32_t& length );
+
+    // Reads the value of the current element. The returned data remains
+    // valid until the next call to this object
+    MC_STATUS read_value( const void*& data, uint32_t& size );
+
+    MC_STATUS descend();
+    MC_STATUS ascend();
+
+private:
+    element_cursor( const element_cursor& );
+    element_cursor& operator=( const element_cursor& );
+
+    enum level_type
+    {
+        DATA_SET_LEVEL,
+        SEQUENCE_LEVEL,
+        ITEM_LEVEL,
+        FRAGMENT_LEVEL
+    };
+
+    struct level
+    {
+        level_type      type;
+        TRANSFER_SYNTAX syntax;
+        // Offset at which a defined length sequence or item ends
+        uint64_t        end_offset;
+        // VR of the enclosing element, which is reported for items
+        MC_VR           vr;
+        bool            finished;
+        // Pixel Representation of the enclosing data set, restored when
+        // an item is ascended from
+        int             pixel_representation;
+    };
+
+    MC_STATUS skip_current();
+    MC_STATUS read_item_header( level& current_level );
+    MC_STATUS read_element( level& current_level );
+
+private:
+    rx_stream&           m_stream;
+    // The cursor is read across calls, so keeps its own cache for
+    // implicit VR data sets (and UN sequences)
+    implicit_vr_cache    m_vr_cache;
+    std::vector<level>   m_levels;
+    std::vector<uint8_t> m_buffer;
+
+    // The element most recently returned by next. Its value is
+    // pending until it has been read, skipped or descended into
+    uint32_t             m_tag;
+    MC_VR                m_vr;
+    uint32_t             m_length;
+    bool                 m_value_pending;
+
+    // descend returns MC_VALUE_TOO_LARGE for sequences nested deeper
+    int                  m_depth_limit;
+};
+
+}
+
+#endif
@@ -0,0 +1,458 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <array>
+#include <algorithm>
+#include <vector>
+
+// local public
+#include "diction.h"
+
+// local private
+#include "fume/rx_stream.h"
+#include "fume/data_dictionary_io.h"
+#include "fume/implicit_vr_cache.h"
+#include "fume/event_parser.h"
+#include "fume/sequence_reader.h"
+
+using std::numeric_limits;
+using std::array;
+using std::min;
+using std::vector;
+
+namespace fume
+{
+
+static const uint32_t UNDEFINED_LENGTH = numeric_limits<uint32_t>::max();
+static const uint64_t UNDEFINED_END = numeric_limits<uint64_t>::max();
+
+// State shared by the parse functions. The value buffer is reused for
+// every element so parsing does not allocate
+struct parse_context
+{
+    rx_stream&                stream;
+    void*                     user_info;
+    ParseEventCallback        callback;
+    array<uint8_t, 64u * 1024u> buffer;
+};
+
+// One level of the explicit stack: a sequence or encapsulated value and
+// the item within it that is currently being parsed
+struct parse_level
+{
+    uint32_t        tag;
+    MC_VR           vr;
+    TRANSFER_SYNTAX item_syntax;
+    bool            is_encapsulated;
+    uint64_t        end_offset;
+
+    bool            in_item;
+    uint64_t        item_end_offset;
+    // Pixel Representation of the enclosing data set, restored once the
+    // item has been parsed
+    int             pixel_representation;
+};
+
+static MC_STATUS parse_element( parse_context&       context,
+                                TRANSFER_SYNTAX      syntax,
+                                bool                 in_item,
+                                int                  depth_limit,
+                                vector<parse_level>& levels,
+                                bool&                end_of_elements );
+
+static MC_STATUS parse_item_start( parse_context&       context,
+                                   vector<parse_level>& levels );
+
+static MC_STATUS finish_item( parse_context& context, parse_level& level );
+
+static MC_STATUS parse_value_data( parse_context& context,
+                                   uint32_t       tag,
+                                   MC_VR          vr,
+                                   uint32_t       length );
+
+static MC_STATUS send_event( parse_context& context,
+                             MC_PARSE_EVENT event,
+                             uint32_t       tag,
+                             MC_VR          vr,
+                             uint32_t       length,
+                             void*          data,
+                             bool           is_last );
+
+MC_STATUS parse_values( rx_stream&         stream,
+                        TRANSFER_SYNTAX    syntax,
+                        void*              user_info,
+                        ParseEventCallback callback )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( callback != nullptr )
+    {
+        parse_context context = { stream, user_info, callback, {} };
+
+        // Resolves the VRs of the elements if the stream is implicit VR.
+        // The items of UN sequences are implicit VR whatever the syntax
+        // of the stream, so a cache is made current in either case
+        const implicit_vr_scope vr_scope( IMPLICIT_LITTLE_ENDIAN );
+        const int depth_limit = get_sequence_depth_limit();
+
+        // The sequences being parsed, innermost last. Nested sequences
+        // are parsed using this stack rather than by recursing, so stack
+        // usage does not depend on the nesting depth of the input
+        vector<parse_level> levels;
+        bool finished = false;
+        ret = MC_NORMAL_COMPLETION;
+        while( ret == MC_NORMAL_COMPLETION && finished == false )
+        {
+            if( levels.empty() == true )
+            {
+                ret = parse_element( context,
+                                     syntax,
+                                     false,
+                                     depth_limit,
+                                     levels,
+                                     finished );
+            }
+            else if( levels.back().in_item == true )
+            {
+                bool end_of_item = false;
+                ret = parse_element( context,
+                                     levels.back().item_syntax,
+                                     true,
+                                     depth_limit,
+                                     levels,
+                                     end_of_item );
+                if( ret == MC_NORMAL_COMPLETION && end_of_item == true )
+                {
+                    ret = finish_item( context, levels.back() );
+                }
+                else
+                {
+                    // Do nothing. More elements or an error
+                }
+            }
+            else
+            {
+                ret = parse_item_start( context, levels );
+            }
+        }
+    }
+    else
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+
+    return ret == MC_END_OF_DATA ? MC_UNEXPECTED_EOD : ret;
+}
+
+// Parses the next element of the data set or item, starting a new level
+// if it is a sequence or encapsulated value. end_of_elements is set at
+// the end of the data set or item instead
+MC_STATUS parse_element( parse_context&       context,
+                         TRANSFER_SYNTAX      syntax,
+                         bool                 in_item,
+                         int                  depth_limit,
+                         vector<parse_level>& levels,
+                         bool&                end_of_elements )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    uint32_t tag = 0;
+    if( in_item == true &&
+        levels.back().item_end_offset != UNDEFINED_END &&
+        context.stream.tell_read() >= levels.back().item_end_offset )
+    {
+        end_of_elements = true;
+    }
+    else
+    {
+        ret = context.stream.read_tag( tag, syntax );
+    }
+
+    if( end_of_elements == true )
+    {
+        // Do nothing. Reached the end of a defined length item
+    }
+    else if( ret == MC_END_OF_DATA && in_item == false )
+    {
+        // No more data when trying to read the start of a tag.
+        // terminate gracefully
+        end_of_elements = true;
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else if( ret == MC_NORMAL_COMPLETION &&
+             tag == MC_ATT_ITEM_DELIMITATION_ITEM &&
+             in_item == true )
+    {
+        uint32_t delim_length = 0;
+        ret = context.stream.read_val( delim_length, syntax );
+        end_of_elements = true;
+    }
+    else if( ret == MC_NORMAL_COMPLETION &&
+             (tag == MC_ATT_ITEM_DELIMITATION_ITEM ||
+              tag == MC_ATT_ITEM                   ||
+              tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM) )
+    {
+        // We're not expecting to get delimiter tags
+        ret = MC_INVALID_TAG;
+    }
+    else if( ret == MC_NORMAL_COMPLETION )
+    {
+        MC_VR vr = UNKNOWN_VR;
+        uint32_t length = 0;
+        ret = read_element_header( context.stream,
+                                   syntax,
+                                   tag,
+                                   vr,
+                                   length );
+        if( ret == MC_NORMAL_COMPLETION &&
+            (vr == SQ || length == UNDEFINED_LENGTH) &&
+            levels.size() + 1u > static_cast<size_t>( depth_limit ) )
+        {
+            ret = MC_VALUE_TOO_LARGE;
+        }
+        else if( ret == MC_NORMAL_COMPLETION &&
+                 (vr == SQ || length == UNDEFINED_LENGTH) )
+        {
+            // UN sequences of undefined length are always encoded as
+            // implicit little endian (PS3.5 6.2.2). Undefined length
+            // values other than sequences are encapsulated
+            const parse_level level =
+            {
+                tag,
+                vr,
+                vr == UNKNOWN_VR ? IMPLICIT_LITTLE_ENDIAN : syntax,
+                vr != SQ && vr != UNKNOWN_VR,
+                length == UNDEFINED_LENGTH ?
+                    UNDEFINED_END :
+                    context.stream.tell_read() + length,
+                false,
+                UNDEFINED_END,
+                -1
+            };
+            levels.push_back( level );
+
+            ret = send_event( context,
+                              MC_PARSE_START_SEQUENCE,
+                              tag,
+                              vr,
+                              length,
+                              nullptr,
+                              false );
+        }
+        else if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = send_event( context,
+                              MC_PARSE_START_ELEMENT,
+                              tag,
+                              vr,
+                              length,
+                              nullptr,
+                              length == 0u );
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = parse_value_data( context, tag, vr, length );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+// Starts the next item of the innermost sequence, or finishes the
+// sequence if there are no more items. The fragment of an encapsulated
+// value is parsed along with its item
+MC_STATUS parse_item_start( parse_context&       context,
+                            vector<parse_level>& levels )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    parse_level& level = levels.back();
+
+    bool end_of_sequence = false;
+    uint32_t item_tag = 0;
+    uint32_t item_length = 0;
+    if( level.end_offset != UNDEFINED_END &&
+        context.stream.tell_read() >= level.end_offset )
+    {
+        end_of_sequence = true;
+    }
+    else
+    {
+        ret = context.stream.read_tag( item_tag, level.item_syntax );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = context.stream.read_val( item_length, level.item_syntax );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    if( ret != MC_NORMAL_COMPLETION )
+    {
+        // Do nothing. Will return error
+    }
+    else if( end_of_sequence == true ||
+             item_tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM )
+    {
+        ret = send_event( context,
+                          MC_PARSE_END_SEQUENCE,
+                          level.tag,
+                          level.vr,
+                          0u,
+                          nullptr,
+                          true );
+        levels.pop_back();
+    }
+    else if( item_tag == MC_ATT_ITEM )
+    {
+        ret = send_event( context,
+                          MC_PARSE_START_ITEM,
+                          item_tag,
+                          level.vr,
+                          item_length,
+                          nullptr,
+                          false );
+        if( ret == MC_NORMAL_COMPLETION && level.is_encapsulated == true )
+        {
+            ret = parse_value_data( context, level.tag, level.vr, item_length );
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = send_event( context,
+                                  MC_PARSE_END_ITEM,
+                                  item_tag,
+                                  level.vr,
+                                  0u,
+                                  nullptr,
+                                  true );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else if( ret == MC_NORMAL_COMPLETION )
+        {
+            implicit_vr_cache* const vr_cache = implicit_vr_cache::current();
+            assert( vr_cache != nullptr );
+
+            level.in_item = true;
+            level.item_end_offset =
+                item_length == UNDEFINED_LENGTH ?
+                    UNDEFINED_END :
+                    context.stream.tell_read() + item_length;
+            level.pixel_representation = vr_cache->pixel_representation();
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = MC_INVALID_TAG;
+    }
+
+    return ret;
+}
+
+// Ends the current item of level. The Pixel Representation of an item
+// does not apply once it ends
+MC_STATUS finish_item( parse_context& context, parse_level& level )
+{
+    implicit_vr_cache* const vr_cache = implicit_vr_cache::current();
+    assert( vr_cache != nullptr );
+
+    vr_cache->set_pixel_representation( level.pixel_representation );
+    level.in_item = false;
+
+    return send_event( context,
+                       MC_PARSE_END_ITEM,
+                       MC_ATT_ITEM,
+                       level.vr,
+                       0u,
+                       nullptr,
+                       true );
+}
+
+MC_STATUS parse_value_data( parse_context& context,
+                            uint32_t       tag,
+                            MC_VR          vr,
+                            uint32_t       length )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    uint32_t bytes_remaining = length;
+    while( ret == MC_NORMAL_COMPLETION && bytes_remaining > 0u )
+    {
+        const uint32_t chunk_size =
+            min( static_cast<uint32_t>( context.buffer.size() ),
+                 bytes_remaining );
+        ret = context.stream.read( context.buffer.data(), chunk_size );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            bytes_remaining -= chunk_size;
+            ret = send_event( context,
+                              MC_PARSE_VALUE_DATA,
+                              tag,
+                              vr,
+                              chunk_size,
+                              context.buffer.data(),
+                              bytes_remaining == 0u );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret == MC_END_OF_DATA ? MC_UNEXPECTED_EOD : ret;
+}
+
+MC_STATUS send_event( parse_context& context,
+                      MC_PARSE_EVENT event,
+                      uint32_t       tag,
+                      MC_VR          vr,
+                      uint32_t       length,
+                      void*          data,
+                      bool           is_last )
+{
+    assert( context.callback != nullptr );
+
+    const MC_STATUS stat = context.callback( context.user_info,
+                                             event,
+                                             tag,
+                                             vr,
+                                             length,
+                                             data,
+                                             static_cast<int>( is_last ) );
+
+    return stat == MC_NORMAL_COMPLETION ? MC_NORMAL_COMPLETION :
+                                          MC_CALLBACK_CANNOT_COMPLY;
+}
+
+}
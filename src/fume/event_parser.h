@@ -0,0 +1,45 @@
+#ifndef EVENT_PARSER_H
+#define EVENT_PARSER_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+#include "mc3media.h"
+
+namespace fume
+{
+
+class rx_stream;
+
+// Parses the data set in the stream, reporting each element to the
+// callback instead of storing it in a data_dictionary. Elements are
+// reported as MC_PARSE_START_ELEMENT followed by MC_PARSE_VALUE_DATA
+// events for each chunk of the value, in the byte order of the transfer
+// syntax. Zero length elements have no MC_PARSE_VALUE_DATA events and
+// are reported with the last flag set. Sequences and encapsulated values are reported as
+// MC_PARSE_START_SEQUENCE and MC_PARSE_END_SEQUENCE events enclosing
+// MC_PARSE_START_ITEM and MC_PARSE_END_ITEM events. The items of an
+// encapsulated value contain MC_PARSE_VALUE_DATA events for the fragment.
+//
+// For implicit syntaxes, conditional VRs are resolved from the data set
+// being parsed (ie. by its Pixel Representation).
+MC_STATUS parse_values( rx_stream&         stream,
+                        TRANSFER_SYNTAX    syntax,
+                        void*              user_info,
+                        ParseEventCallback callback );
+
+}
+
+#endif
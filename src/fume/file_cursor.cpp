@@ -0,0 +1,70 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+
+// local private
+#include "fume/file_object.h"
+#include "fume/file_rx_stream.h"
+#include "fume/inflate_rx_stream.h"
+#include "fume/file_object_io.h"
+#include "fume/file_cursor.h"
+
+using std::string;
+
+namespace fume
+{
+
+file_cursor::file_cursor( const string&    filename,
+                          ReadFileCallback callback,
+                          void*            user_info )
+    : m_filename( filename ),
+      m_stream( new file_rx_stream( m_filename, callback, user_info ) )
+{
+}
+
+file_cursor::~file_cursor()
+{
+}
+
+MC_STATUS file_cursor::open( file_object& file, int app_id )
+{
+    MC_STATUS ret = read_file_header( *m_stream, file, app_id );
+
+    TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = file.get_transfer_syntax( syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION &&
+        syntax == DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+    {
+        m_inflate_stream.reset( new inflate_rx_stream( *m_stream ) );
+        m_cursor.reset( new element_cursor( *m_inflate_stream, syntax ) );
+    }
+    else if( ret == MC_NORMAL_COMPLETION )
+    {
+        m_cursor.reset( new element_cursor( *m_stream, syntax ) );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+}
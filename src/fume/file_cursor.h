@@ -0,0 +1,67 @@
+#ifndef FILE_CURSOR_H
+#define FILE_CURSOR_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <string>
+#include <memory>
+
+// local public
+#include "mcstatus.h"
+#include "mc3media.h"
+
+// local private
+#include "fume/element_cursor.h"
+
+namespace fume
+{
+
+class file_object;
+class file_rx_stream;
+class inflate_rx_stream;
+
+// An element_cursor over the data set of a file, along with the streams
+// it reads from
+class file_cursor final
+{
+public:
+    // Note: the user info and callback must remain valid for the
+    // lifetime of this object
+    file_cursor( const std::string& filename,
+                 ReadFileCallback   callback,
+                 void*              user_info );
+    ~file_cursor();
+
+    // Reads the file meta information into the file object and
+    // positions the cursor at the start of the data set
+    MC_STATUS open( file_object& file, int app_id );
+
+    element_cursor& cursor()
+    {
+        return *m_cursor;
+    }
+
+private:
+    file_cursor( const file_cursor& );
+    file_cursor& operator=( const file_cursor& );
+
+private:
+    // Declared before m_stream, which keeps a reference to it
+    const std::string                  m_filename;
+    std::unique_ptr<file_rx_stream>    m_stream;
+    std::unique_ptr<inflate_rx_stream> m_inflate_stream;
+    std::unique_ptr<element_cursor>    m_cursor;
+};
+
+}
+
+#endif
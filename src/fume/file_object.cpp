@@ -39,13 +39,15 @@ namespace fume
 
 file_object::file_object( int id, const char* filename, bool created_empty )
     : data_dictionary( id, created_empty ),
-      m_filename( filename )
+      m_filename( filename ),
+      m_arena( nullptr )
 {
     m_preamble.fill( 0 );
 }
 
 file_object::~file_object()
 {
+    reset_arena( nullptr );
 }
 
 
@@ -138,6 +140,31 @@ void file_object::empty_file()
 {
     clear();
     m_preamble.fill( 0u );
+    reset_arena( nullptr );
+    m_bulk_source.reset();
+}
+
+void file_object::reset( int id, const char* filename )
+{
+    data_dictionary::reset( id );
+    m_filename = filename;
+    m_preamble.fill( 0u );
+    reset_arena( nullptr );
+    m_bulk_source.reset();
+}
+
+void file_object::reset_arena( arena* value )
+{
+    if( m_arena != nullptr )
+    {
+        m_arena->release();
+    }
+    else
+    {
+        // Do nothing. No arena to release
+    }
+
+    m_arena = value;
 }
 
 MC_STATUS file_object::set_transfer_syntax( TRANSFER_SYNTAX syntax )
@@ -15,16 +15,20 @@
 #include <cstdint>
 #include <string>
 #include <array>
+#include <memory>
 
 // local public
 #include "mcstatus.h"
 
 // local private
 #include "fume/data_dictionary.h"
+#include "fume/arena.h"
 
 namespace fume
 {
 
+class bulk_data_source;
+
 class file_object : public data_dictionary
 {
 public:
@@ -41,7 +45,31 @@ public:
         return m_filename;
     }
 
-    void empty_file();
+    virtual void empty_file();
+
+    // Prepares a file taken from the object pool for reuse
+    void reset( int id, const char* filename );
+
+    // Replaces the arena that values read into the file are allocated
+    // from, taking over the caller's reference. The previous arena is
+    // freed once the values allocated from it have been freed
+    void reset_arena( arena* value );
+    arena* get_arena() const
+    {
+        return m_arena;
+    }
+
+    // Source of the bulk references of a file opened with
+    // MC_Open_File_Bulk_Reference. Not owned; expires once the last
+    // reference into the source is freed
+    void set_bulk_source( const std::shared_ptr<bulk_data_source>& source )
+    {
+        m_bulk_source = source;
+    }
+    std::shared_ptr<bulk_data_source> get_bulk_source() const
+    {
+        return m_bulk_source.lock();
+    }
 
     virtual MC_STATUS set_transfer_syntax( TRANSFER_SYNTAX syntax ) override final;
     virtual MC_STATUS get_transfer_syntax( TRANSFER_SYNTAX& syntax ) override final;
@@ -49,6 +77,8 @@ public:
 private:
     std::string              m_filename;
     std::array<uint8_t, 128> m_preamble;
+    arena*                   m_arena;
+    std::weak_ptr<bulk_data_source> m_bulk_source;
 };
 
 }
@@ -12,8 +12,15 @@
 
 // std
 #include <cstdint>
+#include <cstdio>
+#include <vector>
 #include <array>
 #include <string>
+#include <memory>
+#include <limits>
+
+// posix
+#include <sys/stat.h>
 
 // local public
 #include "mcstatus.h"
@@ -21,18 +28,30 @@
 
 // local private
 #include "fume/file_object.h"
+#include "fume/arena.h"
 #include "fume/tx_stream.h"
 #include "fume/rx_stream.h"
 #include "fume/value_representation.h"
 #include "fume/null_tx_stream.h"
 #include "fume/file_tx_stream.h"
 #include "fume/file_rx_stream.h"
+#include "fume/deflate_tx_stream.h"
+#include "fume/parallel_deflate_tx_stream.h"
+#include "fume/inflate_rx_stream.h"
 #include "fume/library_context.h"
 #include "fume/data_dictionary_io.h"
+#include "fume/transcoder.h"
+#include "fume/bulk_data_source.h"
+#include "fume/memory_stream.h"
+#include "fume/tag_filter.h"
+#include "fume/event_parser.h"
 #include "fume/file_object_io.h"
 
 using std::array;
+using std::numeric_limits;
 using std::string;
+using std::shared_ptr;
+using std::vector;
 
 namespace fume
 {
@@ -47,9 +66,44 @@ static MC_STATUS write_file_values( tx_stream&       stream,
                                     data_dictionary& dict,
                                     int              app_id );
 
-static MC_STATUS read_file_header( rx_stream&   stream,
-                                   file_object& file,
-                                   int          app_id );
+static MC_STATUS write_deflated_values( tx_stream&       stream,
+                                        data_dictionary& dict,
+                                        int              app_id );
+
+static MC_STATUS transcode_file_values( rx_stream&      source,
+                                        tx_stream&      dest,
+                                        file_object&    file,
+                                        int             app_id,
+                                        TRANSFER_SYNTAX source_syntax,
+                                        TRANSFER_SYNTAX dest_syntax );
+
+static MC_STATUS read_file_values_filtered( rx_stream&        stream,
+                                            TRANSFER_SYNTAX   syntax,
+                                            file_object&      file,
+                                            int               app_id,
+                                            const tag_filter& filter );
+
+static MC_STATUS encode_element( value_representation& value,
+                                 TRANSFER_SYNTAX       syntax,
+                                 vector<uint8_t>&      data );
+
+static MC_STATUS patch_stream_callback( char* Cbfilename,
+                                        void* CbuserInfo,
+                                        int*  CbdataSize,
+                                        void** CbdataBuffer,
+                                        int   CbisFirst,
+                                        int*  CbisLast );
+
+static arena* create_file_arena();
+
+static bool is_same_file( const string& lhs, const string& rhs );
+
+static MC_STATUS read_file_values_upto( rx_stream&      stream,
+                                        TRANSFER_SYNTAX syntax,
+                                        file_object&    file,
+                                        int             app_id,
+                                        uint32_t        end_tag,
+                                        uint64_t&       offset );
 
 // This array is written after the preamble. It is not
 // NULL-terminated and therefore should not be treated
@@ -57,6 +111,14 @@ static MC_STATUS read_file_header( rx_stream&   stream,
 static const array<char, 4> DICOM_PREFIX { { 'D', 'I', 'C', 'M' } };
 static const char META_INFORMATION_VERSION[] = { 0, 1 };
 
+// Source of the file being patched. The buffer size is even so that
+// the callback only returns an odd number of bytes for an invalid file
+struct patch_source
+{
+    FILE*                  file;
+    array<uint8_t, 65536u> buffer;
+};
+
 MC_STATUS write_file( file_object&      file,
                       int               alignment,
                       void*             user_info,
@@ -81,20 +143,41 @@ MC_STATUS write_file( file_object&      file,
     {
         const string& filename( file.get_filename() );
 
-        file_tx_stream stream( filename.c_str(), callback, user_info );
+        // Writing over the file the bulk references point into would
+        // truncate it before the values are copied, so they are read
+        // into memory first
+        const shared_ptr<bulk_data_source> bulk( file.get_bulk_source() );
+        if( bulk != nullptr && is_same_file( bulk->filename(), filename ) == true )
+        {
+            ret = bulk->load_references();
+        }
+        else
+        {
+            ret = MC_NORMAL_COMPLETION;
+        }
 
-        ret = write_file( stream, file, app_id );
         if( ret == MC_NORMAL_COMPLETION )
         {
-            ret = stream.finalize();
+            file_tx_stream stream( filename, callback, user_info );
+
+            ret = write_file( stream, file, app_id );
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = stream.finalize();
+            }
+            else
+            {
+                // Call finalize in case the callback function needs
+                // to clean itself up.
+                // TODO: figure out if this is consistent with the
+                // reference implementation
+                (void)stream.finalize();
+            }
         }
         else
         {
-            // Call finalize in case the callback function needs
-            // to clean itself up.
-            // TODO: figure out if this is consistent with the
-            // reference implementation
-            (void)stream.finalize();
+            // Do nothing. Will return error from load_references. The
+            // callback isn't called so the destination is left untouched
         }
     }
     else
@@ -106,6 +189,21 @@ MC_STATUS write_file( file_object&      file,
 }
 
 MC_STATUS write_file( tx_stream& stream, file_object& file, int app_id )
+{
+    MC_STATUS ret = write_file_header( stream, file, app_id );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_file_values( stream, file, app_id );
+    }
+    else
+    {
+        // Do nothing. Will return error from write_file_header
+    }
+
+    return ret;
+}
+
+MC_STATUS write_file_header( tx_stream& stream, file_object& file, int app_id )
 {
     // Fill in required Group 2 attribute data
     MC_STATUS ret = fill_group_2_attributes( file );
@@ -122,7 +220,14 @@ MC_STATUS write_file( tx_stream& stream, file_object& file, int app_id )
             ret = stream.write( DICOM_PREFIX.data(), DICOM_PREFIX.size() );
             if( ret == MC_NORMAL_COMPLETION )
             {
-                ret = write_file_values( stream, file, app_id );
+                // Group 2 attributes are always written in Explicit Little
+                // Endian transfer syntax
+                ret = write_values( stream,
+                                    EXPLICIT_LITTLE_ENDIAN,
+                                    file,
+                                    app_id,
+                                    0x00020000u,
+                                    0x0002FFFFu );
             }
             else
             {
@@ -218,29 +323,19 @@ MC_STATUS write_file_values( tx_stream&       stream,
 {
     TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
     MC_STATUS ret = dict.get_transfer_syntax( syntax );
-    if( ret == MC_NORMAL_COMPLETION )
+    if( ret == MC_NORMAL_COMPLETION &&
+        syntax == DEFLATED_EXPLICIT_LITTLE_ENDIAN )
     {
-        // Group 2 attributes are always written in Explicit Little Endian
-        // transfer syntax
-        MC_STATUS ret = write_values( stream,
-                                      EXPLICIT_LITTLE_ENDIAN,
-                                      dict,
-                                      app_id,
-                                      0x00020000u,
-                                      0x0002FFFFu );
-        if( ret == MC_NORMAL_COMPLETION )
-        {
-            ret = write_values( stream,
-                                syntax,
-                                dict,
-                                app_id,
-                                0x00030000u,
-                                0xFFFFFFFFu );
-        }
-        else
-        {
-            // Do nothing. Will return error from write_values
-        }
+        ret = write_deflated_values( stream, dict, app_id );
+    }
+    else if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_values( stream,
+                            syntax,
+                            dict,
+                            app_id,
+                            0x00030000u,
+                            0xFFFFFFFFu );
     }
     else
     {
@@ -250,6 +345,60 @@ MC_STATUS write_file_values( tx_stream&       stream,
     return ret;
 }
 
+template<class DeflateStream>
+static MC_STATUS deflate_values( DeflateStream&   deflate_stream,
+                                 data_dictionary& dict,
+                                 int              app_id )
+{
+    MC_STATUS ret = write_values( deflate_stream,
+                                  DEFLATED_EXPLICIT_LITTLE_ENDIAN,
+                                  dict,
+                                  app_id,
+                                  0x00030000u,
+                                  0xFFFFFFFFu );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = deflate_stream.finalize();
+    }
+    else
+    {
+        // Do nothing. Will return error from write_values
+    }
+
+    return ret;
+}
+
+MC_STATUS write_deflated_values( tx_stream&       stream,
+                                 data_dictionary& dict,
+                                 int              app_id )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    int level = Z_DEFAULT_COMPRESSION;
+    int threads = 1;
+    assert( g_context != nullptr );
+    // Leave the defaults in place if the values are not configured
+    (void)g_context->get_int_config_value( DEFLATE_COMPRESSION_LEVEL, level );
+    (void)g_context->get_int_config_value( DEFLATE_THREADS, threads );
+
+    // Everything after Group 2 is compressed as it is written, so the
+    // uncompressed data set is never held in memory
+    if( threads > 1 )
+    {
+        parallel_deflate_tx_stream deflate_stream( stream,
+                                                   level,
+                                                   static_cast<size_t>( threads ) );
+        ret = deflate_values( deflate_stream, dict, app_id );
+    }
+    else
+    {
+        deflate_tx_stream deflate_stream( stream, level );
+        ret = deflate_values( deflate_stream, dict, app_id );
+    }
+
+    return ret;
+}
+
 MC_STATUS update_file_group_length( data_dictionary& dict )
 {
     MC_STATUS ret = MC_CANNOT_COMPLY;
@@ -296,6 +445,11 @@ MC_STATUS read_file_header( rx_stream& stream, file_object& file, int app_id )
                 // This function only fails if the pointer is NULL
                 (void)file.set_preamble( preamble );
 
+                // Values read into the file, including those read by
+                // the caller, come from a new arena if one is configured
+                file.reset_arena( create_file_arena() );
+                const arena_scope scope( file.get_arena() );
+
                 // Read the Group 2 elements in explicit little endian
                 ret = read_values_upto( stream,
                                         EXPLICIT_LITTLE_ENDIAN,
@@ -321,6 +475,75 @@ MC_STATUS read_file_header( rx_stream& stream, file_object& file, int app_id )
     return ret;
 }
 
+MC_STATUS read_file_values_upto( rx_stream&      stream,
+                                 TRANSFER_SYNTAX syntax,
+                                 file_object&    file,
+                                 int             app_id,
+                                 uint32_t        end_tag,
+                                 uint64_t&       offset )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( syntax == DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+    {
+        // Everything after Group 2 is inflated as it is parsed. The
+        // returned offset is relative to the inflated data set
+        inflate_rx_stream inflate_stream( stream );
+        ret = read_values_upto( inflate_stream,
+                                syntax,
+                                file,
+                                app_id,
+                                end_tag );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            offset = inflate_stream.tell_read();
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = read_values_upto( stream, syntax, file, app_id, end_tag );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            offset = stream.tell_read();
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret;
+}
+
+MC_STATUS read_file_values_filtered( rx_stream&        stream,
+                                     TRANSFER_SYNTAX   syntax,
+                                     file_object&      file,
+                                     int               app_id,
+                                     const tag_filter& filter )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( syntax == DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+    {
+        inflate_rx_stream inflate_stream( stream );
+        ret = read_values_filtered( inflate_stream,
+                                    syntax,
+                                    file,
+                                    app_id,
+                                    filter );
+    }
+    else
+    {
+        ret = read_values_filtered( stream, syntax, file, app_id, filter );
+    }
+
+    return ret;
+}
+
 MC_STATUS open_file( file_object&     file,
                      int              app_id,
                      void*            user_info,
@@ -352,16 +575,437 @@ MC_STATUS open_file_upto( file_object&     file,
             ret = file.get_transfer_syntax( syntax );
             if( ret == MC_NORMAL_COMPLETION )
             {
-                ret = read_values_upto( stream, syntax, file, app_id, end_tag );
+                const arena_scope scope( file.get_arena() );
+                ret = read_file_values_upto( stream,
+                                             syntax,
+                                             file,
+                                             app_id,
+                                             end_tag,
+                                             offset );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+
+    return ret;
+}
+
+MC_STATUS open_file_filtered( file_object&      file,
+                              int               app_id,
+                              const tag_filter& filter,
+                              void*             user_info,
+                              ReadFileCallback  callback )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( callback != nullptr )
+    {
+        file_rx_stream stream( file.get_filename(), callback, user_info );
+        ret = read_file_header( stream, file, app_id );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
+            ret = file.get_transfer_syntax( syntax );
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                const arena_scope scope( file.get_arena() );
+                ret = read_file_values_filtered( stream,
+                                                 syntax,
+                                                 file,
+                                                 app_id,
+                                                 filter );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+
+    return ret;
+}
+
+MC_STATUS open_file_bulk_reference( file_object&     file,
+                                    int              app_id,
+                                    void*            user_info,
+                                    ReadFileCallback callback )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( callback != nullptr )
+    {
+        file_rx_stream stream( file.get_filename(), callback, user_info );
+        ret = read_file_header( stream, file, app_id );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
+            ret = file.get_transfer_syntax( syntax );
+            const arena_scope scope( file.get_arena() );
+            if( ret == MC_NORMAL_COMPLETION &&
+                syntax != DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+            {
+                int min_length = 0;
+                assert( g_context != nullptr );
+                // Leave the default in place if the value is not configured
+                (void)g_context->get_int_config_value( LARGE_DATA_SIZE,
+                                                       min_length );
+
+                const shared_ptr<bulk_data_source> bulk(
+                    new bulk_data_source( file.get_filename(),
+                                          callback,
+                                          user_info,
+                                          static_cast<uint32_t>( min_length ) ) );
+                file.set_bulk_source( bulk );
+                ret = read_values_upto( stream,
+                                        syntax,
+                                        file,
+                                        app_id,
+                                        0xFFFFFFFFu,
+                                        bulk );
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                // Offsets into the inflated data set can't be mapped
+                // back to the file, so everything is read into memory
+                uint64_t offset = 0;
+                ret = read_file_values_upto( stream,
+                                             syntax,
+                                             file,
+                                             app_id,
+                                             0xFFFFFFFFu,
+                                             offset );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+
+    return ret;
+}
+
+MC_STATUS parse_file( file_object&       file,
+                      int                app_id,
+                      void*              read_user_info,
+                      ReadFileCallback   read_callback,
+                      void*              event_user_info,
+                      ParseEventCallback event_callback )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( read_callback != nullptr && event_callback != nullptr )
+    {
+        file_rx_stream stream( file.get_filename(),
+                               read_callback,
+                               read_user_info );
+        ret = read_file_header( stream, file, app_id );
+
+        TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = file.get_transfer_syntax( syntax );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+
+        if( ret == MC_NORMAL_COMPLETION &&
+            syntax == DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+        {
+            inflate_rx_stream inflate_stream( stream );
+            ret = parse_values( inflate_stream,
+                                syntax,
+                                event_user_info,
+                                event_callback );
+        }
+        else if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = parse_values( stream,
+                                syntax,
+                                event_user_info,
+                                event_callback );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+
+    return ret;
+}
+
+MC_STATUS patch_file_value( file_object& file, int app_id, uint32_t tag )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    // The meta information is always read in full by read_file_header
+    if( tag > 0x0002FFFFu && file.has_tag( tag ) == true )
+    {
+        patch_source source;
+        source.file = fopen( file.get_filename().c_str(), "r+b" );
+        if( source.file != nullptr )
+        {
+            // The header is read into a separate object so the values
+            // set in file are left in place
+            file_object header( -1, file.get_filename().c_str(), true );
+            file_rx_stream stream( header.get_filename(),
+                                   patch_stream_callback,
+                                   &source );
+            ret = read_file_header( stream, header, app_id );
+
+            TRANSFER_SYNTAX syntax = INVALID_TRANSFER_SYNTAX;
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = header.get_transfer_syntax( syntax );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+
+            uint64_t offset = 0;
+            MC_VR vr = UNKNOWN_VR;
+            uint32_t length = 0;
+            if( ret == MC_NORMAL_COMPLETION &&
+                syntax != DEFLATED_EXPLICIT_LITTLE_ENDIAN )
+            {
+                ret = find_element( stream,
+                                    syntax,
+                                    tag,
+                                    offset,
+                                    vr,
+                                    length );
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                // Element offsets within the compressed data set can't
+                // be patched
+                ret = MC_INVALID_TRANSFER_SYNTAX;
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+
+            vector<uint8_t> data;
+            if( ret == MC_NORMAL_COMPLETION && length != 0xFFFFFFFFu )
+            {
+                ret = encode_element( *file.at( tag ), syntax, data );
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = MC_INVALID_LENGTH_FOR_VR;
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                // The encoded data includes the VR and length fields, so
+                // the sizes match if the padded value lengths match
+                const uint64_t element_size =
+                    (stream.tell_read() - offset) + length;
+                if( element_size == data.size() )
+                {
+                    if( offset <= static_cast<uint64_t>( numeric_limits<long>::max() ) &&
+                        fseek( source.file, static_cast<long>( offset ), SEEK_SET ) == 0 &&
+                        fwrite( data.data(), data.size(), 1, source.file ) == 1u )
+                    {
+                        ret = MC_NORMAL_COMPLETION;
+                    }
+                    else
+                    {
+                        ret = MC_CANNOT_COMPLY;
+                    }
+                }
+                else
+                {
+                    ret = MC_INVALID_LENGTH_FOR_VR;
+                }
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+
+            if( fclose( source.file ) != 0 && ret == MC_NORMAL_COMPLETION )
+            {
+                ret = MC_CANNOT_COMPLY;
+            }
+            else
+            {
+                // Do nothing. Return status from above
+            }
+        }
+        else
+        {
+            ret = MC_CANNOT_COMPLY;
+        }
+    }
+    else
+    {
+        ret = MC_INVALID_TAG;
+    }
+
+    return ret;
+}
+
+MC_STATUS encode_element( value_representation& value,
+                          TRANSFER_SYNTAX       syntax,
+                          vector<uint8_t>&      data )
+{
+    memory_stream stream;
+    MC_STATUS ret = stream.write_vr( value.vr(), syntax );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = value.to_stream( stream, syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        data.resize( static_cast<size_t>( stream.size() ) );
+        ret = stream.seek( 0u );
+        if( ret == MC_NORMAL_COMPLETION && data.empty() == false )
+        {
+            ret = stream.read( data.data(), static_cast<uint32_t>( data.size() ) );
+        }
+        else
+        {
+            // Do nothing. Will return error or nothing to read
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+MC_STATUS patch_stream_callback( char*  Cbfilename,
+                                 void*  CbuserInfo,
+                                 int*   CbdataSize,
+                                 void** CbdataBuffer,
+                                 int    CbisFirst,
+                                 int*   CbisLast )
+{
+    assert( CbuserInfo != nullptr );
+    patch_source* source = static_cast<patch_source*>( CbuserInfo );
+
+    const size_t bytes_read = fread( source->buffer.data(),
+                                     1u,
+                                     source->buffer.size(),
+                                     source->file );
+
+    // Check for the end of the file so a full buffer at the end of the
+    // file isn't followed by an empty one
+    const int next = fgetc( source->file );
+    if( next != EOF )
+    {
+        (void)ungetc( next, source->file );
+    }
+    else
+    {
+        // Do nothing. End of file
+    }
+
+    *CbdataSize = static_cast<int>( bytes_read );
+    *CbdataBuffer = source->buffer.data();
+    *CbisLast = static_cast<int>( next == EOF );
+
+    return ferror( source->file ) == 0 ? MC_NORMAL_COMPLETION :
+                                         MC_CANNOT_COMPLY;
+}
+
+MC_STATUS transcode_file( file_object&      file,
+                          int               app_id,
+                          TRANSFER_SYNTAX   syntax,
+                          void*             read_user_info,
+                          ReadFileCallback  read_callback,
+                          void*             write_user_info,
+                          WriteFileCallback write_callback )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( read_callback != nullptr && write_callback != nullptr )
+    {
+        file_rx_stream source( file.get_filename(),
+                               read_callback,
+                               read_user_info );
+        // Leaves only the Group 2 attributes in the file object
+        ret = read_file_header( source, file, app_id );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            TRANSFER_SYNTAX source_syntax = INVALID_TRANSFER_SYNTAX;
+            ret = file.get_transfer_syntax( source_syntax );
+            if( ret == MC_NORMAL_COMPLETION &&
+                transcoder_supports_syntax( source_syntax ) == true &&
+                transcoder_supports_syntax( syntax ) == true )
+            {
+                file_tx_stream dest( file.get_filename(),
+                                     write_callback,
+                                     write_user_info );
+
+                ret = transcode_file_values( source,
+                                             dest,
+                                             file,
+                                             app_id,
+                                             source_syntax,
+                                             syntax );
                 if( ret == MC_NORMAL_COMPLETION )
                 {
-                    offset = stream.tell_read();
+                    ret = dest.finalize();
                 }
                 else
                 {
-                    // Do nothing. Will return error
+                    // Call finalize in case the callback function needs
+                    // to clean itself up.
+                    (void)dest.finalize();
                 }
             }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = MC_INVALID_TRANSFER_SYNTAX;
+            }
             else
             {
                 // Do nothing. Will return error
@@ -380,4 +1024,81 @@ MC_STATUS open_file_upto( file_object&     file,
     return ret;
 }
 
-}
\ No newline at end of file
+MC_STATUS transcode_file_values( rx_stream&      source,
+                                 tx_stream&      dest,
+                                 file_object&    file,
+                                 int             app_id,
+                                 TRANSFER_SYNTAX source_syntax,
+                                 TRANSFER_SYNTAX dest_syntax )
+{
+    // The file object only contains the Group 2 attributes at this
+    // point, so write_file only writes the preamble and file meta
+    // information
+    MC_STATUS ret = file.set_transfer_syntax( dest_syntax );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_file( dest, file, app_id );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = transcode_values( source, source_syntax, dest, dest_syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+bool is_same_file( const string& lhs, const string& rhs )
+{
+    bool ret = lhs == rhs;
+
+    if( ret == false )
+    {
+        // Different paths can still name the same file. Inode numbers
+        // are 0 on platforms which don't have them
+        struct stat lhs_stat;
+        struct stat rhs_stat;
+        ret = stat( lhs.c_str(), &lhs_stat ) == 0 &&
+              stat( rhs.c_str(), &rhs_stat ) == 0 &&
+              lhs_stat.st_ino != 0 &&
+              lhs_stat.st_dev == rhs_stat.st_dev &&
+              lhs_stat.st_ino == rhs_stat.st_ino;
+    }
+    else
+    {
+        // Do nothing. Same path
+    }
+
+    return ret;
+}
+
+arena* create_file_arena()
+{
+    arena* ret = nullptr;
+
+    assert( g_context != nullptr );
+
+    int block_size = 0;
+    // Leave the default in place if the value is not configured
+    (void)g_context->get_int_config_value( ARENA_BLOCK_SIZE, block_size );
+    if( block_size > 0 )
+    {
+        ret = arena::create( static_cast<size_t>( block_size ) );
+    }
+    else
+    {
+        // Do nothing. Values are allocated from the heap
+    }
+
+    return ret;
+}
+
+}
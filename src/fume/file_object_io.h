@@ -25,6 +25,7 @@ namespace fume
 class tx_stream;
 class rx_stream;
 class file_object;
+class tag_filter;
 
 MC_STATUS write_file( file_object&      file,
                       int               app_id,
@@ -39,6 +40,16 @@ MC_STATUS write_file( file_object&      file,
 
 MC_STATUS write_file( tx_stream& stream, file_object& file, int app_id );
 
+// Writes the preamble and file meta information. The data set is
+// expected to follow
+MC_STATUS write_file_header( tx_stream& stream, file_object& file, int app_id );
+
+// Reads the preamble and file meta information, leaving the stream
+// positioned at the start of the data set
+MC_STATUS read_file_header( rx_stream&   stream,
+                            file_object& file,
+                            int          app_id );
+
 MC_STATUS open_file( file_object&     file,
                      int              app_id,
                      void*            user_info,
@@ -51,6 +62,51 @@ MC_STATUS open_file_upto( file_object&     file,
                           void*            user_info,
                           ReadFileCallback callback );
 
+// Opens the file, reading only the data set elements accepted by filter.
+// The file meta information is always read
+MC_STATUS open_file_filtered( file_object&      file,
+                              int               app_id,
+                              const tag_filter& filter,
+                              void*             user_info,
+                              ReadFileCallback  callback );
+
+// Opens the file as open_file does, but leaves large OB, OW and OD values
+// in the source file. Those values are copied directly from the source
+// when the file object is written. The user info and callback must
+// remain valid until the file object is freed
+MC_STATUS open_file_bulk_reference( file_object&     file,
+                                    int              app_id,
+                                    void*            user_info,
+                                    ReadFileCallback callback );
+
+// Reads the file meta information into the file object and reports the
+// elements of the data set to the event callback without storing them
+MC_STATUS parse_file( file_object&       file,
+                      int                app_id,
+                      void*              read_user_info,
+                      ReadFileCallback   read_callback,
+                      void*              event_user_info,
+                      ParseEventCallback event_callback );
+
+// Overwrites the value of tag in the file named by the file object with
+// the value held in the file object, without rewriting the rest of the
+// file. Only possible if the encoded element is the same size as the
+// one in the file. Returns MC_INVALID_LENGTH_FOR_VR if the size differs
+// and MC_NOT_FOUND if the element is not in the file. In both cases the
+// file has to be rewritten instead
+MC_STATUS patch_file_value( file_object& file, int app_id, uint32_t tag );
+
+// Reads the file meta information into the file object and copies the
+// data set to the destination in the given transfer syntax without
+// reading it into the file object
+MC_STATUS transcode_file( file_object&      file,
+                          int               app_id,
+                          TRANSFER_SYNTAX   syntax,
+                          void*             read_user_info,
+                          ReadFileCallback  read_callback,
+                          void*             write_user_info,
+                          WriteFileCallback write_callback );
+
 }
 
 #endif
@@ -173,6 +173,33 @@ static bool get_conditional_overlay_vr( data_dictionary& dict,
     return ret;
 }
 
+static bool get_conditional_pixel_representation_vr( data_dictionary& dict,
+                                                    MC_VR&           tag_vr )
+{
+    bool ret = false;
+
+    int pixel_representation = 0;
+    // Checked first as at() would add the attribute to an empty object
+    value_representation* vr =
+        dict.has_tag( MC_ATT_PIXEL_REPRESENTATION ) == true ?
+        dict.at( MC_ATT_PIXEL_REPRESENTATION ) :
+        nullptr;
+    if( vr != nullptr &&
+        vr->get( pixel_representation ) == MC_NORMAL_COMPLETION )
+    {
+        // SS if pixel data is signed; US otherwise
+        tag_vr = pixel_representation == 1 ? SS : US;
+        ret = true;
+    }
+    else
+    {
+        // Could not read value from dictionary. Use default VR
+        ret = false;
+    }
+
+    return ret;
+}
+
 bool get_conditional_tag_vr( uint32_t         tag,
                              data_dictionary& dict,
                              MC_VR&           tag_vr )
@@ -199,6 +226,10 @@ bool get_conditional_tag_vr( uint32_t         tag,
     {
         ret = get_conditional_overlay_vr( dict, tag_vr );
     }
+    else if( has_pixel_representation_vr( tag ) == true )
+    {
+        ret = get_conditional_pixel_representation_vr( dict, tag_vr );
+    }
     else
     {
         ret = false;
@@ -207,4 +238,39 @@ bool get_conditional_tag_vr( uint32_t         tag,
     return ret;
 }
 
+bool has_pixel_representation_vr( uint32_t tag )
+{
+    bool ret = false;
+
+    switch( tag )
+    {
+        case MC_ATT_ZERO_VELOCITY_PIXEL_VALUE:
+        case MC_ATT_MAPPED_PIXEL_VALUE:
+        case MC_ATT_PERIMETER_VALUE_RETIRED:
+        case MC_ATT_SMALLEST_VALID_PIXEL_VALUE_RETIRED:
+        case MC_ATT_LARGEST_VALID_PIXEL_VALUE_RETIRED:
+        case MC_ATT_SMALLEST_IMAGE_PIXEL_VALUE:
+        case MC_ATT_LARGEST_IMAGE_PIXEL_VALUE:
+        case MC_ATT_SMALLEST_PIXEL_VALUE_IN_SERIES:
+        case MC_ATT_LARGEST_PIXEL_VALUE_IN_SERIES:
+        case MC_ATT_SMALLEST_IMAGE_PIXEL_VALUE_IN_PLANE_RETIRED:
+        case MC_ATT_LARGEST_IMAGE_PIXEL_VALUE_IN_PLANE_RETIRED:
+        case MC_ATT_PIXEL_PADDING_VALUE:
+        case MC_ATT_PIXEL_PADDING_RANGE_LIMIT:
+        case MC_ATT_REAL_WORLD_VALUE_LAST_VALUE_MAPPED:
+        case MC_ATT_REAL_WORLD_VALUE_FIRST_VALUE_MAPPED:
+        case MC_ATT_HISTOGRAM_FIRST_BIN_VALUE:
+        case MC_ATT_HISTOGRAM_LAST_BIN_VALUE:
+            ret = true;
+            break;
+        default:
+            // Lookup table descriptors are also US or SS, but their first
+            // and third values are always unsigned
+            ret = false;
+            break;
+    }
+
+    return ret;
+}
+
 } // namespace fume
@@ -0,0 +1,225 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstdint>
+
+// local public
+#include "mcstatus.h"
+#include "diction.h"
+
+// local private
+#include "fume/implicit_vr_cache.h"
+#include "fume/library_context.h"
+#include "fume/value_representation.h"
+#include "fume/rx_stream.h"
+#include "fume/tag_to_vr.h"
+
+namespace fume
+{
+
+// Never read from a stream, so marks an unused entry
+static const uint32_t EMPTY_TAG = 0xFFFFFFFFu;
+
+static thread_local implicit_vr_cache* s_current_cache = nullptr;
+
+static bool is_group_length( uint32_t tag );
+static bool is_private_creator( uint32_t tag );
+
+implicit_vr_cache::implicit_vr_cache()
+    : m_pixel_representation( -1 )
+{
+    for( entry& cur : m_entries )
+    {
+        cur.tag = EMPTY_TAG;
+    }
+}
+
+implicit_vr_cache* implicit_vr_cache::current()
+{
+    return s_current_cache;
+}
+
+void implicit_vr_cache::set_current( implicit_vr_cache* value )
+{
+    s_current_cache = value;
+}
+
+void implicit_vr_cache::get_vr_info( uint32_t        tag,
+                                     MC_VR&          vr,
+                                     unsigned short& min_vals,
+                                     unsigned short& max_vals,
+                                     unsigned short& multiple )
+{
+    entry& cur = m_entries[entry_index( tag )];
+    if( cur.tag != tag )
+    {
+        load_entry( tag, cur );
+    }
+    else
+    {
+        // Do nothing. Already cached
+    }
+
+    if( cur.pixel_representation_vr == true && m_pixel_representation == 1 )
+    {
+        vr = SS;
+    }
+    else
+    {
+        vr = cur.vr;
+    }
+
+    min_vals = cur.min_vals;
+    max_vals = cur.max_vals;
+    multiple = cur.multiple;
+}
+
+MC_VR implicit_vr_cache::get_vr( uint32_t tag )
+{
+    MC_VR vr = UNKNOWN_VR;
+    unsigned short min_vals = 0;
+    unsigned short max_vals = 0;
+    unsigned short multiple = 0;
+    get_vr_info( tag, vr, min_vals, max_vals, multiple );
+
+    return vr;
+}
+
+void implicit_vr_cache::value_read( uint32_t tag, value_representation& value )
+{
+    if( tag == MC_ATT_PIXEL_REPRESENTATION )
+    {
+        int pixel_representation = 0;
+        if( value.get( pixel_representation ) == MC_NORMAL_COMPLETION )
+        {
+            m_pixel_representation = pixel_representation;
+        }
+        else
+        {
+            // Do nothing. Leave the previous value in place
+        }
+    }
+    else
+    {
+        // Do nothing. The VRs of later elements do not depend on it
+    }
+}
+
+void implicit_vr_cache::header_read( rx_stream& stream,
+                                     uint32_t   tag,
+                                     uint32_t   length )
+{
+    uint16_t pixel_representation = 0;
+    if( tag == MC_ATT_PIXEL_REPRESENTATION &&
+        length == sizeof(pixel_representation) &&
+        stream.peek_val( pixel_representation,
+                         IMPLICIT_LITTLE_ENDIAN ) == MC_NORMAL_COMPLETION )
+    {
+        m_pixel_representation = pixel_representation;
+    }
+    else
+    {
+        // Do nothing. The VRs of later elements do not depend on it
+    }
+}
+
+void implicit_vr_cache::load_entry( uint32_t tag, entry& value )
+{
+    assert( g_context != nullptr );
+
+    value.tag = tag;
+    value.pixel_representation_vr = false;
+
+    if( g_context->get_vr_info( tag,
+                                nullptr,
+                                value.vr,
+                                value.min_vals,
+                                value.max_vals,
+                                value.multiple ) == MC_NORMAL_COMPLETION )
+    {
+        value.pixel_representation_vr = has_pixel_representation_vr( tag );
+    }
+    else
+    {
+        // Group lengths and private creators are not in the dictionary
+        if( is_group_length( tag ) == true )
+        {
+            value.vr = UL;
+        }
+        else if( is_private_creator( tag ) == true )
+        {
+            value.vr = LO;
+        }
+        else
+        {
+            value.vr = UNKNOWN_VR;
+        }
+
+        value.min_vals = 1;
+        value.max_vals = 1;
+        value.multiple = 1;
+    }
+}
+
+implicit_vr_scope::implicit_vr_scope( implicit_vr_cache& cache )
+    : m_prev( implicit_vr_cache::current() ),
+      m_restore( false ),
+      m_pixel_representation( -1 )
+{
+    implicit_vr_cache::set_current( &cache );
+}
+
+implicit_vr_scope::implicit_vr_scope( TRANSFER_SYNTAX syntax )
+    : m_prev( implicit_vr_cache::current() ),
+      m_restore( m_prev != nullptr ),
+      m_pixel_representation( m_prev != nullptr ?
+                                  m_prev->pixel_representation() : -1 )
+{
+    if( m_prev == nullptr && syntax == IMPLICIT_LITTLE_ENDIAN )
+    {
+        m_local.reset( new implicit_vr_cache() );
+        implicit_vr_cache::set_current( m_local.get() );
+    }
+    else
+    {
+        // Do nothing. Explicit VR, or the enclosing cache is used
+    }
+}
+
+implicit_vr_scope::~implicit_vr_scope()
+{
+    if( m_restore == true )
+    {
+        m_prev->set_pixel_representation( m_pixel_representation );
+    }
+    else
+    {
+        // Do nothing. The cache is not shared with an enclosing scope
+    }
+
+    implicit_vr_cache::set_current( m_prev );
+}
+
+bool is_group_length( uint32_t tag )
+{
+    return (tag & 0x0000FFFFu) == 0;
+}
+
+bool is_private_creator( uint32_t tag )
+{
+    const uint32_t element = tag & 0x0000FFFFu;
+
+    return (tag & 0x00010000u) != 0 && element >= 0x0010u && element <= 0x00FFu;
+}
+
+}
@@ -0,0 +1,145 @@
+#ifndef IMPLICIT_VR_CACHE_H
+#define IMPLICIT_VR_CACHE_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// local public
+#include "mc3msg.h"
+
+// local private
+
+namespace fume
+{
+
+class value_representation;
+class rx_stream;
+
+// Resolves the VRs of the elements of an implicit VR stream for the
+// duration of a single parse. Recently used tags are kept in a small
+// direct-mapped table so the VRs of tags which repeat (eg. in every
+// item of a sequence) are not looked up again in the global dictionary.
+//
+// Tags whose VR is US or SS depending on Pixel Representation are
+// resolved using the last Pixel Representation value read, which is
+// recorded by value_read. Private and unknown tags are UN.
+//
+// A cache is made current on the calling thread by implicit_vr_scope,
+// so the reading of nested sequences uses the cache of the enclosing
+// parse
+class implicit_vr_cache final
+{
+public:
+    implicit_vr_cache();
+
+    static implicit_vr_cache* current();
+
+    void get_vr_info( uint32_t        tag,
+                      MC_VR&          vr,
+                      unsigned short& min_vals,
+                      unsigned short& max_vals,
+                      unsigned short& multiple );
+
+    MC_VR get_vr( uint32_t tag );
+
+    // Called with each element read so the elements which determine the
+    // VRs of later ones are noticed
+    void value_read( uint32_t tag, value_representation& value );
+
+    // As value_read, for elements whose value is skipped or copied
+    // without being decoded. The stream is positioned at the value
+    void header_read( rx_stream& stream, uint32_t tag, uint32_t length );
+
+    // Used to restore the Pixel Representation of the enclosing data
+    // set after reading an item. -1 if none has been read
+    int pixel_representation() const
+    {
+        return m_pixel_representation;
+    }
+
+    void set_pixel_representation( int value )
+    {
+        m_pixel_representation = value;
+    }
+
+private:
+    struct entry
+    {
+        uint32_t       tag;
+        MC_VR          vr;
+        unsigned short min_vals;
+        unsigned short max_vals;
+        unsigned short multiple;
+        bool           pixel_representation_vr;
+    };
+
+    static const unsigned int INDEX_BITS = 6u;
+    static const size_t NUM_ENTRIES = 1u << INDEX_BITS;
+
+    static size_t entry_index( uint32_t tag )
+    {
+        // Fibonacci hashing, so both the group and element numbers
+        // affect the index
+        return (tag * 2654435769u) >> (32u - INDEX_BITS);
+    }
+
+    static void load_entry( uint32_t tag, entry& value );
+
+private:
+    entry              m_entries[NUM_ENTRIES];
+    int                m_pixel_representation;
+
+private:
+    friend class implicit_vr_scope;
+
+    static void set_current( implicit_vr_cache* value );
+
+private:
+    implicit_vr_cache( const implicit_vr_cache& );
+    implicit_vr_cache& operator=( const implicit_vr_cache& );
+};
+
+// Makes an implicit_vr_cache current on the calling thread for the
+// lifetime of the scope
+class implicit_vr_scope final
+{
+public:
+    // Makes cache current. Used by readers which are resumed across
+    // calls, so keep their own cache
+    explicit implicit_vr_scope( implicit_vr_cache& cache );
+
+    // Makes a new cache current if syntax is implicit VR and there is no
+    // current cache, so explicit VR reads don't build one. A current
+    // cache is kept (ie. for a nested item) and has its Pixel
+    // Representation restored at the end of the scope, so an item does
+    // not change the VRs of the enclosing data set
+    explicit implicit_vr_scope( TRANSFER_SYNTAX syntax );
+
+    ~implicit_vr_scope();
+
+private:
+    std::unique_ptr<implicit_vr_cache> m_local;
+    implicit_vr_cache*                 m_prev;
+    bool                               m_restore;
+    int                                m_pixel_representation;
+
+private:
+    implicit_vr_scope( const implicit_vr_scope& );
+    implicit_vr_scope& operator=( const implicit_vr_scope& );
+};
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+// local private
+#include "fume/inflate_rx_stream.h"
+
+using std::deque;
+using std::copy;
+
+namespace fume
+{
+
+static const uint32_t INFLATE_CHUNK_SIZE = 16u * 1024u;
+// Negative window bits indicates a raw deflate stream with no zlib
+// header or trailer, as required by PS3.5 Annex A.5
+static const int DEFLATE_WINDOW_BITS = -15;
+
+inflate_rx_stream::inflate_rx_stream( rx_stream& source )
+    : m_source( source ),
+      m_in_buffer( INFLATE_CHUNK_SIZE ),
+      m_out_buffer( INFLATE_CHUNK_SIZE ),
+      m_bytes_read( 0 ),
+      m_initialized( false ),
+      m_last( false )
+{
+    memset( &m_zstream, 0, sizeof(m_zstream) );
+    m_zstream.zalloc = Z_NULL;
+    m_zstream.zfree = Z_NULL;
+    m_zstream.opaque = Z_NULL;
+    m_zstream.next_in = Z_NULL;
+    m_zstream.avail_in = 0;
+
+    m_initialized = inflateInit2( &m_zstream, DEFLATE_WINDOW_BITS ) == Z_OK;
+}
+
+inflate_rx_stream::~inflate_rx_stream()
+{
+    if( m_initialized == true )
+    {
+        (void)inflateEnd( &m_zstream );
+    }
+}
+
+MC_STATUS inflate_rx_stream::peek( void* buffer, uint32_t buffer_bytes )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( buffer != nullptr )
+    {
+        // Same return values as file_rx_stream::peek
+        ret = ensure_bytes_available( buffer_bytes );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            assert( m_data_buffer.size() >= buffer_bytes );
+            const deque<uint8_t>::const_iterator begin = m_data_buffer.begin();
+            const deque<uint8_t>::const_iterator end = begin + buffer_bytes;
+
+            copy( begin, end, static_cast<uint8_t*>( buffer ) );
+        }
+        else
+        {
+            // Do nothing. Will return status as indicated above
+        }
+    }
+    else
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+
+    return ret;
+}
+
+MC_STATUS inflate_rx_stream::read( void* buffer, uint32_t buffer_bytes )
+{
+    MC_STATUS ret = peek( buffer, buffer_bytes );
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        const deque<uint8_t>::const_iterator begin = m_data_buffer.begin();
+        const deque<uint8_t>::const_iterator end = begin + buffer_bytes;
+
+        m_data_buffer.erase( begin, end );
+        m_bytes_read += buffer_bytes;
+    }
+    else
+    {
+        // Do nothing. Return error
+    }
+
+    return ret;
+}
+
+MC_STATUS inflate_rx_stream::fill_input()
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    // Reads from the source stream are all or nothing. Reduce the
+    // requested size until whatever remains of the source is consumed
+    uint32_t request_bytes = static_cast<uint32_t>( m_in_buffer.size() );
+    ret = m_source.read( m_in_buffer.data(), request_bytes );
+    while( ret == MC_UNEXPECTED_EOD && request_bytes > 1u )
+    {
+        request_bytes /= 2u;
+        ret = m_source.read( m_in_buffer.data(), request_bytes );
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        m_zstream.next_in = m_in_buffer.data();
+        m_zstream.avail_in = request_bytes;
+    }
+    else
+    {
+        // Do nothing. Will return error (including MC_END_OF_DATA)
+    }
+
+    return ret;
+}
+
+MC_STATUS inflate_rx_stream::ensure_bytes_available( uint32_t min_bytes_available )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    if( m_initialized == false )
+    {
+        ret = MC_ZLIB_ERROR;
+    }
+    else
+    {
+        while( ret == MC_NORMAL_COMPLETION &&
+               m_last == false             &&
+               m_data_buffer.size() < min_bytes_available )
+        {
+            if( m_zstream.avail_in == 0u )
+            {
+                ret = fill_input();
+            }
+            else
+            {
+                // Do nothing. Still have compressed data to process
+            }
+
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                m_zstream.next_out = m_out_buffer.data();
+                m_zstream.avail_out = static_cast<uInt>( m_out_buffer.size() );
+
+                const int zret = inflate( &m_zstream, Z_NO_FLUSH );
+                if( zret == Z_OK || zret == Z_STREAM_END || zret == Z_BUF_ERROR )
+                {
+                    const size_t produced = m_out_buffer.size() -
+                                            m_zstream.avail_out;
+                    m_data_buffer.insert( m_data_buffer.cend(),
+                                          m_out_buffer.cbegin(),
+                                          m_out_buffer.cbegin() + produced );
+                    m_last = zret == Z_STREAM_END;
+                }
+                else
+                {
+                    ret = MC_ZLIB_ERROR;
+                }
+            }
+            else if( ret == MC_END_OF_DATA )
+            {
+                // Source is exhausted. Treat whatever has been inflated
+                // so far as the end of the data set
+                m_last = true;
+                ret = MC_NORMAL_COMPLETION;
+            }
+            else
+            {
+                // Do nothing. Will return error from source stream
+            }
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            if( m_data_buffer.size() >= min_bytes_available )
+            {
+                ret = MC_NORMAL_COMPLETION;
+            }
+            else if( m_data_buffer.empty() == true )
+            {
+                ret = MC_END_OF_DATA;
+            }
+            else
+            {
+                ret = MC_UNEXPECTED_EOD;
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret;
+}
+
+}
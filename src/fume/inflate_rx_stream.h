@@ -0,0 +1,72 @@
+#ifndef INFLATE_RX_STREAM_H
+#define INFLATE_RX_STREAM_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// zlib
+#include <zlib.h>
+
+// local public
+#include "mcstatus.h"
+
+// local private
+#include "fume/rx_stream.h"
+
+namespace fume
+{
+
+// Presents the raw deflate (RFC 1951) data read from the source stream
+// as a stream of uncompressed bytes. Data is inflated on demand, so only
+// a small window of the uncompressed data is held in memory at any time
+class inflate_rx_stream final : public rx_stream
+{
+public:
+    // Note: the source stream must have a lifetime exceeding that
+    // of this object
+    inflate_rx_stream( rx_stream& source );
+    ~inflate_rx_stream();
+
+// rx_stream
+public:
+    virtual MC_STATUS read( void* buffer, uint32_t buffer_bytes ) override final;
+    virtual MC_STATUS peek( void* buffer, uint32_t buffer_bytes ) override final;
+
+    virtual uint64_t tell_read() const override final
+    {
+        return m_bytes_read;
+    }
+
+private:
+    inflate_rx_stream( const inflate_rx_stream& );
+    inflate_rx_stream& operator=( const inflate_rx_stream& );
+
+    MC_STATUS ensure_bytes_available( uint32_t min_bytes_available );
+    MC_STATUS fill_input();
+
+private:
+    rx_stream&           m_source;
+    z_stream             m_zstream;
+    std::vector<uint8_t> m_in_buffer;
+    std::vector<uint8_t> m_out_buffer;
+    std::deque<uint8_t>  m_data_buffer;
+    uint64_t             m_bytes_read;
+    bool                 m_initialized;
+    bool                 m_last;
+};
+
+}
+
+#endif
@@ -86,7 +86,7 @@ MC_STATUS item_object::to_stream( tx_stream&      stream,
         ret = write_item_size( stream, syntax );
         if( ret == MC_NORMAL_COMPLETION )
         {
-            ret = write_values( stream, syntax, *this, 0x00000000u, 0xFFFFFFFFu );
+            ret = write_item_values( stream, syntax );
             if( ret == MC_NORMAL_COMPLETION )
             {
                 ret = write_item_delimitation( stream, syntax );
@@ -109,4 +109,10 @@ MC_STATUS item_object::to_stream( tx_stream&      stream,
     return ret;
 }
 
+MC_STATUS item_object::write_item_values( tx_stream&      stream,
+                                          TRANSFER_SYNTAX syntax )
+{
+    return write_values( stream, syntax, *this, 0x00000000u, 0xFFFFFFFFu );
+}
+
 }
@@ -13,6 +13,7 @@
 
 // std
 #include <string>
+#include <memory>
 
 // local public
 #include "mcstatus.h"
@@ -40,6 +41,12 @@ public:
         return clear();
     }
 
+    // Prepares an item taken from the object pool for reuse
+    void reset( int id )
+    {
+        data_dictionary::reset( id );
+    }
+
     virtual MC_STATUS set_transfer_syntax( TRANSFER_SYNTAX syntax ) override final
     {
         return MC_INVALID_MESSAGE_ID;
@@ -55,8 +62,15 @@ public:
                                  TRANSFER_SYNTAX syntax ) override;
     virtual MC_STATUS from_stream( rx_stream&      stream,
                                    TRANSFER_SYNTAX syntax ) override;
+
+protected:
+    // Writes the values between the item header and the item delimiter
+    virtual MC_STATUS write_item_values( tx_stream&      stream,
+                                         TRANSFER_SYNTAX syntax );
 };
 
+typedef std::unique_ptr<item_object> item_object_ptr;
+
 }
 
 
@@ -16,6 +16,9 @@
 #include <memory>
 #include <algorithm>
 #include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
 // local public
 #include "mc3msg.h"
@@ -29,6 +32,8 @@
 #include "fume/record_object.h"
 #include "fume/vr_factory.h"
 #include "fume/value_representation.h"
+#include "fume/file_cursor.h"
+#include "fume/arena.h"
 
 using std::numeric_limits;
 using std::unordered_map;
@@ -39,19 +44,32 @@ using std::all_of;
 using std::pair;
 using std::string;
 using std::default_random_engine;
+using std::move;
+using std::vector;
 
 namespace fume
 {
 
+// Used if OBJECT_POOL_SIZE is not configured
+static const int DEFAULT_POOL_SIZE = 64;
+
 unique_ptr<library_context> g_context;
 
 library_context::library_context()
-      // Generate IDs greater than 0
-    : m_tag_vr_dict( create_default_tag_vr_dict() ),
+    : m_data_dictionaries( 0,
+                           data_dictionary_map::hasher(),
+                           data_dictionary_map::key_equal(),
+                           data_dictionary_map::allocator_type( m_dictionary_nodes ) ),
+      m_tag_vr_dict( create_default_tag_vr_dict() ),
       m_config_maps( create_config_maps() ),
       m_rng( static_cast<default_random_engine::result_type>( clock() ) ),
+      // Generate IDs greater than 0
       m_id_gen( 1, numeric_limits<int>::max() )
 {
+    int pool_size = DEFAULT_POOL_SIZE;
+    // Leave the default in place if the value is not configured
+    (void)get_int_config_value( OBJECT_POOL_SIZE, pool_size );
+    set_pool_capacity( pool_size );
 }
 
 library_context::~library_context()
@@ -91,8 +109,16 @@ int library_context::create_empty_file_object( const char* filename )
         // generate_id shall maintain uniqueness, but assert here
         assert( m_data_dictionaries.count( id ) == 0 );
 
-        // Create empty file object
-        data_dictionary_ptr file_obj( new file_object( id, filename, true ) );
+        // Create empty file object, reusing a freed one if possible
+        data_dictionary_ptr file_obj( m_pool.take( dictionary_pool::FILE_OBJECT ) );
+        if( file_obj != nullptr )
+        {
+            static_cast<file_object&>( *file_obj ).reset( id, filename );
+        }
+        else
+        {
+            file_obj.reset( new file_object( id, filename, true ) );
+        }
 
         // TODO: initialize file object dictionary based on service name/command
 
@@ -149,7 +175,13 @@ int library_context::create_dicomdir_object( const char*        filename,
 
 MC_STATUS library_context::free_file_object( int id )
 {
-    return free_dictionary_object<file_object>( id, MC_INVALID_FILE_ID );
+    data_dictionary_ptr removed;
+    const MC_STATUS ret = remove_dictionary_object<file_object>( id,
+                                                                 MC_INVALID_FILE_ID,
+                                                                 removed );
+    recycle_object( move( removed ) );
+
+    return ret;
 }
 
 int library_context::create_empty_item_object()
@@ -163,9 +195,17 @@ int library_context::create_empty_item_object()
     // generate_id shall maintain uniqueness, but assert here
     assert( m_data_dictionaries.count( id ) == 0 );
 
-    // Create file object out of lock scope
+    // Create empty item object, reusing a freed one if possible
     // TODO: don't create empty
-    data_dictionary_ptr item_obj( new item_object( id, true ) );
+    data_dictionary_ptr item_obj( m_pool.take( dictionary_pool::ITEM_OBJECT ) );
+    if( item_obj != nullptr )
+    {
+        static_cast<item_object&>( *item_obj ).reset( id );
+    }
+    else
+    {
+        item_obj.reset( new item_object( id, true ) );
+    }
 
     // TODO: initialize item object dictionary based on item name
 
@@ -202,13 +242,24 @@ int library_context::create_record_object( int         file_id,
         // generate_id shall maintain uniqueness, but assert here
         assert( m_data_dictionaries.count( id ) == 0 );
 
-        // Create empty record object
+        // Create empty record object, reusing a freed one if possible
         // TODO: figure out how to populate with record type
-        data_dictionary_ptr item_obj( new record_object( file_id, 
-                                                         parent_id,
-                                                         id,
-                                                         record_type,
-                                                         true ) );
+        data_dictionary_ptr item_obj( m_pool.take( dictionary_pool::RECORD_OBJECT ) );
+        if( item_obj != nullptr )
+        {
+            static_cast<record_object&>( *item_obj ).reset( file_id,
+                                                            parent_id,
+                                                            id,
+                                                            record_type );
+        }
+        else
+        {
+            item_obj.reset( new record_object( file_id,
+                                               parent_id,
+                                               id,
+                                               record_type,
+                                               true ) );
+        }
 
         // TODO: initialize item object dictionary based on service name/command
 
@@ -229,15 +280,200 @@ int library_context::create_record_object( int         file_id,
 
 MC_STATUS library_context::free_item_object( int id )
 {
-    return free_dictionary_object<item_object>( id, MC_INVALID_ITEM_ID );
+    data_dictionary_ptr removed;
+    MC_STATUS ret = remove_dictionary_object<item_object>( id,
+                                                           MC_INVALID_ITEM_ID,
+                                                           removed );
+    recycle_object( move( removed ) );
+
+    if( ret == MC_INVALID_ITEM_ID )
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // An item owned by a sequence stays in the sequence. Only its
+        // ID is released
+        item_handle_map::iterator itr( m_item_handles.find( id ) );
+        if( itr != m_item_handles.end() )
+        {
+            itr->second->set_id( 0 );
+            m_item_handles.erase( itr );
+            ret = MC_NORMAL_COMPLETION;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Item was freed or an error will be returned
+    }
+
+    return ret;
 }
 
 data_dictionary* library_context::get_object( int id )
+{
+    // Done without holding the lock. Reading values looks up VRs and
+    // applications through the context
+    data_dictionary* ret = find_object( id );
+    if( ret != nullptr && ret->load_values() != MC_NORMAL_COMPLETION )
+    {
+        ret = nullptr;
+    }
+    else if( ret != nullptr )
+    {
+        ret->values_may_change();
+    }
+    else
+    {
+        // Do nothing. There is no object
+    }
+
+    return ret;
+}
+
+data_dictionary* library_context::find_object( int id )
 {
     lock_guard<mutex> lock(m_mutex);
 
+    data_dictionary* ret = nullptr;
+
     data_dictionary_map::const_iterator itr( m_data_dictionaries.find( id ) );
-    return itr == m_data_dictionaries.cend() ? nullptr : itr->second.get();
+    if( itr != m_data_dictionaries.cend() )
+    {
+        ret = itr->second.get();
+    }
+    else
+    {
+        item_handle_map::const_iterator handle_itr( m_item_handles.find( id ) );
+        ret = handle_itr == m_item_handles.cend() ? nullptr : handle_itr->second;
+    }
+
+    return ret;
+}
+
+int library_context::create_item_handle( item_object& item )
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    int ret = item.id();
+    if( ret <= 0 )
+    {
+        const int id = generate_id();
+        // generate_id shall maintain uniqueness, but assert here
+        assert( m_item_handles.count( id ) == 0 );
+
+        m_item_handles[id] = &item;
+        item.set_id( id );
+
+        ret = id;
+    }
+    else
+    {
+        // Do nothing. Item already has an ID
+    }
+
+    return ret;
+}
+
+void library_context::release_item_handle( item_object& item )
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    if( item.id() > 0 )
+    {
+        m_item_handles.erase( item.id() );
+        item.set_id( 0 );
+    }
+    else
+    {
+        // Do nothing. Item has no ID
+    }
+}
+
+bool library_context::is_item_handle( int id ) const
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    return m_item_handles.count( id ) > 0;
+}
+
+unique_ptr<item_object> library_context::adopt_item_object( int id )
+{
+    unique_ptr<item_object> ret;
+
+    lock_guard<mutex> lock(m_mutex);
+
+    data_dictionary_map::iterator itr( m_data_dictionaries.find( id ) );
+    if( itr != m_data_dictionaries.end() )
+    {
+        item_object* item = dynamic_cast<item_object*>( itr->second.get() );
+        if( item != nullptr )
+        {
+            // Insert the handle first. If that throws the item is still
+            // owned by the map
+            m_item_handles[id] = item;
+
+            ret.reset( item );
+            (void)itr->second.release();
+            m_data_dictionaries.erase( itr );
+        }
+        else
+        {
+            // Do nothing. Not an item. Will return NULL
+        }
+    }
+    else
+    {
+        // Do nothing. Not owned by the context. Will return NULL
+    }
+
+    return ret;
+}
+
+void library_context::return_item_object( unique_ptr<item_object> item )
+{
+    if( item != nullptr && item->id() > 0 )
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        const int id = item->id();
+        m_data_dictionaries[id].reset( item.release() );
+        m_item_handles.erase( id );
+    }
+    else
+    {
+        // Do nothing. Nothing can refer to the item, so it is destroyed
+        // here, outside of the lock
+    }
+}
+
+void library_context::free_items( vector<unique_ptr<item_object>>& items )
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        for( const unique_ptr<item_object>& item : items )
+        {
+            if( item != nullptr && item->id() > 0 )
+            {
+                m_item_handles.erase( item->id() );
+                item->set_id( 0 );
+            }
+            else
+            {
+                // Do nothing. Item has no ID
+            }
+        }
+    }
+
+    for( unique_ptr<item_object>& item : items )
+    {
+        recycle_object( move( item ) );
+    }
+
+    items.clear();
 }
 
 unique_ptr<value_representation>
@@ -335,6 +571,65 @@ MC_STATUS library_context::get_string_config_value( StringParm          parm,
     return ret;
 }
 
+MC_STATUS library_context::get_int_config_value( IntParm parm,
+                                                 int&    value ) const
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    lock_guard<mutex> lock( m_config_mutex );
+    int_parm_map_t::const_iterator itr = m_config_maps.ints.find( parm );
+    if( itr != m_config_maps.ints.cend() )
+    {
+        value = itr->second;
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = MC_INVALID_PARAMETER_NAME;
+    }
+
+    return ret;
+}
+
+MC_STATUS library_context::set_int_config_value( IntParm parm, int value )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    {
+        lock_guard<mutex> lock( m_config_mutex );
+        int_parm_map_t::iterator itr = m_config_maps.ints.find( parm );
+        if( itr != m_config_maps.ints.end() )
+        {
+            itr->second = value;
+            ret = MC_NORMAL_COMPLETION;
+        }
+        else
+        {
+            ret = MC_INVALID_PARAMETER_NAME;
+        }
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && parm == OBJECT_POOL_SIZE )
+    {
+        lock_guard<mutex> lock( m_mutex );
+        set_pool_capacity( value );
+    }
+    else
+    {
+        // Do nothing. Value is read when it is used
+    }
+
+    return ret;
+}
+
+void library_context::set_pool_capacity( int pool_size )
+{
+    const size_t capacity = pool_size > 0 ? static_cast<size_t>( pool_size ) : 0u;
+    m_pool.set_capacity( capacity );
+    // Enough map nodes for every pooled object to be created again
+    m_dictionary_nodes.set_capacity( capacity * dictionary_pool::NUM_OBJECT_KINDS );
+}
+
 int library_context::register_application( const char* ae_title )
 {
     // NOTE: error codes from this function are NEGATIVE because the
@@ -416,6 +711,124 @@ application* library_context::get_application( int id )
     return itr == m_applications.cend() ? nullptr : itr->second.get();
 }
 
+int library_context::create_cursor( unique_ptr<file_cursor> cursor )
+{
+    // NOTE: error codes from this function are NEGATIVE because the
+    // positive values indicate cursor IDs returned
+    int ret = -MC_CANNOT_COMPLY;
+
+    if( cursor != nullptr )
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        const int id = generate_id();
+        // generate_id shall maintain uniqueness, but assert here
+        assert( m_cursors.count( id ) == 0 );
+
+        m_cursors[id].swap( cursor );
+
+        ret = id;
+    }
+    else
+    {
+        ret = -MC_NULL_POINTER_PARM;
+    }
+
+    return ret;
+}
+
+MC_STATUS library_context::free_cursor( int id )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    // Delete cursor outside of lock scope for consistency with
+    // the other freeing logic
+    file_cursor_ptr to_free = nullptr;
+
+    lock_guard<mutex> lock(m_mutex);
+
+    file_cursor_map::iterator itr( m_cursors.find( id ) );
+    if( itr != m_cursors.end() )
+    {
+        to_free.swap( itr->second );
+
+        m_cursors.erase( itr );
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = MC_INVALID_FILE_ID;
+    }
+
+    return ret;
+}
+
+file_cursor* library_context::get_cursor( int id )
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    file_cursor_map::const_iterator itr( m_cursors.find( id ) );
+    return itr == m_cursors.cend() ? nullptr : itr->second.get();
+}
+
+void library_context::get_pool_statistics( POOL_STATS& stats ) const
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    m_pool.get_statistics( stats );
+}
+
+void library_context::recycle_object( data_dictionary_ptr obj )
+{
+    if( obj != nullptr )
+    {
+        // Only exact types are pooled, since the object is reused as
+        // that type. Objects read into a file arena are not pooled so
+        // the pool doesn't keep the arena alive
+        const std::type_info& type = typeid( *obj );
+        dictionary_pool::object_kind kind = dictionary_pool::NUM_OBJECT_KINDS;
+        if( arena::from_arena( dynamic_cast<void*>( obj.get() ) ) == true )
+        {
+            // Do nothing. Will be destroyed
+        }
+        else if( type == typeid( file_object ) )
+        {
+            static_cast<file_object&>( *obj ).empty_file();
+            kind = dictionary_pool::FILE_OBJECT;
+        }
+        else if( type == typeid( item_object ) )
+        {
+            static_cast<item_object&>( *obj ).empty_item();
+            kind = dictionary_pool::ITEM_OBJECT;
+        }
+        else if( type == typeid( record_object ) )
+        {
+            static_cast<record_object&>( *obj ).empty_record();
+            kind = dictionary_pool::RECORD_OBJECT;
+        }
+        else
+        {
+            // Do nothing. Will be destroyed
+        }
+
+        // obj is destroyed after the lock is released if the pool
+        // does not take it
+        lock_guard<mutex> lock(m_mutex);
+        if( kind != dictionary_pool::NUM_OBJECT_KINDS )
+        {
+            m_pool.put( kind, obj );
+        }
+        else
+        {
+            m_pool.discard();
+        }
+    }
+    else
+    {
+        // Do nothing. Nothing was freed
+    }
+}
+
 int library_context::generate_id()
 {
     // This function must only be called by a function which performs
@@ -427,7 +840,9 @@ int library_context::generate_id()
         ret = m_id_gen( m_rng );
     }
     while( m_data_dictionaries.count( ret ) != 0 ||
-           m_applications.count( ret )      != 0 );
+           m_applications.count( ret )      != 0 ||
+           m_cursors.count( ret )           != 0 ||
+           m_item_handles.count( ret )      != 0 );
 
     return ret;
 }
@@ -17,6 +17,9 @@
 #include <random>
 #include <memory>
 #include <string>
+#include <functional>
+#include <utility>
+#include <vector>
 
 // boost
 #include "boost/bimap.hpp"
@@ -29,14 +32,18 @@
 // local private
 #include "fume/tag_to_vr.h"
 #include "fume/configuration_maps.h"
+#include "fume/dictionary_pool.h"
+#include "fume/node_cache.h"
 
 namespace fume
 {
 
 class data_dictionary;
 class file_object;
+class item_object;
 class application;
 class value_representation;
+class file_cursor;
 
 class library_context
 {
@@ -63,7 +70,33 @@ public:
                               const char* record_type );
     MC_STATUS free_record_object( int id );
 
+    // Reads any deferred values of the object before returning it, and
+    // tells it that its values may be changed. Returns NULL if they
+    // can't be read
     data_dictionary* get_object( int id );
+    // As get_object, but deferred values are left unread. For code which
+    // only follows the links between directory records
+    data_dictionary* find_object( int id );
+
+    // Items owned by a sequence are only given an ID when the ID is
+    // requested. The context keeps a non-owning handle to the item
+    // until the sequence releases it. Returns the new ID, or a
+    // negative error code
+    int create_item_handle( item_object& item );
+    void release_item_handle( item_object& item );
+    // True if id is the handle of an item owned by a sequence
+    bool is_item_handle( int id ) const;
+
+    // Transfers an item created by create_item_object to a sequence.
+    // The item keeps its ID. Returns NULL if id is not an item owned
+    // by the context
+    std::unique_ptr<item_object> adopt_item_object( int id );
+    // Returns an item removed from a sequence to the context if it has
+    // an ID, so the ID stays valid. Otherwise the item is destroyed
+    void return_item_object( std::unique_ptr<item_object> item );
+    // Frees items removed from a sequence, releasing all of their IDs
+    // under one lock. items is left empty
+    void free_items( std::vector<std::unique_ptr<item_object>>& items );
     // create_vr can optionally take in a data_dictionary object for
     // dictionary-specific VR specializations (eg. pixel data)
 
@@ -85,6 +118,13 @@ public:
     MC_STATUS get_string_config_value( StringParm          parm,
                                        const std::string*& value ) const;
 
+    MC_STATUS get_int_config_value( IntParm parm, int& value ) const;
+
+    // Replaces the value of a configured int parameter. Takes effect the
+    // next time the value is used, except OBJECT_POOL_SIZE which resizes
+    // the object pool immediately
+    MC_STATUS set_int_config_value( IntParm parm, int value );
+
 public:
 
     int register_application( const char* ae_title );
@@ -92,53 +132,84 @@ public:
 
     application* get_application( int id );
 
+    int create_cursor( std::unique_ptr<file_cursor> cursor );
+    MC_STATUS free_cursor( int id );
+
+    file_cursor* get_cursor( int id );
+
+    void get_pool_statistics( POOL_STATS& stats ) const;
+
 private:
     typedef std::unique_ptr<data_dictionary> data_dictionary_ptr;
     typedef std::unique_ptr<application> application_ptr;
-    typedef std::unordered_map<int, data_dictionary_ptr> data_dictionary_map;
+    typedef std::unique_ptr<file_cursor> file_cursor_ptr;
+    // Map nodes are cached along with the pooled objects, so creating
+    // and freeing objects does not allocate once the pool is warm
+    typedef std::unordered_map<int,
+                               data_dictionary_ptr,
+                               std::hash<int>,
+                               std::equal_to<int>,
+                               node_cache_allocator<std::pair<const int,
+                                                              data_dictionary_ptr>>> data_dictionary_map;
     typedef std::unordered_map<int, application_ptr> application_map;
+    typedef std::unordered_map<int, file_cursor_ptr> file_cursor_map;
+    typedef std::unordered_map<int, item_object*> item_handle_map;
 
 private:
     int generate_id();
 
+    // Sets the number of objects of each kind kept by the pool
+    void set_pool_capacity( int pool_size );
+
+    // Removes the object from the map, leaving it in removed so it can
+    // be destroyed or recycled without holding the lock
     template<class Derived>
-    MC_STATUS free_dictionary_object( int id, MC_STATUS invalid_id_stat );
+    MC_STATUS remove_dictionary_object( int                  id,
+                                        MC_STATUS            invalid_id_stat,
+                                        data_dictionary_ptr& removed );
+
+    // Empties a freed object and returns it to the pool, or destroys it
+    // if it can't be reused. Must be called without holding the lock
+    void recycle_object( data_dictionary_ptr obj );
 
 private:
+    node_cache                         m_dictionary_nodes;
     data_dictionary_map                m_data_dictionaries;
     application_map                    m_applications;
+    file_cursor_map                    m_cursors;
+    item_handle_map                    m_item_handles;
     const tag_to_vr_map                m_tag_vr_dict;
     config_maps                        m_config_maps;
     std::default_random_engine         m_rng;
     std::uniform_int_distribution<int> m_id_gen;
+    dictionary_pool                    m_pool;
 
     mutable std::mutex                 m_mutex;
+    // Int values can be changed while other threads read them. Separate
+    // from m_mutex so reading a value never waits on object creation
+    mutable std::mutex                 m_config_mutex;
 };
 
 template<class Derived>
-MC_STATUS library_context::free_dictionary_object( int       id,
-                                                   MC_STATUS invalid_id_stat )
+MC_STATUS library_context::remove_dictionary_object( int                  id,
+                                                     MC_STATUS            invalid_id_stat,
+                                                     data_dictionary_ptr& removed )
 {
     MC_STATUS ret = MC_CANNOT_COMPLY;
 
-    // Declare above lock_guard so destructor
-    // runs with library_context unlocked. Need
-    // to do this so data_dictionary elements
-    // containing sequence items don't deadlock
-    data_dictionary_ptr to_free = nullptr;
-
     std::lock_guard<std::mutex> lock(m_mutex);
 
     data_dictionary_map::iterator itr( m_data_dictionaries.find( id ) );
     if( itr != m_data_dictionaries.end() &&
         dynamic_cast<Derived*>( itr->second.get() ) != nullptr )
     {
-        // Delete data_dictionary object after mutating
-        // map. data_dictionary elements can contain
-        // data_dictionary elements (SQ VR), so calling
-        // map::erase can be indirectly called from within
-        // map::erase, which is discomforting
-        to_free.swap( itr->second );
+        // The caller deletes or empties the data_dictionary
+        // object after the lock is released. data_dictionary
+        // elements can contain data_dictionary elements (SQ VR),
+        // so calling map::erase can be indirectly called from
+        // within map::erase, which is discomforting, and freeing
+        // sequence items would deadlock
+        removed.swap( itr->second );
 
         // Now erasing the element won't call the data_dictionary
         // destructor
@@ -11,6 +11,7 @@
 
 // std
 #include <algorithm>
+#include <memory>
 
 // local public
 
@@ -21,6 +22,7 @@ using std::deque;
 using std::copy;
 using std::min;
 using std::max;
+using std::make_shared;
 
 namespace fume
 {
@@ -28,11 +30,12 @@ namespace fume
 MC_STATUS memory_stream::write( const void* buffer,
                                 uint32_t    buffer_bytes )
 {
+    deque<uint8_t>& data = unshared_data();
     const uint64_t new_size = max( m_offset + buffer_bytes,
-                                  static_cast<uint64_t>( m_data.size() ) );
-    m_data.resize( new_size );
+                                  static_cast<uint64_t>( data.size() ) );
+    data.resize( new_size );
 
-    const deque<uint8_t>::iterator dst_begin = m_data.begin() + m_offset;
+    const deque<uint8_t>::iterator dst_begin = data.begin() + m_offset;
 
     const uint8_t* src_begin = static_cast<const uint8_t*>( buffer );
     const uint8_t* src_end = src_begin + buffer_bytes;
@@ -47,16 +50,17 @@ MC_STATUS memory_stream::peek( void* buffer, uint32_t buffer_bytes )
 {
     MC_STATUS ret = MC_CANNOT_COMPLY;
 
+    const deque<uint8_t>& data = *m_data;
     const uint64_t new_offset = m_offset + buffer_bytes;
-    if( m_offset < m_data.size() && new_offset <= m_data.size() )
+    if( m_offset < data.size() && new_offset <= data.size() )
     {
-        const deque<uint8_t>::const_iterator begin = m_data.cbegin() + m_offset;
+        const deque<uint8_t>::const_iterator begin = data.cbegin() + m_offset;
         const deque<uint8_t>::const_iterator end = begin + buffer_bytes;
 
         copy( begin, end, static_cast<uint8_t*>( buffer ) );
         ret = MC_NORMAL_COMPLETION;
     }
-    else if( m_offset == m_data.size() )
+    else if( m_offset == data.size() )
     {
         ret = MC_END_OF_DATA;
     }
@@ -87,7 +91,15 @@ MC_STATUS memory_stream::read( void* buffer, uint32_t buffer_bytes )
 
 MC_STATUS memory_stream::clear()
 {
-    m_data.clear();
+    if( m_data.use_count() > 1 )
+    {
+        // Leave the data to the streams sharing it
+        m_data = make_shared<deque<uint8_t>>();
+    }
+    else
+    {
+        m_data->clear();
+    }
     m_offset = 0;
 
     return MC_NORMAL_COMPLETION;
@@ -101,4 +113,18 @@ MC_STATUS memory_stream::seek( uint64_t pos )
     return MC_NORMAL_COMPLETION;
 }
 
-}
\ No newline at end of file
+deque<uint8_t>& memory_stream::unshared_data()
+{
+    if( m_data.use_count() > 1 )
+    {
+        m_data = make_shared<deque<uint8_t>>( *m_data );
+    }
+    else
+    {
+        // Do nothing. Data is not shared
+    }
+
+    return *m_data;
+}
+
+}
@@ -24,11 +24,17 @@
 namespace fume
 {
 
+// Copies of a memory_stream share the stored data until one of them is
+// written to or cleared. Each copy has its own read/write offset, so the
+// copies can be read independently. Sharing is detected with
+// shared_ptr::use_count(), so copies must not be written to or freed
+// concurrently
 class memory_stream final : public seekable_stream
 {
 public:
     memory_stream()
-        : m_offset( 0 )
+        : m_data( std::make_shared<std::deque<uint8_t>>() ),
+          m_offset( 0 )
     {
     }
 
@@ -61,7 +67,7 @@ public:
 
     virtual uint64_t size() const override final
     {
-        return m_data.size();
+        return m_data->size();
     }
 
     virtual std::unique_ptr<seekable_stream> clone() override
@@ -70,7 +76,12 @@ public:
     }
 
 private:
-    std::deque<uint8_t> m_data;
+    // Returns data which is not shared with any other stream, copying it
+    // if necessary
+    std::deque<uint8_t>& unshared_data();
+
+private:
+    std::shared_ptr<std::deque<uint8_t>> m_data;
     uint64_t m_offset = 0;
 };
 
@@ -0,0 +1,215 @@
+#ifndef NODE_CACHE_H
+#define NODE_CACHE_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// local public
+
+// local private
+
+namespace fume
+{
+
+// Keeps freed single-node allocations of a node-based container so they
+// can be handed back on the next insert. A separate free list is kept for
+// each size allocated one at a time, which is sizeof the node type the
+// container's allocator is rebound to. Arrays (eg. buckets) go straight
+// to the heap.
+//
+// The cache does no locking of its own. It must be guarded by the same
+// lock as the container using it
+class node_cache final
+{
+public:
+    node_cache()
+        : m_capacity( 0 )
+    {
+    }
+
+    ~node_cache()
+    {
+        for( free_list& list : m_free_lists )
+        {
+            for( void* node : list.nodes )
+            {
+                ::operator delete( node );
+            }
+        }
+    }
+
+    void set_capacity( size_t capacity )
+    {
+        for( free_list& list : m_free_lists )
+        {
+            while( list.nodes.size() > capacity )
+            {
+                ::operator delete( list.nodes.back() );
+                list.nodes.pop_back();
+            }
+
+            list.nodes.reserve( capacity );
+        }
+
+        m_capacity = capacity;
+    }
+
+    void* allocate( size_t size, size_t count )
+    {
+        void* ret = nullptr;
+
+        free_list* const list = count == 1u ? get_free_list( size ) : nullptr;
+        if( list != nullptr && list->nodes.empty() == false )
+        {
+            ret = list->nodes.back();
+            list->nodes.pop_back();
+        }
+        else
+        {
+            ret = ::operator new( size * count );
+        }
+
+        return ret;
+    }
+
+    void deallocate( void* ptr, size_t size, size_t count )
+    {
+        free_list* const list = count == 1u ? find_free_list( size ) : nullptr;
+        if( list != nullptr && list->nodes.size() < m_capacity )
+        {
+            // Storage was reserved up front, so this does not allocate
+            list->nodes.push_back( ptr );
+        }
+        else
+        {
+            ::operator delete( ptr );
+        }
+    }
+
+private:
+    struct free_list
+    {
+        size_t             size;
+        std::vector<void*> nodes;
+    };
+
+private:
+    free_list* find_free_list( size_t size )
+    {
+        free_list* ret = nullptr;
+
+        // Only a handful of node types share a cache, so a linear search
+        // is enough
+        for( free_list& list : m_free_lists )
+        {
+            if( list.size == size )
+            {
+                ret = &list;
+                break;
+            }
+            else
+            {
+                // Do nothing. Keep looking
+            }
+        }
+
+        return ret;
+    }
+
+    // Adds an empty list for size the first time it is allocated, so a
+    // later deallocate always finds one
+    free_list* get_free_list( size_t size )
+    {
+        free_list* ret = find_free_list( size );
+        if( ret == nullptr )
+        {
+            free_list list;
+            list.size = size;
+            list.nodes.reserve( m_capacity );
+            m_free_lists.push_back( std::move( list ) );
+            ret = &m_free_lists.back();
+        }
+        else
+        {
+            // Do nothing. Already tracked
+        }
+
+        return ret;
+    }
+
+private:
+    std::vector<free_list> m_free_lists;
+    size_t                 m_capacity;
+
+private:
+    node_cache( const node_cache& );
+    node_cache& operator=( const node_cache& );
+};
+
+// Standard allocator which allocates through a node_cache
+template<class T>
+class node_cache_allocator
+{
+public:
+    typedef T value_type;
+
+    explicit node_cache_allocator( node_cache& cache )
+        : m_cache( &cache )
+    {
+    }
+
+    template<class U>
+    node_cache_allocator( const node_cache_allocator<U>& rhs )
+        : m_cache( rhs.cache() )
+    {
+    }
+
+    T* allocate( size_t n )
+    {
+        return static_cast<T*>( m_cache->allocate( sizeof(T), n ) );
+    }
+
+    void deallocate( T* ptr, size_t n )
+    {
+        m_cache->deallocate( ptr, sizeof(T), n );
+    }
+
+    node_cache* cache() const
+    {
+        return m_cache;
+    }
+
+private:
+    node_cache* m_cache;
+};
+
+template<class T, class U>
+bool operator==( const node_cache_allocator<T>& lhs,
+                 const node_cache_allocator<U>& rhs )
+{
+    return lhs.cache() == rhs.cache();
+}
+
+template<class T, class U>
+bool operator!=( const node_cache_allocator<T>& lhs,
+                 const node_cache_allocator<U>& rhs )
+{
+    return lhs.cache() != rhs.cache();
+}
+
+}
+
+#endif
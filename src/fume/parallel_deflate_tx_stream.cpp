@@ -0,0 +1,288 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+// zlib
+#include <zlib.h>
+
+// local private
+#include "fume/parallel_deflate_tx_stream.h"
+
+using std::vector;
+using std::unique_ptr;
+using std::shared_ptr;
+using std::packaged_task;
+using std::min;
+
+namespace fume
+{
+
+static const size_t PARALLEL_DEFLATE_BLOCK_SIZE = 128u * 1024u;
+// Largest preset dictionary usable with a 32KB window
+static const size_t PARALLEL_DEFLATE_DICT_SIZE = 32u * 1024u;
+// Negative window bits indicates a raw deflate stream with no zlib
+// header or trailer, as required by PS3.5 Annex A.5
+static const int DEFLATE_WINDOW_BITS = -15;
+static const int DEFLATE_MEM_LEVEL = 8;
+// Blocks in flight per worker thread before the writer waits on the
+// oldest one. Bounds memory use regardless of data set size
+static const size_t PARALLEL_DEFLATE_QUEUE_DEPTH = 2u;
+
+typedef vector<uint8_t> block_t;
+
+// Compresses a single block. Returns NULL on a zlib error
+static unique_ptr<block_t> compress_block( int                       level,
+                                           shared_ptr<const block_t> input,
+                                           shared_ptr<const block_t> dict,
+                                           bool                      last )
+{
+    unique_ptr<block_t> ret;
+
+    z_stream zstream;
+    memset( &zstream, 0, sizeof(zstream) );
+    zstream.zalloc = Z_NULL;
+    zstream.zfree = Z_NULL;
+    zstream.opaque = Z_NULL;
+
+    if( deflateInit2( &zstream,
+                      level,
+                      Z_DEFLATED,
+                      DEFLATE_WINDOW_BITS,
+                      DEFLATE_MEM_LEVEL,
+                      Z_DEFAULT_STRATEGY ) == Z_OK )
+    {
+        int zret = Z_OK;
+        if( dict != nullptr && dict->empty() == false )
+        {
+            const size_t dict_size = min( dict->size(),
+                                          PARALLEL_DEFLATE_DICT_SIZE );
+            const Bytef* dict_begin = dict->data() + dict->size() - dict_size;
+            zret = deflateSetDictionary( &zstream,
+                                         dict_begin,
+                                         static_cast<uInt>( dict_size ) );
+        }
+        else
+        {
+            // Do nothing. First block has no dictionary
+        }
+
+        if( zret == Z_OK )
+        {
+            // deflateBound does not account for the empty stored block
+            // emitted by Z_SYNC_FLUSH, so leave some room for it
+            unique_ptr<block_t> output
+            (
+                new block_t( deflateBound( &zstream,
+                                           static_cast<uLong>( input->size() ) ) + 16u )
+            );
+
+            zstream.next_in = const_cast<Bytef*>( input->data() );
+            zstream.avail_in = static_cast<uInt>( input->size() );
+            zstream.next_out = output->data();
+            zstream.avail_out = static_cast<uInt>( output->size() );
+
+            // Non-final blocks end on a byte boundary without setting the
+            // BFINAL bit so the next block can follow directly
+            zret = deflate( &zstream, last == true ? Z_FINISH : Z_SYNC_FLUSH );
+            if( (last == true && zret == Z_STREAM_END) ||
+                (last == false && zret == Z_OK && zstream.avail_in == 0u) )
+            {
+                output->resize( output->size() - zstream.avail_out );
+                ret = std::move( output );
+            }
+            else
+            {
+                // Do nothing. Will return NULL
+            }
+        }
+        else
+        {
+            // Do nothing. Will return NULL
+        }
+
+        (void)deflateEnd( &zstream );
+    }
+    else
+    {
+        // Do nothing. Will return NULL
+    }
+
+    return ret;
+}
+
+parallel_deflate_tx_stream::parallel_deflate_tx_stream( tx_stream& dest,
+                                                        int        level,
+                                                        size_t     num_threads )
+    : m_dest( dest ),
+      m_level( level ),
+      m_num_threads( std::max( num_threads, static_cast<size_t>( 1u ) ) ),
+      m_block( new block_t() ),
+      m_bytes_written( 0 ),
+      m_compressed_bytes( 0 )
+{
+    m_block->reserve( PARALLEL_DEFLATE_BLOCK_SIZE );
+}
+
+parallel_deflate_tx_stream::~parallel_deflate_tx_stream()
+{
+}
+
+MC_STATUS parallel_deflate_tx_stream::write( const void* buffer,
+                                             uint32_t    buffer_bytes )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( buffer != nullptr )
+    {
+        const uint8_t* data = static_cast<const uint8_t*>( buffer );
+        const uint8_t* const data_end = data + buffer_bytes;
+
+        ret = MC_NORMAL_COMPLETION;
+        while( ret == MC_NORMAL_COMPLETION && data != data_end )
+        {
+            const size_t copy_bytes =
+                min( static_cast<size_t>( data_end - data ),
+                     PARALLEL_DEFLATE_BLOCK_SIZE - m_block->size() );
+            m_block->insert( m_block->end(), data, data + copy_bytes );
+            data += copy_bytes;
+
+            if( m_block->size() == PARALLEL_DEFLATE_BLOCK_SIZE )
+            {
+                submit_block( false );
+
+                // Wait on the oldest block once enough are in flight
+                if( m_pending.size() >
+                    m_num_threads * PARALLEL_DEFLATE_QUEUE_DEPTH )
+                {
+                    ret = write_pending_block();
+                }
+                else
+                {
+                    // Do nothing. Keep filling blocks
+                }
+            }
+            else
+            {
+                // Do nothing. Block not full yet
+            }
+        }
+
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            m_bytes_written += buffer_bytes;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = MC_NULL_POINTER_PARM;
+    }
+
+    return ret;
+}
+
+MC_STATUS parallel_deflate_tx_stream::finalize()
+{
+    // The final block is always submitted, even if empty, so the
+    // stream is terminated with a BFINAL block
+    submit_block( true );
+
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    while( ret == MC_NORMAL_COMPLETION && m_pending.empty() == false )
+    {
+        ret = write_pending_block();
+    }
+
+    // The deflated data set must have an even length. Pad with a
+    // single trailing NULL byte if necessary
+    if( ret == MC_NORMAL_COMPLETION && m_compressed_bytes % 2u != 0u )
+    {
+        const uint8_t pad = 0u;
+        ret = m_dest.write( &pad, sizeof(pad) );
+        m_compressed_bytes += sizeof(pad);
+    }
+    else
+    {
+        // Do nothing. Either already even or will return error
+    }
+
+    return ret;
+}
+
+void parallel_deflate_tx_stream::submit_block( bool last )
+{
+    const shared_block_t input( m_block.release() );
+    const shared_block_t dict( m_previous_block );
+    const int level = m_level;
+
+    const auto job = [level, input, dict, last]()
+    {
+        return compress_block( level, input, dict, last );
+    };
+
+    if( m_pool == nullptr && last == true )
+    {
+        // Everything fit in a single block. Compress it on this thread
+        packaged_task<unique_ptr<block_t>()> task( job );
+        m_pending.push_back( task.get_future() );
+        task();
+    }
+    else
+    {
+        if( m_pool == nullptr )
+        {
+            m_pool.reset( new thread_pool( m_num_threads ) );
+        }
+        else
+        {
+            // Do nothing. Pool already running
+        }
+
+        m_pending.push_back( m_pool->submit( job ) );
+    }
+
+    m_previous_block = input;
+    m_block.reset( new block_t() );
+    m_block->reserve( PARALLEL_DEFLATE_BLOCK_SIZE );
+}
+
+MC_STATUS parallel_deflate_tx_stream::write_pending_block()
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    assert( m_pending.empty() == false );
+    const unique_ptr<block_t> output( m_pending.front().get() );
+    m_pending.pop_front();
+
+    if( output != nullptr )
+    {
+        ret = output->empty() == true ?
+                  MC_NORMAL_COMPLETION :
+                  m_dest.write( output->data(),
+                                static_cast<uint32_t>( output->size() ) );
+        m_compressed_bytes += output->size();
+    }
+    else
+    {
+        ret = MC_ZLIB_ERROR;
+    }
+
+    return ret;
+}
+
+}
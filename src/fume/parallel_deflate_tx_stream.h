@@ -0,0 +1,87 @@
+#ifndef PARALLEL_DEFLATE_TX_STREAM_H
+#define PARALLEL_DEFLATE_TX_STREAM_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <future>
+#include <memory>
+
+// local public
+#include "mcstatus.h"
+
+// local private
+#include "fume/tx_stream.h"
+#include "fume/thread_pool.h"
+
+namespace fume
+{
+
+// Produces the same raw deflate (RFC 1951) stream format as
+// deflate_tx_stream, but splits the uncompressed data into fixed-size
+// blocks which are compressed independently on a pool of worker threads.
+// Each block is primed with the tail of the previous block as a preset
+// dictionary and ends on a byte boundary (Z_SYNC_FLUSH) so the
+// compressed blocks can simply be concatenated in order. finalize must
+// be called once all data has been written
+class parallel_deflate_tx_stream final : public tx_stream
+{
+public:
+    // Note: the destination stream must have a lifetime exceeding that
+    // of this object
+    parallel_deflate_tx_stream( tx_stream& dest, int level, size_t num_threads );
+    ~parallel_deflate_tx_stream();
+
+    MC_STATUS finalize();
+
+// tx_stream
+public:
+    virtual MC_STATUS write( const void* buffer,
+                             uint32_t    buffer_bytes ) override final;
+
+    virtual uint64_t tell_write() const override final
+    {
+        return m_bytes_written;
+    }
+
+private:
+    parallel_deflate_tx_stream( const parallel_deflate_tx_stream& );
+    parallel_deflate_tx_stream& operator=( const parallel_deflate_tx_stream& );
+
+    typedef std::vector<uint8_t>                 block_t;
+    typedef std::shared_ptr<const block_t>       shared_block_t;
+    typedef std::future<std::unique_ptr<block_t> > pending_block_t;
+
+    void submit_block( bool last );
+    MC_STATUS write_pending_block();
+
+private:
+    tx_stream&                   m_dest;
+    const int                    m_level;
+    const size_t                 m_num_threads;
+    std::unique_ptr<block_t>     m_block;
+    shared_block_t               m_previous_block;
+    std::deque<pending_block_t>  m_pending;
+    // Created once more than one block has been written so small data
+    // sets don't pay for thread creation. Declared after m_pending so
+    // the workers are joined before the futures are destroyed
+    std::unique_ptr<thread_pool> m_pool;
+    uint64_t                     m_bytes_written;
+    uint64_t                     m_compressed_bytes;
+};
+
+}
+
+#endif
@@ -0,0 +1,293 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// local public
+#include "diction.h"
+
+// local private
+#include "fume/record_index.h"
+#include "fume/record_object.h"
+#include "fume/library_context.h"
+#include "fume/value_representation.h"
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::unordered_set;
+using std::vector;
+using std::begin;
+using std::end;
+
+namespace fume
+{
+
+static const uint32_t KEYS[] =
+{
+    MC_ATT_PATIENT_ID,
+    MC_ATT_STUDY_INSTANCE_UID,
+    MC_ATT_SERIES_INSTANCE_UID,
+    MC_ATT_REFERENCED_SOP_INSTANCE_UID_IN_FILE
+};
+
+// Removes the padding of values read from a file
+static void trim_padding( string& value )
+{
+    const string::size_type end = value.find_last_not_of( " \0", string::npos, 2 );
+    value.erase( end != string::npos ? end + 1u : 0u );
+}
+
+// Gets the value of tag without the padding of values read from a file.
+// Returns false if the record has no value for tag
+static bool get_key_value( record_object& record, uint32_t tag, string& value )
+{
+    bool ret = false;
+
+    // Longer than any UID or LO value
+    char buffer[128] = { '\0' };
+    get_string_parms parms = { buffer, sizeof(buffer) };
+
+    // Looked up with find, since at would add the element to records
+    // which don't have it
+    const dictionary_iter itr = record.find( tag );
+    value_representation* const element =
+        itr != record.end() ? itr->second.get() : nullptr;
+    if( element != nullptr &&
+        element->is_null() == false &&
+        element->get( parms ) == MC_NORMAL_COMPLETION )
+    {
+        value.assign( buffer );
+        trim_padding( value );
+        ret = true;
+    }
+    else
+    {
+        ret = false;
+    }
+
+    return ret;
+}
+
+record_index::record_index( int dicomdir_id )
+    : m_dicomdir_id( dicomdir_id )
+{
+}
+
+record_index::~record_index()
+{
+}
+
+bool record_index::is_key( uint32_t tag )
+{
+    return std::find( begin( KEYS ), end( KEYS ), tag ) != end( KEYS );
+}
+
+record_index::key_map_t& record_index::get_key_map( uint32_t tag )
+{
+    key_map_t* ret = nullptr;
+
+    switch( tag )
+    {
+        case MC_ATT_PATIENT_ID:
+            ret = &m_patient_ids;
+            break;
+        case MC_ATT_STUDY_INSTANCE_UID:
+            ret = &m_study_uids;
+            break;
+        case MC_ATT_SERIES_INSTANCE_UID:
+            ret = &m_series_uids;
+            break;
+        default:
+            assert( tag == MC_ATT_REFERENCED_SOP_INSTANCE_UID_IN_FILE );
+            ret = &m_sop_instance_uids;
+            break;
+    }
+
+    return *ret;
+}
+
+record_object* record_index::find_record( int record_id ) const
+{
+    assert( g_context != nullptr );
+
+    record_object* const record =
+        dynamic_cast<record_object*>( g_context->find_object( record_id ) );
+
+    // IDs of deleted records may have been given to records of another
+    // DICOMDIR
+    return record != nullptr &&
+           record->get_dicomdir_file_id() == m_dicomdir_id ? record : nullptr;
+}
+
+MC_STATUS record_index::add( record_object& record )
+{
+    MC_STATUS ret = record.load_values();
+
+    string value;
+    for( const uint32_t tag : KEYS )
+    {
+        if( ret == MC_NORMAL_COMPLETION &&
+            get_key_value( record, tag, value ) == true )
+        {
+            vector<int>& ids = get_key_map( tag )[value];
+            if( std::find( ids.cbegin(), ids.cend(), record.id() ) == ids.cend() )
+            {
+                ids.push_back( record.id() );
+            }
+            else
+            {
+                // Do nothing. Already indexed
+            }
+        }
+        else
+        {
+            // Do nothing. No value or an error will be returned
+        }
+    }
+
+    return ret;
+}
+
+void record_index::mark_changed( int record_id )
+{
+    lock_guard<mutex> lock( m_changed_mutex );
+
+    m_changed.insert( record_id );
+}
+
+void record_index::remove( record_object& record )
+{
+    string value;
+    for( const uint32_t tag : KEYS )
+    {
+        key_map_t& key_map = get_key_map( tag );
+        const key_map_t::iterator itr =
+            get_key_value( record, tag, value ) == true ? key_map.find( value ) :
+                                                          key_map.end();
+        if( itr != key_map.end() )
+        {
+            vector<int>& ids = itr->second;
+            ids.erase( std::remove( ids.begin(), ids.end(), record.id() ),
+                       ids.end() );
+            if( ids.empty() == true )
+            {
+                key_map.erase( itr );
+            }
+            else
+            {
+                // Do nothing. Other records have the value
+            }
+        }
+        else
+        {
+            // Do nothing. Not indexed under its current value, so it
+            // will be skipped when found
+        }
+    }
+}
+
+MC_STATUS record_index::find( uint32_t tag,
+                              string   value,
+                              int&     record_id )
+{
+    vector<int> record_ids;
+    const MC_STATUS ret = find_all( tag, std::move( value ), record_ids );
+    record_id = record_ids.empty() == false ? record_ids.front() : 0;
+
+    return ret;
+}
+
+MC_STATUS record_index::find_all( uint32_t     tag,
+                                  string       value,
+                                  vector<int>& record_ids )
+{
+    assert( is_key( tag ) == true );
+
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    lock_guard<mutex> lock( m_changed_mutex );
+    for( unordered_set<int>::const_iterator itr = m_changed.cbegin();
+         ret == MC_NORMAL_COMPLETION && itr != m_changed.cend();
+         ++itr )
+    {
+        record_object* const record = find_record( *itr );
+        if( record != nullptr )
+        {
+            ret = add( *record );
+        }
+        else
+        {
+            // Do nothing. Record has been deleted
+        }
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        m_changed.clear();
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    trim_padding( value );
+
+    key_map_t& key_map = get_key_map( tag );
+    const key_map_t::iterator ids = key_map.find( value );
+    if( ret == MC_NORMAL_COMPLETION && ids != key_map.end() )
+    {
+        // Candidates whose value has changed or which have been deleted
+        // are dropped as they are found
+        vector<int>::iterator itr = ids->second.begin();
+        string current;
+        while( itr != ids->second.end() )
+        {
+            record_object* const record = find_record( *itr );
+            if( record != nullptr &&
+                get_key_value( *record, tag, current ) == true &&
+                current == value )
+            {
+                record_ids.push_back( *itr );
+                ++itr;
+            }
+            else
+            {
+                itr = ids->second.erase( itr );
+            }
+        }
+
+        if( ids->second.empty() == true )
+        {
+            key_map.erase( ids );
+        }
+        else
+        {
+            // Do nothing. Value is still indexed
+        }
+    }
+    else
+    {
+        // Do nothing. Value not found or an error will be returned
+    }
+
+    return ret;
+}
+
+}
@@ -0,0 +1,94 @@
+#ifndef RECORD_INDEX_H
+#define RECORD_INDEX_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+
+// local private
+
+namespace fume
+{
+
+class record_object;
+
+// Looks up the records of a DICOMDIR by the attributes which identify
+// them: Patient ID, Study Instance UID, Series Instance UID and
+// Referenced SOP Instance UID in File.
+//
+// Values can be set on a record at any time, so the index only holds
+// candidates. A candidate is checked against the record when it is
+// found, and records marked as changed are indexed again before the
+// next search. Every record looked up for the API is marked, since any
+// of its values may be set through its ID
+class record_index final
+{
+public:
+    record_index( int dicomdir_id );
+    ~record_index();
+
+    // True if records can be found by tag
+    static bool is_key( uint32_t tag );
+
+    // Indexes the current values of the record
+    MC_STATUS add( record_object& record );
+
+    // Indexes the record again before the next search. May be called
+    // by threads using different records of the DICOMDIR
+    void mark_changed( int record_id );
+
+    // Removes the record, which is about to be deleted
+    void remove( record_object& record );
+
+    // Finds a record whose value of tag, which must be a key, is value.
+    // record_id is set to zero if there is no such record
+    MC_STATUS find( uint32_t tag, std::string value, int& record_id );
+
+    // Appends the IDs of all of the records whose value of tag, which
+    // must be a key, is value to record_ids
+    MC_STATUS find_all( uint32_t          tag,
+                        std::string       value,
+                        std::vector<int>& record_ids );
+
+private:
+    record_index( const record_index& );
+    record_index& operator=( const record_index& );
+
+private:
+    typedef std::unordered_map<std::string, std::vector<int>> key_map_t;
+
+    key_map_t& get_key_map( uint32_t tag );
+
+    // The record with record_id if it is a record of the DICOMDIR
+    record_object* find_record( int record_id ) const;
+
+private:
+    const int               m_dicomdir_id;
+    key_map_t               m_patient_ids;
+    key_map_t               m_study_uids;
+    key_map_t               m_series_uids;
+    key_map_t               m_sop_instance_uids;
+    std::unordered_set<int> m_changed;
+    std::mutex              m_changed_mutex;
+};
+
+}
+
+#endif
@@ -0,0 +1,457 @@
+/**
+  This is an automatically generated file. Changes to this file
+  should instead either be made in a separate file or to the
+  record keys CSV file used to generate this file, or to the template
+
+  This file was mechanically generated by running the record_keys.csv file,
+  containing comma-delimited key attributes of each directory record type,
+  through the "gen_record_keys.py" python script, which uses a cheetah
+  template to mechanically format a valid C++ file.
+
+  This file is packaged as a part of the FUMe project.
+
+  To the extent possible under law, the person who associated CC0 with
+  FUMe has waived all copyright and related or neighboring rights
+  to FUMe.
+
+  You should have received a copy of the CC0 legalcode along with this
+  work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+**/
+
+// std
+#include <cstdint>
+#include <iterator>
+
+// local public
+#include "mc3media.h"
+
+// local private
+#include "fume/record_keys.h"
+
+using std::begin;
+using std::end;
+
+namespace fume
+{
+
+static const uint32_t ASSESSMENT_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u
+};
+
+static const uint32_t ENCAP_DOC_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x0040a043u,
+    0x0040e001u,
+    0x00420010u,
+    0x00420012u
+};
+
+static const uint32_t FIDUCIAL_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x00700080u,
+    0x00700081u,
+    0x00700084u
+};
+
+static const uint32_t HANGING_PROTOCOL_KEYS[] =
+{
+    0x00080005u,
+    0x00720002u,
+    0x00720004u,
+    0x00720006u,
+    0x00720008u,
+    0x0072000au,
+    0x0072000cu,
+    0x00720014u,
+    0x00720100u
+};
+
+static const uint32_t HL7_STRUC_DOC_KEYS[] =
+{
+    0x00080005u,
+    0x0040e001u,
+    0x0040e004u,
+    0x0040e006u,
+    0x00420010u
+};
+
+static const uint32_t IMAGE_KEYS[] =
+{
+    0x00080005u,
+    0x00200013u,
+    0x00880200u
+};
+
+static const uint32_t IMPLANT_KEYS[] =
+{
+    0x00080005u,
+    0x00080070u,
+    0x00221095u,
+    0x00221097u,
+    0x00686210u
+};
+
+static const uint32_t IMPLANT_ASSY_KEYS[] =
+{
+    0x00080005u,
+    0x00080070u,
+    0x00760001u,
+    0x00760020u
+};
+
+static const uint32_t IMPLANT_GROUP_KEYS[] =
+{
+    0x00080005u,
+    0x00780001u,
+    0x00780020u
+};
+
+static const uint32_t KEY_OBJECT_DOC_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x0040a043u,
+    0x0040a730u
+};
+
+static const uint32_t MEASUREMENT_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u
+};
+
+static const uint32_t PALETTE_KEYS[] =
+{
+    0x00080005u,
+    0x00700080u,
+    0x00700081u
+};
+
+static const uint32_t PATIENT_KEYS[] =
+{
+    0x00080005u,
+    0x00100010u,
+    0x00100020u
+};
+
+static const uint32_t PRESENTATION_KEYS[] =
+{
+    0x00080005u,
+    0x00081115u,
+    0x00200013u,
+    0x00700080u,
+    0x00700081u,
+    0x00700082u,
+    0x00700083u,
+    0x00700084u,
+    0x00700402u
+};
+
+static const uint32_t RAW_DATA_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x00880200u
+};
+
+static const uint32_t REGISTRATION_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x00700080u,
+    0x00700081u,
+    0x00700084u
+};
+
+static const uint32_t RT_DOSE_KEYS[] =
+{
+    0x00080005u,
+    0x00200013u,
+    0x00880200u,
+    0x3004000au
+};
+
+static const uint32_t RT_PLAN_KEYS[] =
+{
+    0x00080005u,
+    0x00200013u,
+    0x300a0002u,
+    0x300a0006u,
+    0x300a0007u
+};
+
+static const uint32_t RT_STRUCTURE_SET_KEYS[] =
+{
+    0x00080005u,
+    0x00200013u,
+    0x30060002u,
+    0x30060008u,
+    0x30060009u
+};
+
+static const uint32_t RT_TREAT_RECORD_KEYS[] =
+{
+    0x00080005u,
+    0x00200013u,
+    0x30080250u,
+    0x30080251u
+};
+
+static const uint32_t SERIES_KEYS[] =
+{
+    0x00080005u,
+    0x00080060u,
+    0x0020000eu,
+    0x00200011u,
+    0x00880200u
+};
+
+static const uint32_t SPECTROSCOPY_KEYS[] =
+{
+    0x00080005u,
+    0x00080008u,
+    0x00080023u,
+    0x00080033u,
+    0x0008114au,
+    0x00200013u,
+    0x00280008u,
+    0x00280010u,
+    0x00280011u,
+    0x00289001u,
+    0x00289002u,
+    0x00880200u
+};
+
+static const uint32_t SR_DOCUMENT_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x0040a030u,
+    0x0040a043u,
+    0x0040a491u,
+    0x0040a493u,
+    0x0040a730u
+};
+
+static const uint32_t STEREOMETRIC_KEYS[] =
+{
+    0x00080005u
+};
+
+static const uint32_t STUDY_KEYS[] =
+{
+    0x00080005u,
+    0x00080020u,
+    0x00080030u,
+    0x00080050u,
+    0x00081030u,
+    0x0020000du,
+    0x00200010u
+};
+
+static const uint32_t SURFACE_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x00700080u,
+    0x00700081u,
+    0x00700084u
+};
+
+static const uint32_t SURFACE_SCAN_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u
+};
+
+static const uint32_t TRACT_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x00700080u,
+    0x00700081u,
+    0x00700084u
+};
+
+static const uint32_t VALUE_MAP_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u,
+    0x00700080u,
+    0x00700081u,
+    0x00700084u
+};
+
+static const uint32_t WAVEFORM_KEYS[] =
+{
+    0x00080005u,
+    0x00080023u,
+    0x00080033u,
+    0x00200013u
+};
+
+record_key_range get_record_keys( MC_DIR_RECORD_TYPE record_type )
+{
+    record_key_range ret;
+
+    switch( record_type )
+    {
+        case MC_REC_TYPE_ASSESSMENT:
+            ret = record_key_range( begin( ASSESSMENT_KEYS ),
+                                    end( ASSESSMENT_KEYS ) );
+            break;
+        case MC_REC_TYPE_ENCAP_DOC:
+            ret = record_key_range( begin( ENCAP_DOC_KEYS ),
+                                    end( ENCAP_DOC_KEYS ) );
+            break;
+        case MC_REC_TYPE_FIDUCIAL:
+            ret = record_key_range( begin( FIDUCIAL_KEYS ),
+                                    end( FIDUCIAL_KEYS ) );
+            break;
+        case MC_REC_TYPE_HANGING_PROTOCOL:
+            ret = record_key_range( begin( HANGING_PROTOCOL_KEYS ),
+                                    end( HANGING_PROTOCOL_KEYS ) );
+            break;
+        case MC_REC_TYPE_HL7_STRUC_DOC:
+            ret = record_key_range( begin( HL7_STRUC_DOC_KEYS ),
+                                    end( HL7_STRUC_DOC_KEYS ) );
+            break;
+        case MC_REC_TYPE_IMAGE:
+            ret = record_key_range( begin( IMAGE_KEYS ),
+                                    end( IMAGE_KEYS ) );
+            break;
+        case MC_REC_TYPE_IMPLANT:
+            ret = record_key_range( begin( IMPLANT_KEYS ),
+                                    end( IMPLANT_KEYS ) );
+            break;
+        case MC_REC_TYPE_IMPLANT_ASSY:
+            ret = record_key_range( begin( IMPLANT_ASSY_KEYS ),
+                                    end( IMPLANT_ASSY_KEYS ) );
+            break;
+        case MC_REC_TYPE_IMPLANT_GROUP:
+            ret = record_key_range( begin( IMPLANT_GROUP_KEYS ),
+                                    end( IMPLANT_GROUP_KEYS ) );
+            break;
+        case MC_REC_TYPE_KEY_OBJECT_DOC:
+            ret = record_key_range( begin( KEY_OBJECT_DOC_KEYS ),
+                                    end( KEY_OBJECT_DOC_KEYS ) );
+            break;
+        case MC_REC_TYPE_MEASUREMENT:
+            ret = record_key_range( begin( MEASUREMENT_KEYS ),
+                                    end( MEASUREMENT_KEYS ) );
+            break;
+        case MC_REC_TYPE_PALETTE:
+            ret = record_key_range( begin( PALETTE_KEYS ),
+                                    end( PALETTE_KEYS ) );
+            break;
+        case MC_REC_TYPE_PATIENT:
+            ret = record_key_range( begin( PATIENT_KEYS ),
+                                    end( PATIENT_KEYS ) );
+            break;
+        case MC_REC_TYPE_PRESENTATION:
+            ret = record_key_range( begin( PRESENTATION_KEYS ),
+                                    end( PRESENTATION_KEYS ) );
+            break;
+        case MC_REC_TYPE_RAW_DATA:
+            ret = record_key_range( begin( RAW_DATA_KEYS ),
+                                    end( RAW_DATA_KEYS ) );
+            break;
+        case MC_REC_TYPE_REGISTRATION:
+            ret = record_key_range( begin( REGISTRATION_KEYS ),
+                                    end( REGISTRATION_KEYS ) );
+            break;
+        case MC_REC_TYPE_RT_DOSE:
+            ret = record_key_range( begin( RT_DOSE_KEYS ),
+                                    end( RT_DOSE_KEYS ) );
+            break;
+        case MC_REC_TYPE_RT_PLAN:
+            ret = record_key_range( begin( RT_PLAN_KEYS ),
+                                    end( RT_PLAN_KEYS ) );
+            break;
+        case MC_REC_TYPE_RT_STRUCTURE_SET:
+            ret = record_key_range( begin( RT_STRUCTURE_SET_KEYS ),
+                                    end( RT_STRUCTURE_SET_KEYS ) );
+            break;
+        case MC_REC_TYPE_RT_TREAT_RECORD:
+            ret = record_key_range( begin( RT_TREAT_RECORD_KEYS ),
+                                    end( RT_TREAT_RECORD_KEYS ) );
+            break;
+        case MC_REC_TYPE_SERIES:
+            ret = record_key_range( begin( SERIES_KEYS ),
+                                    end( SERIES_KEYS ) );
+            break;
+        case MC_REC_TYPE_SPECTROSCOPY:
+            ret = record_key_range( begin( SPECTROSCOPY_KEYS ),
+                                    end( SPECTROSCOPY_KEYS ) );
+            break;
+        case MC_REC_TYPE_SR_DOCUMENT:
+            ret = record_key_range( begin( SR_DOCUMENT_KEYS ),
+                                    end( SR_DOCUMENT_KEYS ) );
+            break;
+        case MC_REC_TYPE_STEREOMETRIC:
+            ret = record_key_range( begin( STEREOMETRIC_KEYS ),
+                                    end( STEREOMETRIC_KEYS ) );
+            break;
+        case MC_REC_TYPE_STUDY:
+            ret = record_key_range( begin( STUDY_KEYS ),
+                                    end( STUDY_KEYS ) );
+            break;
+        case MC_REC_TYPE_SURFACE:
+            ret = record_key_range( begin( SURFACE_KEYS ),
+                                    end( SURFACE_KEYS ) );
+            break;
+        case MC_REC_TYPE_SURFACE_SCAN:
+            ret = record_key_range( begin( SURFACE_SCAN_KEYS ),
+                                    end( SURFACE_SCAN_KEYS ) );
+            break;
+        case MC_REC_TYPE_TRACT:
+            ret = record_key_range( begin( TRACT_KEYS ),
+                                    end( TRACT_KEYS ) );
+            break;
+        case MC_REC_TYPE_VALUE_MAP:
+            ret = record_key_range( begin( VALUE_MAP_KEYS ),
+                                    end( VALUE_MAP_KEYS ) );
+            break;
+        case MC_REC_TYPE_WAVEFORM:
+            ret = record_key_range( begin( WAVEFORM_KEYS ),
+                                    end( WAVEFORM_KEYS ) );
+            break;
+        default:
+            // Do nothing. No keys for the record type
+            break;
+    }
+
+    return ret;
+}
+
+}
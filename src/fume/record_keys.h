@@ -0,0 +1,36 @@
+#ifndef RECORD_KEYS_H
+#define RECORD_KEYS_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+
+// boost
+#include "boost/range/iterator_range.hpp"
+
+// local public
+#include "mc3media.h"
+
+namespace fume
+{
+
+typedef boost::iterator_range<const uint32_t*> record_key_range;
+
+// Tags of the key attributes of records of record_type listed in PS3.3
+// Annex F.5, in ascending order. Empty if the standard doesn't list any.
+// Defined in record_keys.cpp, which is generated from
+// definitions/record_keys.csv by scripts/gen_record_keys.sh
+record_key_range get_record_keys( MC_DIR_RECORD_TYPE record_type );
+
+}
+
+#endif
@@ -11,6 +11,10 @@
 
 // std
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
 
 // local public
 #include "diction.h"
@@ -20,6 +24,17 @@
 #include "fume/tx_stream.h"
 #include "fume/value_representation.h"
 #include "fume/record_type_to_string.h"
+#include "fume/record_source.h"
+#include "fume/data_dictionary_io.h"
+#include "fume/buffer_tx_stream.h"
+#include "fume/data_dictionary_search.h"
+#include "fume/record_keys.h"
+#include "fume/dicomdir_object.h"
+#include "fume/library_context.h"
+
+using std::shared_ptr;
+using std::lock_guard;
+using std::mutex;
 
 namespace fume
 {
@@ -32,8 +47,156 @@ record_object::record_object( int         dicomdir_file_id,
     : item_object( id, created_empty ),
       m_dicomdir_file_id( dicomdir_file_id ),
       m_parent_id( parent_id ),
-      m_next_record( -1 ),
-      m_child_record( -1 )
+      m_next_record( nullptr ),
+      m_prev_record( nullptr ),
+      m_child_record( nullptr ),
+      m_last_child_record( nullptr ),
+      m_offset( 0u ),
+      m_next_offset_position( 0u ),
+      m_lower_offset_position( 0u ),
+      m_source_offset( 0u ),
+      m_source_length( 0u ),
+      m_values_deferred( false )
+{
+    set_initial_values( record_type );
+}
+
+void record_object::reset( int         dicomdir_file_id,
+                           int         parent_id,
+                           int         id,
+                           const char* record_type )
+{
+    item_object::reset( id );
+    m_dicomdir_file_id = dicomdir_file_id;
+    m_parent_id = parent_id;
+    m_next_record = nullptr;
+    m_prev_record = nullptr;
+    m_child_record = nullptr;
+    m_last_child_record = nullptr;
+    m_offset = 0u;
+    m_next_offset_position = 0u;
+    m_lower_offset_position = 0u;
+    m_source.reset();
+    m_values_deferred = false;
+    set_initial_values( record_type );
+}
+
+void record_object::empty_record()
+{
+    empty_item();
+    m_source.reset();
+    m_values_deferred = false;
+}
+
+void record_object::set_source( const shared_ptr<record_source>& source,
+                                uint64_t                         offset,
+                                uint32_t                         length )
+{
+    empty_item();
+    m_source = source;
+    m_source_offset = offset;
+    m_source_length = length;
+    m_values_deferred = source != nullptr;
+}
+
+void record_object::set_written_source( const shared_ptr<record_source>& source,
+                                        uint64_t                         offset,
+                                        uint32_t                         length )
+{
+    m_source = source;
+    m_source_offset = offset;
+    m_source_length = length;
+    m_values_deferred = false;
+}
+
+MC_STATUS record_object::matches_source( bool& matches )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    if( m_source == nullptr )
+    {
+        matches = false;
+    }
+    else if( m_values_deferred == true )
+    {
+        matches = true;
+    }
+    else
+    {
+        // Writing the values moves the positions of the offsets, which
+        // have to stay those of the source
+        const uint64_t next_offset_position = m_next_offset_position;
+        const uint64_t lower_offset_position = m_lower_offset_position;
+
+        buffer_tx_stream stream( m_source_offset );
+        ret = write_item_values( stream, m_source->syntax() );
+        matches = ret == MC_NORMAL_COMPLETION &&
+                  stream.size() == m_source_length &&
+                  m_source_offset + m_source_length <= m_source->size() &&
+                  memcmp( stream.data(),
+                          m_source->data() + m_source_offset,
+                          m_source_length ) == 0;
+
+        m_next_offset_position = next_offset_position;
+        m_lower_offset_position = lower_offset_position;
+    }
+
+    return ret;
+}
+
+MC_STATUS record_object::load_values()
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    if( m_values_deferred == true )
+    {
+        lock_guard<mutex> lock( m_source->mutex() );
+        // Another thread may have read the values while this one waited
+        // for the lock
+        if( m_values_deferred == true )
+        {
+            ret = m_source->read_values( m_source_offset,
+                                         m_source_length,
+                                         *this );
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                m_values_deferred = false;
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+        else
+        {
+            // Do nothing. Values were read by another thread
+        }
+    }
+    else
+    {
+        // Do nothing. Values have already been read
+    }
+
+    return ret;
+}
+
+void record_object::values_may_change()
+{
+    assert( g_context != nullptr );
+
+    dicomdir_object* const dicomdir =
+        dynamic_cast<dicomdir_object*>( g_context->find_object( m_dicomdir_file_id ) );
+    if( dicomdir != nullptr )
+    {
+        dicomdir->record_changed( id() );
+    }
+    else
+    {
+        // Do nothing. DICOMDIR has been freed
+    }
+}
+
+void record_object::set_initial_values( const char* record_type )
 {
     (*this)[MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD].set
     (
@@ -56,7 +219,81 @@ MC_STATUS record_object::to_stream( tx_stream&      stream,
     // Save off the byte offset of this record
     // Has to be 32-bit for DICOMDIR structure to work
     m_offset = static_cast<uint32_t>( stream.tell_write() );
-    return item_object::to_stream( stream, syntax );
+
+    MC_STATUS ret = load_values();
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = item_object::to_stream( stream, syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+MC_STATUS record_object::write_item_values( tx_stream&      stream,
+                                            TRANSFER_SYNTAX syntax )
+{
+    MC_STATUS ret = write_values( stream,
+                                  syntax,
+                                  *this,
+                                  0x00000000u,
+                                  MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD - 1u );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_fixed_ul( stream,
+                              syntax,
+                              *this,
+                              MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD,
+                              m_next_offset_position );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_values( stream,
+                            syntax,
+                            *this,
+                            MC_ATT_OFFSET_OF_THE_NEXT_DIRECTORY_RECORD + 1u,
+                            MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY - 1u );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_fixed_ul( stream,
+                              syntax,
+                              *this,
+                              MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY,
+                              m_lower_offset_position );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = write_values( stream,
+                            syntax,
+                            *this,
+                            MC_ATT_OFFSET_OF_REFERENCED_LOWER_LEVEL_DIRECTORY_ENTITY + 1u,
+                            0xFFFFFFFFu );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
 }
 
 MC_STATUS record_object::get_record_type( MC_DIR_RECORD_TYPE& type )
@@ -72,6 +309,18 @@ MC_STATUS record_object::get_record_type( MC_DIR_RECORD_TYPE& type )
         ret = record_type_val->get( parms );
         if( ret == MC_NORMAL_COMPLETION )
         {
+            // Values read from a file keep the padding of odd length
+            // values
+            char* const end = record_type_str + strlen( record_type_str );
+            if( end != record_type_str && *(end - 1) == ' ' )
+            {
+                *(end - 1) = '\0';
+            }
+            else
+            {
+                // Do nothing. Not padded
+            }
+
             ret = get_enum_from_record_type( record_type_str, type );
         }
         else
@@ -89,4 +338,31 @@ MC_STATUS record_object::get_record_type( MC_DIR_RECORD_TYPE& type )
     return ret;
 }
 
+MC_STATUS record_object::copy_keys( data_dictionary& source )
+{
+    MC_STATUS ret = load_values();
+
+    MC_DIR_RECORD_TYPE type = MC_REC_TYPE_UNKNOWN;
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = get_record_type( type );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        const record_key_range keys( get_record_keys( type ) );
+        copy_values( *this, source, keys.begin(), keys.end() );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
 }
@@ -12,6 +12,9 @@
  */
 
 // std
+#include <atomic>
+#include <cstdint>
+#include <memory>
 
 // local public
 #include "mcstatus.h"
@@ -23,6 +26,8 @@
 namespace fume
 {
 
+class record_source;
+
 class record_object : public item_object
 {
 public:
@@ -35,6 +40,38 @@ public:
     {
     }
 
+    // Prepares a record taken from the object pool for reuse
+    void reset( int         dicomdir_file_id,
+                int         parent_id,
+                int         id,
+                const char* record_type );
+
+    // Empties a record which is being returned to the object pool,
+    // releasing its source
+    void empty_record();
+
+    // Defers reading the values of the record until load_values is
+    // called. The values are the length bytes of source starting at
+    // offset. Any values held by the record are removed
+    void set_source( const std::shared_ptr<record_source>& source,
+                     uint64_t                              offset,
+                     uint32_t                              length );
+
+    // Records that the values held by the record were written to the
+    // length bytes of source starting at offset. The values are kept
+    void set_written_source( const std::shared_ptr<record_source>& source,
+                             uint64_t                              offset,
+                             uint32_t                              length );
+
+    bool is_from( const record_source& source ) const
+    {
+        return m_source.get() == &source;
+    }
+
+    // Checks whether the values of the record still encode to the bytes
+    // of its source, so the record doesn't need to be written again
+    MC_STATUS matches_source( bool& matches );
+
     int get_dicomdir_file_id() const
     {
         return m_dicomdir_file_id;
@@ -45,45 +82,135 @@ public:
         return m_parent_id;
     }
 
-    MC_STATUS set_next_record( int record_id )
+    // Records are linked directly rather than by ID, so the tree can be
+    // walked without looking records up in the library context. All the
+    // records of a DICOMDIR are owned by its Directory Record Sequence,
+    // which only the MC_DDH functions change, and a record is unlinked
+    // before it is deleted
+    void set_next_record( record_object* record )
     {
-        // Caller performs record validation
-        m_next_record = record_id;
-        return MC_NORMAL_COMPLETION;
+        m_next_record = record;
     }
-    int get_next_record() const
+    record_object* next_record() const
     {
         return m_next_record;
     }
 
-    MC_STATUS set_child_record( int child_record )
+    // The record before this one in its parent's chain, so a record can
+    // be unlinked without walking the chain
+    void set_prev_record( record_object* record )
     {
-        // Caller performs record validation
-        m_child_record = child_record;
-        return MC_NORMAL_COMPLETION;
+        m_prev_record = record;
     }
-    int get_child_record() const
+    record_object* prev_record() const
+    {
+        return m_prev_record;
+    }
+
+    void set_child_record( record_object* record )
+    {
+        m_child_record = record;
+    }
+    record_object* child_record() const
     {
         return m_child_record;
     }
 
+    // Tail of the child record chain so records can be appended without
+    // walking the chain
+    void set_last_child_record( record_object* record )
+    {
+        m_last_child_record = record;
+    }
+    record_object* last_child_record() const
+    {
+        return m_last_child_record;
+    }
+
+    // IDs of the linked records, or -1 if there is no such record
+    int get_next_record() const
+    {
+        return m_next_record != nullptr ? m_next_record->id() : -1;
+    }
+    int get_child_record() const
+    {
+        return m_child_record != nullptr ? m_child_record->id() : -1;
+    }
+    int get_last_child_record() const
+    {
+        return m_last_child_record != nullptr ? m_last_child_record->id() : -1;
+    }
+
     MC_STATUS get_record_type( MC_DIR_RECORD_TYPE& type );
 
+    // Copies the values of the key attributes of the record's type
+    // (PS3.3 Annex F.5) which source has, replacing the values of the
+    // record. Nothing is copied for a type without keys
+    MC_STATUS copy_keys( data_dictionary& source );
+
     uint32_t get_offset() const
     {
         return m_offset;
     }
 
+    // Stream positions of the values of the next record and lower level
+    // offsets, as of the last time the record was read or written. The
+    // offsets are always written as a single UL, so the values can be
+    // patched in place once the offsets of all the records are known
+    uint64_t get_next_offset_position() const
+    {
+        return m_next_offset_position;
+    }
+    uint64_t get_lower_offset_position() const
+    {
+        return m_lower_offset_position;
+    }
+
+    // Sets the offset of a record read from a file and the positions of
+    // its offset values in the file, which are zero if the record
+    // doesn't have them
+    void set_file_position( uint32_t offset,
+                            uint64_t next_offset_position,
+                            uint64_t lower_offset_position )
+    {
+        m_offset = offset;
+        m_next_offset_position = next_offset_position;
+        m_lower_offset_position = lower_offset_position;
+    }
+
+    virtual MC_STATUS load_values() override;
+
+    // Tells the DICOMDIR to index the record again before its next search
+    virtual void values_may_change() override;
+
     virtual MC_STATUS to_stream( tx_stream&      stream,
                                  TRANSFER_SYNTAX syntax ) override;
 
+protected:
+    virtual MC_STATUS write_item_values( tx_stream&      stream,
+                                         TRANSFER_SYNTAX syntax ) override;
+
+private:
+    void set_initial_values( const char* record_type );
+
 private:
     int m_dicomdir_file_id;
     int m_parent_id;
-    int m_next_record;
-    int m_child_record;
+    record_object* m_next_record;
+    record_object* m_prev_record;
+    record_object* m_child_record;
+    record_object* m_last_child_record;
     // Used to fill in DICOMDIR offset parameters
     uint32_t m_offset;
+    uint64_t m_next_offset_position;
+    uint64_t m_lower_offset_position;
+    // Where the values come from if they haven't been read yet. The
+    // source is kept once the values are read, since other threads may
+    // be waiting on its mutex
+    std::shared_ptr<record_source> m_source;
+    uint64_t                       m_source_offset;
+    uint32_t                       m_source_length;
+    std::atomic<bool>              m_values_deferred;
 };
 
 }
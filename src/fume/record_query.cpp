@@ -0,0 +1,675 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+#include "diction.h"
+
+// local private
+#include "fume/record_query.h"
+#include "fume/dicomdir_object.h"
+#include "fume/record_object.h"
+#include "fume/record_index.h"
+#include "fume/item_object.h"
+#include "fume/library_context.h"
+#include "fume/value_representation.h"
+#include "fume/vrs/sq.h"
+
+using std::max;
+using std::none_of;
+using std::numeric_limits;
+using std::pair;
+using std::reverse;
+using std::sort;
+using std::string;
+using std::unique;
+using std::unique_ptr;
+using std::vector;
+
+using fume::vrs::sq;
+
+namespace fume
+{
+
+struct query_key;
+typedef vector<query_key> query_keys;
+
+// An attribute of the query which isn't matched universally
+struct query_key
+{
+    uint32_t               tag;
+    MC_VR                  vr;
+    // Any of which the attribute may match, without padding
+    vector<string>         values;
+    // The keys the items of a sequence are matched against
+    unique_ptr<query_keys> item_keys;
+};
+
+// A key which hasn't been matched on the current path
+static const size_t NOT_MATCHED = numeric_limits<size_t>::max();
+
+// Initial size of the buffer values are read into. Larger values are
+// read by growing it
+static const size_t VALUE_BUFFER_SIZE = 256u;
+
+struct query_state
+{
+    query_keys     keys;
+    // Directory Record Type of the records returned, or empty for any
+    string         record_type;
+    // Depth of the record each key was matched at on the current path,
+    // or NOT_MATCHED
+    vector<size_t> matched_depth;
+    // Reused by get_string_values
+    vector<string> values;
+    vector<char>   buffer;
+};
+
+enum record_match
+{
+    // A key didn't match, so nothing below the record can match either
+    RECORD_FAILS,
+    // The keys matched so far match but others haven't been found yet
+    RECORD_INCOMPLETE,
+    RECORD_MATCHES
+};
+
+static void trim_padding( string& value )
+{
+    const string::size_type end = value.find_last_not_of( " \0", string::npos, 2 );
+    value.erase( end != string::npos ? end + 1u : 0u );
+    value.erase( 0u, value.find_first_not_of( ' ' ) );
+}
+
+// Gets the values of element as strings without padding. Returns false
+// if they can't be read as strings
+static bool get_string_values( value_representation& element,
+                               vector<string>&       values,
+                               vector<char>&         buffer )
+{
+    values.clear();
+    buffer.resize( max( buffer.size(), VALUE_BUFFER_SIZE ) );
+
+    MC_STATUS stat = MC_NORMAL_COMPLETION;
+    bool next = false;
+    while( stat == MC_NORMAL_COMPLETION )
+    {
+        // get sets the second member to the length of the value, so the
+        // parameters are made again for each value
+        get_string_parms parms( buffer.data(), buffer.size() );
+        stat = next == true ? element.get_next( parms ) : element.get( parms );
+        if( stat == MC_NORMAL_COMPLETION )
+        {
+            values.emplace_back( buffer.data(), parms.second );
+            trim_padding( values.back() );
+            next = true;
+        }
+        else if( stat == MC_BUFFER_TOO_SMALL )
+        {
+            // get starts again from the first value
+            buffer.resize( buffer.size() * 2u );
+            values.clear();
+            next = false;
+            stat = MC_NORMAL_COMPLETION;
+        }
+        else
+        {
+            // Do nothing. No more values or they can't be read as strings
+        }
+    }
+
+    return stat == MC_NO_MORE_VALUES || stat == MC_NULL_VALUE;
+}
+
+// Unlike data_dictionary::at, doesn't add the element to objects
+// created empty
+static value_representation* find_value( data_dictionary& dict, uint32_t tag )
+{
+    const dictionary_iter itr = dict.find( tag );
+    return itr != dict.end() ? itr->second.get() : nullptr;
+}
+
+static bool allows_wildcards( MC_VR vr )
+{
+    return vr == AE || vr == CS || vr == LO || vr == LT || vr == PN ||
+           vr == SH || vr == ST || vr == UC || vr == UR || vr == UT;
+}
+
+static bool is_wildcard( MC_VR vr, const string& value )
+{
+    return allows_wildcards( vr ) == true &&
+           value.find_first_of( "*?" ) != string::npos;
+}
+
+static bool is_range( MC_VR vr, const string& value )
+{
+    return ( vr == DA || vr == TM ) && value.find( '-' ) != string::npos;
+}
+
+// Matches value against pattern, where * matches any number of
+// characters and ? matches any one character
+static bool matches_wildcard( const string& pattern, const string& value )
+{
+    string::size_type p = 0u;
+    string::size_type v = 0u;
+    // Where to resume after the last *, if any, when a match fails
+    string::size_type star = string::npos;
+    string::size_type star_value = 0u;
+
+    bool ret = true;
+    while( ret == true && v < value.size() )
+    {
+        if( p < pattern.size() &&
+            ( pattern[p] == '?' || pattern[p] == value[v] ) )
+        {
+            ++p;
+            ++v;
+        }
+        else if( p < pattern.size() && pattern[p] == '*' )
+        {
+            star = p++;
+            star_value = v;
+        }
+        else if( star != string::npos )
+        {
+            // Let the last * match one more character
+            p = star + 1u;
+            v = ++star_value;
+        }
+        else
+        {
+            ret = false;
+        }
+    }
+
+    while( ret == true && p < pattern.size() && pattern[p] == '*' )
+    {
+        ++p;
+    }
+
+    return ret == true && p == pattern.size();
+}
+
+static bool matches_range( const string& range, const string& value )
+{
+    // Dates and times in the DICOM formats sort as strings
+    const string::size_type dash = range.find( '-' );
+    const string begin = range.substr( 0u, dash );
+    const string end = range.substr( dash + 1u );
+
+    return value.empty() == false &&
+           ( begin.empty() == true || value >= begin ) &&
+           ( end.empty() == true || value <= end );
+}
+
+static bool matches_value( MC_VR vr, const string& key, const string& value )
+{
+    bool ret = false;
+
+    if( is_range( vr, key ) == true )
+    {
+        ret = matches_range( key, value );
+    }
+    else if( is_wildcard( vr, key ) == true )
+    {
+        ret = matches_wildcard( key, value );
+    }
+    else
+    {
+        ret = key == value;
+    }
+
+    return ret;
+}
+
+static bool matches_items( query_state&      state,
+                           const query_keys& keys,
+                           const sq&         sequence );
+
+static bool matches_key( query_state&          state,
+                         const query_key&      key,
+                         value_representation& element )
+{
+    bool ret = false;
+
+    if( key.item_keys != nullptr )
+    {
+        ret = element.vr() == SQ &&
+              matches_items( state,
+                             *key.item_keys,
+                             static_cast<const sq&>( element ) );
+    }
+    else if( get_string_values( element, state.values, state.buffer ) == true )
+    {
+        // A multi-valued attribute matches if any of its values do
+        for( vector<string>::const_iterator value = state.values.cbegin();
+             ret == false && value != state.values.cend();
+             ++value )
+        {
+            for( vector<string>::const_iterator itr = key.values.cbegin();
+                 ret == false && itr != key.values.cend();
+                 ++itr )
+            {
+                ret = matches_value( key.vr, *itr, *value );
+            }
+        }
+    }
+    else
+    {
+        // Do nothing. The value can't be compared
+    }
+
+    return ret;
+}
+
+static bool matches_items( query_state&      state,
+                           const query_keys& keys,
+                           const sq&         sequence )
+{
+    vector<item_object*> items;
+    sequence.get_items( items );
+
+    bool ret = false;
+    for( vector<item_object*>::const_iterator item = items.cbegin();
+         ret == false && item != items.cend();
+         ++item )
+    {
+        ret = (*item)->load_values() == MC_NORMAL_COMPLETION;
+        for( query_keys::const_iterator key = keys.cbegin();
+             ret == true && key != keys.cend();
+             ++key )
+        {
+            value_representation* const element = find_value( **item, key->tag );
+            ret = element != nullptr && matches_key( state, *key, *element );
+        }
+    }
+
+    return ret;
+}
+
+// Adds the values of element to key. Values with backslashes are split
+// so a list of UIDs can be given as a single string
+static MC_STATUS get_key_values( query_state&          state,
+                                 value_representation& element,
+                                 query_key&            key )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    if( get_string_values( element, state.values, state.buffer ) == true )
+    {
+        for( const string& value : state.values )
+        {
+            string::size_type begin = 0u;
+            while( begin != string::npos )
+            {
+                const string::size_type end = value.find( '\\', begin );
+                key.values.push_back( value.substr( begin, end - begin ) );
+                trim_padding( key.values.back() );
+                begin = end != string::npos ? end + 1u : end;
+            }
+        }
+    }
+    else
+    {
+        ret = MC_INCOMPATIBLE_VR;
+    }
+
+    return ret;
+}
+
+// Gets the keys of query which aren't matched universally
+static MC_STATUS get_keys( query_state&     state,
+                           data_dictionary& query,
+                           query_keys&      keys )
+{
+    MC_STATUS ret = query.load_values();
+
+    for( dictionary_iter itr = query.begin();
+         ret == MC_NORMAL_COMPLETION && itr != query.end();
+         ++itr )
+    {
+        value_representation* const element = itr->second.get();
+        if( element != nullptr && element->is_null() == false )
+        {
+            query_key key;
+            key.tag = itr->first;
+            key.vr = element->vr();
+            if( key.vr == SQ )
+            {
+                // Only the first item of a sequence is used
+                vector<item_object*> items;
+                static_cast<const sq*>( element )->get_items( items );
+
+                key.item_keys.reset( new query_keys() );
+                ret = get_keys( state, *items.front(), *key.item_keys );
+            }
+            else
+            {
+                ret = get_key_values( state, *element, key );
+            }
+
+            if( ret == MC_NORMAL_COMPLETION &&
+                ( key.item_keys == nullptr || key.item_keys->empty() == false ) )
+            {
+                keys.push_back( std::move( key ) );
+            }
+            else
+            {
+                // Do nothing. An empty item matches any sequence, or an
+                // error will be returned
+            }
+        }
+        else
+        {
+            // Do nothing. Universal matching
+        }
+    }
+
+    return ret;
+}
+
+// Reads the query, taking the Directory Record Type out of the keys
+static MC_STATUS read_query( data_dictionary& query, query_state& state )
+{
+    MC_STATUS ret = get_keys( state, query, state.keys );
+
+    query_keys::iterator record_type = state.keys.begin();
+    while( record_type != state.keys.end() &&
+           record_type->tag != MC_ATT_DIRECTORY_RECORD_TYPE )
+    {
+        ++record_type;
+    }
+
+    if( ret == MC_NORMAL_COMPLETION && record_type != state.keys.end() )
+    {
+        state.record_type = record_type->values.front();
+        state.keys.erase( record_type );
+    }
+    else
+    {
+        // Do nothing. Records of any type are returned or an error will
+        // be returned
+    }
+
+    state.matched_depth.assign( state.keys.size(), NOT_MATCHED );
+
+    return ret;
+}
+
+// Matches the keys not yet matched on the path to record, which is at
+// depth on the path. Keys matched by records which were at depth or
+// below on the path are no longer matched, since those records were on
+// another branch
+static MC_STATUS match_record( query_state&   state,
+                               record_object& record,
+                               size_t         depth,
+                               record_match&  match )
+{
+    MC_STATUS ret = record.load_values();
+
+    match = RECORD_MATCHES;
+    for( size_t i = 0; ret == MC_NORMAL_COMPLETION && i < state.keys.size(); ++i )
+    {
+        if( state.matched_depth[i] >= depth )
+        {
+            value_representation* const element =
+                find_value( record, state.keys[i].tag );
+            if( element == nullptr || element->is_null() == true )
+            {
+                // Empty elements are treated as missing, since records
+                // may have empty elements of other levels
+                state.matched_depth[i] = NOT_MATCHED;
+                match = match == RECORD_MATCHES ? RECORD_INCOMPLETE : match;
+            }
+            else if( match != RECORD_FAILS &&
+                     matches_key( state, state.keys[i], *element ) == true )
+            {
+                state.matched_depth[i] = depth;
+            }
+            else
+            {
+                // The key isn't looked for further down the path
+                state.matched_depth[i] = depth;
+                match = RECORD_FAILS;
+            }
+        }
+        else
+        {
+            // Do nothing. Matched by a record above
+        }
+    }
+
+    return ret;
+}
+
+static bool is_record_type( query_state& state, record_object& record )
+{
+    value_representation* const element =
+        find_value( record, MC_ATT_DIRECTORY_RECORD_TYPE );
+    return element != nullptr &&
+           get_string_values( *element, state.values, state.buffer ) == true &&
+           state.values.empty() == false &&
+           state.values.front() == state.record_type;
+}
+
+// Searches first, the records below it, and if siblings is true, the
+// records after first in its chain and the records below them
+static MC_STATUS search( query_state&   state,
+                         record_object* first,
+                         size_t         depth,
+                         bool           siblings,
+                         vector<int>&   record_ids )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    vector<pair<record_object*, size_t> > pending;
+    if( first != nullptr )
+    {
+        pending.emplace_back( first, depth );
+    }
+    else
+    {
+        // Do nothing. No records
+    }
+
+    while( ret == MC_NORMAL_COMPLETION && pending.empty() == false )
+    {
+        record_object& record = *pending.back().first;
+        const size_t record_depth = pending.back().second;
+        pending.pop_back();
+
+        if( record.next_record() != nullptr &&
+            ( siblings == true || record_depth > depth ) )
+        {
+            pending.emplace_back( record.next_record(), record_depth );
+        }
+        else
+        {
+            // Do nothing. End of chain or only first is searched
+        }
+
+        record_match match = RECORD_FAILS;
+        ret = match_record( state, record, record_depth, match );
+
+        const bool is_type = ret == MC_NORMAL_COMPLETION &&
+                             match != RECORD_FAILS &&
+                             state.record_type.empty() == false &&
+                             is_record_type( state, record ) == true;
+        if( ret == MC_NORMAL_COMPLETION &&
+            match == RECORD_MATCHES &&
+            ( state.record_type.empty() == true || is_type == true ) )
+        {
+            record_ids.push_back( record.id() );
+        }
+        else
+        {
+            // Do nothing. Not a match or an error will be returned
+        }
+
+        if( ret == MC_NORMAL_COMPLETION &&
+            match != RECORD_FAILS &&
+            is_type == false &&
+            record.child_record() != nullptr )
+        {
+            pending.emplace_back( record.child_record(), record_depth + 1u );
+        }
+        else
+        {
+            // Do nothing. Nothing below can match
+        }
+    }
+
+    return ret;
+}
+
+// Finds a key which can be looked up in the index, or returns NULL
+static const query_key* get_index_key( const query_state& state )
+{
+    const query_key* ret = nullptr;
+
+    for( query_keys::const_iterator key = state.keys.cbegin();
+         ret == nullptr && key != state.keys.cend();
+         ++key )
+    {
+        if( record_index::is_key( key->tag ) == true && key->item_keys == nullptr &&
+            none_of( key->values.cbegin(),
+                          key->values.cend(),
+                          [key]( const string& value )
+                          {
+                              return is_wildcard( key->vr, value ) == true ||
+                                     is_range( key->vr, value ) == true;
+                          } ) )
+        {
+            ret = &*key;
+        }
+        else
+        {
+            // Do nothing. Not indexed or not an exact match
+        }
+    }
+
+    return ret;
+}
+
+// Searches below each record found by the index for key, after checking
+// the keys of the records above it. The index is only trusted for the
+// records it finds: records whose values may have been set since they
+// were indexed are indexed again by find_records, and each candidate is
+// checked against its current value
+static MC_STATUS search_from_index( dicomdir_object& dicomdir,
+                                    query_state&     state,
+                                    const query_key& key,
+                                    vector<int>&     record_ids )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    vector<int> candidates;
+    for( vector<string>::const_iterator value = key.values.cbegin();
+         ret == MC_NORMAL_COMPLETION && value != key.values.cend();
+         ++value )
+    {
+        ret = dicomdir.find_records( key.tag, *value, candidates );
+    }
+
+    // A UID may be listed more than once
+    sort( candidates.begin(), candidates.end() );
+    candidates.erase( unique( candidates.begin(), candidates.end() ),
+                      candidates.end() );
+
+    const size_t index_key = &key - state.keys.data();
+    vector<record_object*> path;
+    for( vector<int>::const_iterator itr = candidates.cbegin();
+         ret == MC_NORMAL_COMPLETION && itr != candidates.cend();
+         ++itr )
+    {
+        // The records above the candidate, from the root down
+        path.clear();
+        state.matched_depth.assign( state.keys.size(), NOT_MATCHED );
+        int parent_id = *itr;
+        while( ret == MC_NORMAL_COMPLETION && parent_id != dicomdir.id() )
+        {
+            record_object* const parent =
+                dynamic_cast<record_object*>( g_context->find_object( parent_id ) );
+            if( parent != nullptr )
+            {
+                path.push_back( parent );
+                parent_id = parent->get_parent_record();
+            }
+            else
+            {
+                ret = MC_SYSTEM_ERROR;
+            }
+        }
+        reverse( path.begin(), path.end() );
+
+        record_match match = RECORD_INCOMPLETE;
+        for( size_t depth = 0u;
+             ret == MC_NORMAL_COMPLETION &&
+             match == RECORD_INCOMPLETE &&
+             depth + 1u < path.size();
+             ++depth )
+        {
+            ret = match_record( state, *path[depth], depth, match );
+        }
+
+        // If a record above has a value for the indexed attribute, the
+        // key is matched there rather than by the candidate
+        if( ret == MC_NORMAL_COMPLETION &&
+            match != RECORD_FAILS &&
+            state.matched_depth[index_key] == NOT_MATCHED )
+        {
+            ret = search( state, path.back(), path.size() - 1u, false, record_ids );
+        }
+        else
+        {
+            // Do nothing. Nothing below can match or an error will be
+            // returned
+        }
+    }
+
+    return ret;
+}
+
+MC_STATUS query_records( dicomdir_object&  dicomdir,
+                         data_dictionary&  query,
+                         vector<int>&      record_ids )
+{
+    assert( g_context != nullptr );
+
+    query_state state;
+    MC_STATUS ret = read_query( query, state );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        const query_key* const index_key = get_index_key( state );
+        ret = index_key != nullptr ?
+              search_from_index( dicomdir, state, *index_key, record_ids ) :
+              search( state, dicomdir.child_record(), 0u, true, record_ids );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+}
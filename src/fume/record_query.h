@@ -0,0 +1,57 @@
+#ifndef RECORD_QUERY_H
+#define RECORD_QUERY_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+
+namespace fume
+{
+
+class data_dictionary;
+class dicomdir_object;
+
+// Finds the records of dicomdir matching the attributes of query, as a
+// C-FIND SCP matches an identifier (PS3.4 C.2.2.2):
+//
+// - an attribute with no value matches anything (universal matching)
+// - a value containing * or ? is a wildcard for AE, CS, LO, LT, PN, SH,
+//   ST, UC, UR and UT
+// - a DA or TM value of the form "begin-end", "begin-" or "-end" is an
+//   inclusive range
+// - an attribute with several values, or a value with backslashes,
+//   matches a record with any of them (ie. a list of UIDs)
+// - a sequence matches a record with an item matching all of the
+//   attributes of the first item of the query's sequence
+// - any other value must be the same, ignoring padding
+//
+// An attribute is matched against the first record on the path from the
+// root with a value for it, so a key at the patient level is only
+// checked once for each patient, and a record is a match once all of
+// the keys have been matched along its path. Directory Record Type
+// selects the type of records returned. Records below a record of that
+// type aren't searched.
+//
+// If one of the keys is indexed by record_index and isn't a wildcard,
+// the search starts from the records the index finds for it rather than
+// from the root. The IDs of the matching records are appended to
+// record_ids
+MC_STATUS query_records( dicomdir_object&  dicomdir,
+                         data_dictionary&  query,
+                         std::vector<int>& record_ids );
+
+}
+
+#endif
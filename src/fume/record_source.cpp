@@ -0,0 +1,81 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+
+// local private
+#include "fume/record_source.h"
+#include "fume/buffer_rx_stream.h"
+#include "fume/data_dictionary.h"
+#include "fume/data_dictionary_io.h"
+
+using std::vector;
+using std::lock_guard;
+
+namespace fume
+{
+
+record_source::record_source( vector<uint8_t>& data, TRANSFER_SYNTAX syntax )
+    : m_syntax( syntax )
+{
+    m_data.swap( data );
+}
+
+record_source::~record_source()
+{
+}
+
+MC_STATUS record_source::read_values( uint64_t         offset,
+                                      uint32_t         length,
+                                      data_dictionary& dict ) const
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( offset <= m_data.size() && m_data.size() - offset >= length )
+    {
+        buffer_rx_stream stream( m_data.data() + offset, length );
+        ret = read_values_from_item( stream, m_syntax, dict, 0, length );
+    }
+    else
+    {
+        // The record was checked when the DICOMDIR was opened, so this
+        // shouldn't happen
+        ret = MC_SYSTEM_ERROR;
+    }
+
+    return ret;
+}
+
+void record_source::write( uint64_t offset, const uint8_t* data, size_t size )
+{
+    // Records may be reading their values from another thread
+    lock_guard<std::mutex> lock( m_mutex );
+
+    if( m_data.size() < offset + size )
+    {
+        m_data.resize( static_cast<size_t>( offset + size ) );
+    }
+    else
+    {
+        // Do nothing. Overwriting existing data
+    }
+
+    memcpy( m_data.data() + offset, data, size );
+}
+
+}
@@ -0,0 +1,91 @@
+#ifndef RECORD_SOURCE_H
+#define RECORD_SOURCE_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+
+// local private
+
+namespace fume
+{
+
+class data_dictionary;
+
+// The contents of a DICOMDIR opened with MC_DDH_Open. The records of
+// the DICOMDIR share the source and read their values from it the
+// first time they are accessed, so only the records which are used are
+// ever parsed.
+// The whole file is kept in memory rather than read on demand from the
+// file, since the DICOMDIR may be written over its own file, by
+// MC_DDH_Update or MC_Write_File, while records are still unread. The
+// cost is memory equal to the size of the file; reading it is a small
+// part of the time taken to scan and link the records
+class record_source final
+{
+public:
+    // Takes the contents of data, leaving it empty
+    record_source( std::vector<uint8_t>& data, TRANSFER_SYNTAX syntax );
+    ~record_source();
+
+    const uint8_t* data() const
+    {
+        return m_data.data();
+    }
+
+    size_t size() const
+    {
+        return m_data.size();
+    }
+
+    TRANSFER_SYNTAX syntax() const
+    {
+        return m_syntax;
+    }
+
+    // Guards records of this source while their values are read
+    std::mutex& mutex()
+    {
+        return m_mutex;
+    }
+
+    // Reads the values of a record encoded in the length bytes starting
+    // at offset into dict
+    MC_STATUS read_values( uint64_t         offset,
+                           uint32_t         length,
+                           data_dictionary& dict ) const;
+
+    // Replaces the size bytes starting at offset with data, extending
+    // the source if needed. Used to keep the source the same as the file
+    // when records are appended to it
+    void write( uint64_t offset, const uint8_t* data, size_t size );
+
+private:
+    record_source( const record_source& );
+    record_source& operator=( const record_source& );
+
+private:
+    std::vector<uint8_t> m_data;
+    TRANSFER_SYNTAX      m_syntax;
+    std::mutex           m_mutex;
+};
+
+}
+
+#endif
@@ -110,6 +110,25 @@ static MC_STATUS read_and_swap( rx_stream&      stream,
     return ret;
 }
 
+template<class T>
+static MC_STATUS peek_and_swap( rx_stream&      stream,
+                                TRANSFER_SYNTAX syntax,
+                                T&              val )
+{
+    MC_STATUS ret = stream.peek( &val, sizeof(val) );
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = wire_to_host( syntax, val );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
 MC_STATUS rx_stream::read_vr( MC_VR& vr, TRANSFER_SYNTAX syntax )
 {
     MC_STATUS ret = MC_CANNOT_COMPLY;
@@ -279,4 +298,14 @@ MC_STATUS rx_stream::read_val( double& val, TRANSFER_SYNTAX syntax )
     return read( &val, sizeof(val) );
 }
 
+MC_STATUS rx_stream::peek_val( uint16_t& val, TRANSFER_SYNTAX syntax )
+{
+    return peek_and_swap( *this, syntax, val );
+}
+
+MC_STATUS rx_stream::peek_val( uint32_t& val, TRANSFER_SYNTAX syntax )
+{
+    return peek_and_swap( *this, syntax, val );
+}
+
 }
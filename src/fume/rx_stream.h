@@ -54,6 +54,9 @@ public:
     MC_STATUS read_val( uint32_t& val, TRANSFER_SYNTAX syntax );
     MC_STATUS read_val( float& val, TRANSFER_SYNTAX syntax );
     MC_STATUS read_val( double& val, TRANSFER_SYNTAX syntax );
+
+    MC_STATUS peek_val( uint16_t& val, TRANSFER_SYNTAX syntax );
+    MC_STATUS peek_val( uint32_t& val, TRANSFER_SYNTAX syntax );
     MC_STATUS read_val( char& val, TRANSFER_SYNTAX syntax );
 
     MC_STATUS read_vals( int16_t* vals, uint32_t num_vals, TRANSFER_SYNTAX syntax );
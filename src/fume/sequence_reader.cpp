@@ -0,0 +1,391 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <utility>
+
+// local public
+#include "diction.h"
+
+// local private
+#include "fume/rx_stream.h"
+#include "fume/library_context.h"
+#include "fume/item_object.h"
+#include "fume/value_representation.h"
+#include "fume/data_dictionary_io.h"
+#include "fume/sequence_reader.h"
+#include "fume/implicit_vr_cache.h"
+#include "fume/vrs/sq.h"
+
+using std::numeric_limits;
+using std::vector;
+using std::move;
+
+using fume::vrs::sq;
+
+namespace fume
+{
+
+static const uint32_t UNDEFINED_LENGTH = numeric_limits<uint32_t>::max();
+
+// Used if READ_SQ_DEPTH_LIMIT is not configured
+static const int DEFAULT_DEPTH_LIMIT = 128;
+
+// One level of the explicit stack: a sequence and the item within it
+// that is currently being read. Levels are reused when the reader
+// returns to a depth, so sibling sequences share the item list storage
+struct sequence_level
+{
+    // The SQ element being read and its tag. Unused for the outermost
+    // sequence, whose items are returned to the caller
+    unique_vr_ptr element;
+    uint32_t      tag;
+    uint64_t      start_offset;
+    uint32_t      length;
+    vector<item_object_ptr> items;
+
+    bool          in_item;
+    uint64_t      item_start_offset;
+    uint32_t      item_length;
+    // The values of the current item. The item object is only created
+    // once all of its values have been read
+    value_dict    item_values;
+    // Pixel Representation of the enclosing data set, restored once the
+    // item has been read
+    int           pixel_representation;
+};
+
+static void start_level( sequence_level& level,
+                         unique_vr_ptr&  element,
+                         uint32_t        tag,
+                         uint64_t        start_offset,
+                         uint32_t        length );
+
+static bool at_end( const rx_stream& stream,
+                    uint64_t         start_offset,
+                    uint32_t         length );
+
+static MC_STATUS read_item_start( rx_stream&         stream,
+                                  TRANSFER_SYNTAX    syntax,
+                                  sequence_level&    level,
+                                  implicit_vr_cache* vr_cache,
+                                  bool&              sequence_finished );
+
+static MC_STATUS finish_item( sequence_level&    level,
+                              implicit_vr_cache* vr_cache );
+
+MC_STATUS read_sequence( rx_stream&               stream,
+                         TRANSFER_SYNTAX          syntax,
+                         uint32_t                 length,
+                         vector<item_object_ptr>& items )
+{
+    const int depth_limit = get_sequence_depth_limit();
+
+    // Sequences read as part of a file use the cache of the file.
+    // Otherwise one is needed for this sequence if it is implicit VR
+    const implicit_vr_scope vr_scope( syntax );
+    // NULL if the stream is explicit VR, as the VRs are not resolved
+    implicit_vr_cache* const vr_cache = implicit_vr_cache::current();
+
+    vector<sequence_level> levels( 1u );
+    // Index of the level currently being read. levels[0] is the
+    // sequence whose length the caller read
+    size_t depth = 0;
+
+    unique_vr_ptr outermost;
+    start_level( levels[0], outermost, 0, stream.tell_read(), length );
+
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    bool finished = false;
+    while( ret == MC_NORMAL_COMPLETION && finished == false )
+    {
+        sequence_level& level = levels[depth];
+        if( level.in_item == false )
+        {
+            bool sequence_finished = false;
+            ret = read_item_start( stream,
+                                   syntax,
+                                   level,
+                                   vr_cache,
+                                   sequence_finished );
+            if( ret == MC_NORMAL_COMPLETION &&
+                sequence_finished == true &&
+                depth > 0 )
+            {
+                ret = static_cast<sq&>( *level.element ).assign_items( level.items );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    levels[depth - 1u].item_values[level.tag].swap( level.element );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+
+                level.element.reset();
+                --depth;
+            }
+            else if( ret == MC_NORMAL_COMPLETION && sequence_finished == true )
+            {
+                finished = true;
+            }
+            else
+            {
+                // Do nothing. Either the next item was started or an error
+                // will be returned
+            }
+        }
+        else if( at_end( stream,
+                         level.item_start_offset,
+                         level.item_length ) == true )
+        {
+            ret = finish_item( level, vr_cache );
+        }
+        else
+        {
+            uint32_t tag = 0;
+            ret = stream.read_tag( tag, syntax );
+            if( ret == MC_NORMAL_COMPLETION &&
+                tag == MC_ATT_ITEM_DELIMITATION_ITEM )
+            {
+                // Read the length (which should be zero, but we aren't going
+                // to check)
+                uint32_t delim_length = 0;
+                ret = stream.read_val( delim_length, syntax );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    ret = finish_item( level, vr_cache );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else if( ret == MC_NORMAL_COMPLETION &&
+                     (tag == MC_ATT_ITEM ||
+                      tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM) )
+            {
+                // We received something we shouln't have
+                ret = MC_UNEXPECTED_EOD;
+            }
+            else if( ret == MC_NORMAL_COMPLETION )
+            {
+                unique_vr_ptr element;
+                ret = create_vr_from_stream( stream, syntax, tag, element );
+                if( ret == MC_NORMAL_COMPLETION && element == nullptr )
+                {
+                    ret = MC_INVALID_TAG;
+                }
+                else if( ret == MC_NORMAL_COMPLETION && element->vr() == SQ )
+                {
+                    uint32_t sq_length = 0;
+                    ret = stream.read_val( sq_length, syntax );
+                    if( ret == MC_NORMAL_COMPLETION &&
+                        depth + 2u > static_cast<size_t>( depth_limit ) )
+                    {
+                        ret = MC_VALUE_TOO_LARGE;
+                    }
+                    else if( ret == MC_NORMAL_COMPLETION )
+                    {
+                        // NOTE: level is invalidated if levels grows
+                        ++depth;
+                        if( depth == levels.size() )
+                        {
+                            levels.emplace_back();
+                        }
+                        else
+                        {
+                            // Do nothing. Reuse the level
+                        }
+
+                        start_level( levels[depth],
+                                     element,
+                                     tag,
+                                     stream.tell_read(),
+                                     sq_length );
+                    }
+                    else
+                    {
+                        // Do nothing. Will return error
+                    }
+                }
+                else if( ret == MC_NORMAL_COMPLETION )
+                {
+                    ret = element->from_stream( stream, syntax );
+                    if( ret == MC_NORMAL_COMPLETION )
+                    {
+                        if( vr_cache != nullptr )
+                        {
+                            vr_cache->value_read( tag, *element );
+                        }
+                        else
+                        {
+                            // Do nothing. VRs are read from the stream
+                        }
+                        level.item_values[tag].swap( element );
+                    }
+                    else
+                    {
+                        // Do nothing. Will return error
+                    }
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        for( item_object_ptr& item : levels[0].items )
+        {
+            items.push_back( move( item ) );
+        }
+    }
+    else
+    {
+        // Do nothing. Items read so far are freed with the levels
+    }
+
+    return ret;
+}
+
+int get_sequence_depth_limit()
+{
+    assert( g_context != nullptr );
+
+    int ret = DEFAULT_DEPTH_LIMIT;
+    // Leave the default in place if the value is not configured
+    (void)g_context->get_int_config_value( READ_SQ_DEPTH_LIMIT, ret );
+
+    return ret;
+}
+
+void start_level( sequence_level& level,
+                  unique_vr_ptr&  element,
+                  uint32_t        tag,
+                  uint64_t        start_offset,
+                  uint32_t        length )
+{
+    level.element.swap( element );
+    level.tag = tag;
+    level.start_offset = start_offset;
+    level.length = length;
+    level.in_item = false;
+    level.item_start_offset = 0;
+    level.item_length = 0;
+    level.pixel_representation = -1;
+}
+
+bool at_end( const rx_stream& stream, uint64_t start_offset, uint32_t length )
+{
+    return length != UNDEFINED_LENGTH &&
+           (stream.tell_read() - start_offset) >= length;
+}
+
+MC_STATUS read_item_start( rx_stream&         stream,
+                           TRANSFER_SYNTAX    syntax,
+                           sequence_level&    level,
+                           implicit_vr_cache* vr_cache,
+                           bool&              sequence_finished )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    uint32_t tag = 0;
+    if( at_end( stream, level.start_offset, level.length ) == true )
+    {
+        sequence_finished = true;
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
+    {
+        ret = stream.read_tag( tag, syntax );
+    }
+
+    if( sequence_finished == false && ret == MC_NORMAL_COMPLETION )
+    {
+        uint32_t value_length = 0;
+        ret = stream.read_val( value_length, syntax );
+        if( ret == MC_NORMAL_COMPLETION && tag == MC_ATT_ITEM )
+        {
+            level.in_item = true;
+            level.item_start_offset = stream.tell_read();
+            level.item_length = value_length;
+            level.pixel_representation =
+                vr_cache != nullptr ? vr_cache->pixel_representation() : -1;
+        }
+        else if( ret == MC_NORMAL_COMPLETION &&
+                 tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM )
+        {
+            // If we're expecting a sequence delimiter, then the sequence
+            // is complete. Otherwise something went wrong
+            if( level.length == UNDEFINED_LENGTH && value_length == 0 )
+            {
+                sequence_finished = true;
+            }
+            else
+            {
+                ret = MC_END_OF_DATA;
+            }
+        }
+        else if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = MC_INVALID_TAG;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Either the sequence is finished or an error will
+        // be returned
+    }
+
+    return ret;
+}
+
+MC_STATUS finish_item( sequence_level& level, implicit_vr_cache* vr_cache )
+{
+    if( vr_cache != nullptr )
+    {
+        vr_cache->set_pixel_representation( level.pixel_representation );
+    }
+    else
+    {
+        // Do nothing. VRs are read from the stream
+    }
+
+    // The item is owned by the sequence and is given an ID only if one
+    // is requested
+    item_object_ptr item( new item_object( 0, true ) );
+    item->insert( move( level.item_values ) );
+    level.item_values.clear();
+
+    level.items.push_back( move( item ) );
+    level.in_item = false;
+
+    return MC_NORMAL_COMPLETION;
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef SEQUENCE_READER_H
+#define SEQUENCE_READER_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <vector>
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+
+// local private
+#include "fume/item_object.h"
+
+namespace fume
+{
+
+class rx_stream;
+
+// Reads the items of a sequence whose value length has just been read.
+// Nested sequences are read using an explicit stack rather than by
+// recursing through sq::from_stream, so stack usage does not depend on
+// the nesting depth of the input. Returns MC_VALUE_TOO_LARGE if the
+// sequences nest deeper than the READ_SQ_DEPTH_LIMIT configuration
+// value.
+//
+// On success the items are appended to items. The items are not
+// registered with the library context and have no IDs. On failure no
+// items are returned.
+MC_STATUS read_sequence( rx_stream&                    stream,
+                         TRANSFER_SYNTAX               syntax,
+                         uint32_t                      length,
+                         std::vector<item_object_ptr>& items );
+
+// The deepest sequences may nest in data read from a stream, from the
+// READ_SQ_DEPTH_LIMIT configuration value. Readers of nested sequences
+// return MC_VALUE_TOO_LARGE past it, so that stack and memory use are
+// bounded however the input nests
+int get_sequence_depth_limit();
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <algorithm>
+
+// local private
+#include "fume/tag_filter.h"
+
+using std::vector;
+using std::sort;
+using std::max;
+using std::upper_bound;
+
+namespace fume
+{
+
+static bool range_starts_after( uint32_t tag, const tag_range& range )
+{
+    return tag < range.first;
+}
+
+tag_filter::tag_filter( vector<tag_range> ranges )
+{
+    sort( ranges.begin(), ranges.end() );
+
+    for( const tag_range& range : ranges )
+    {
+        if( range.first > range.second )
+        {
+            // Ignore empty ranges
+        }
+        else if( m_ranges.empty() == false &&
+                 (m_ranges.back().second == 0xFFFFFFFFu ||
+                  range.first <= m_ranges.back().second + 1u) )
+        {
+            m_ranges.back().second = max( m_ranges.back().second,
+                                          range.second );
+        }
+        else
+        {
+            m_ranges.push_back( range );
+        }
+    }
+}
+
+bool tag_filter::contains( uint32_t tag ) const
+{
+    // Find the last range starting at or before the tag
+    const vector<tag_range>::const_iterator itr =
+        upper_bound( m_ranges.cbegin(),
+                     m_ranges.cend(),
+                     tag,
+                     range_starts_after );
+
+    return itr != m_ranges.cbegin() && tag <= (itr - 1)->second;
+}
+
+uint32_t tag_filter::last_tag() const
+{
+    return m_ranges.empty() == false ? m_ranges.back().second : 0u;
+}
+
+}
@@ -0,0 +1,44 @@
+#ifndef TAG_FILTER_H
+#define TAG_FILTER_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+namespace fume
+{
+
+// Inclusive range of tags
+typedef std::pair<uint32_t, uint32_t> tag_range;
+
+// Set of tag ranges used to select which elements are read from a
+// stream. Overlapping and adjacent ranges are merged on construction
+class tag_filter final
+{
+public:
+    explicit tag_filter( std::vector<tag_range> ranges );
+
+    bool contains( uint32_t tag ) const;
+
+    // Largest tag accepted by the filter. No elements need to be read
+    // after this tag
+    uint32_t last_tag() const;
+
+private:
+    std::vector<tag_range> m_ranges;
+};
+
+}
+
+#endif
@@ -41,6 +41,10 @@ bool get_conditional_tag_vr( uint32_t         tag,
                              data_dictionary& dict,
                              MC_VR&           tag_vr );
 
+// True for tags whose VR is US or SS depending on Pixel Representation.
+// The default VR of these tags is US
+bool has_pixel_representation_vr( uint32_t tag );
+
 } // namespace fume
 
 
@@ -0,0 +1,94 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <algorithm>
+
+// local private
+#include "fume/thread_pool.h"
+
+using std::function;
+using std::lock_guard;
+using std::unique_lock;
+using std::mutex;
+using std::thread;
+using std::max;
+
+namespace fume
+{
+
+thread_pool::thread_pool( size_t num_threads )
+    : m_stopping( false )
+{
+    const size_t count = max( num_threads, static_cast<size_t>( 1u ) );
+
+    m_threads.reserve( count );
+    for( size_t i = 0; i < count; ++i )
+    {
+        m_threads.emplace_back( &thread_pool::run_worker, this );
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        lock_guard<mutex> lock( m_mutex );
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for( thread& worker : m_threads )
+    {
+        worker.join();
+    }
+}
+
+void thread_pool::run_worker()
+{
+    bool done = false;
+
+    while( done == false )
+    {
+        function<void()> task;
+
+        {
+            unique_lock<mutex> lock( m_mutex );
+            m_condition.wait( lock, [this]()
+            {
+                return m_stopping == true || m_tasks.empty() == false;
+            } );
+
+            if( m_tasks.empty() == false )
+            {
+                task = std::move( m_tasks.front() );
+                m_tasks.pop();
+            }
+            else
+            {
+                // Only reached once stopping and the queue is drained
+                done = true;
+            }
+        }
+
+        if( task )
+        {
+            // Exceptions are captured by the packaged_task and rethrown
+            // to the caller through its future
+            task();
+        }
+        else
+        {
+            // Do nothing. Exiting
+        }
+    }
+}
+
+}
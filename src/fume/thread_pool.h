@@ -0,0 +1,82 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstddef>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+namespace fume
+{
+
+// Fixed-size pool of worker threads. Tasks are run in the order they
+// are submitted and their results (or exceptions) are retrieved through
+// the returned future. Any queued tasks are completed before the
+// destructor returns
+class thread_pool final
+{
+public:
+    explicit thread_pool( size_t num_threads );
+    ~thread_pool();
+
+    template<class Func>
+    std::future<typename std::result_of<Func()>::type> submit( Func func )
+    {
+        typedef typename std::result_of<Func()>::type result_t;
+
+        // std::function requires a copyable target, so the (move-only)
+        // packaged_task is shared with the queued wrapper
+        std::shared_ptr<std::packaged_task<result_t()> > task
+        (
+            new std::packaged_task<result_t()>( std::move( func ) )
+        );
+        std::future<result_t> ret( task->get_future() );
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_tasks.push( [task]() { (*task)(); } );
+        }
+        m_condition.notify_one();
+
+        return ret;
+    }
+
+    size_t size() const
+    {
+        return m_threads.size();
+    }
+
+private:
+    thread_pool( const thread_pool& );
+    thread_pool& operator=( const thread_pool& );
+
+    void run_worker();
+
+private:
+    std::vector<std::thread>          m_threads;
+    std::queue<std::function<void()> > m_tasks;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_condition;
+    bool                              m_stopping;
+};
+
+}
+
+#endif
@@ -0,0 +1,482 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+#include "diction.h"
+
+// local private
+#include "fume/rx_stream.h"
+#include "fume/tx_stream.h"
+#include "fume/vr_field.h"
+#include "fume/data_dictionary_io.h"
+#include "fume/implicit_vr_cache.h"
+#include "fume/transcoder.h"
+
+using std::vector;
+using std::numeric_limits;
+using std::min;
+using std::reverse;
+
+namespace fume
+{
+
+static const uint32_t UNDEFINED_LENGTH = numeric_limits<uint32_t>::max();
+static const uint64_t UNDEFINED_END = numeric_limits<uint64_t>::max();
+// Must be a multiple of the largest swap unit (8 bytes)
+static const uint32_t TRANSCODE_CHUNK_SIZE = 64u * 1024u;
+
+// A sequence or item which has been started in the destination stream
+// and not yet delimited
+struct open_container
+{
+    // Offset in the source stream at which the container ends. Set to
+    // UNDEFINED_END if it is terminated by a delimitation item instead
+    uint64_t        end_offset;
+    bool            is_item;
+    // Transfer syntax of the contents in the source stream. Differs from
+    // the data set for UN sequences, which are always implicit
+    TRANSFER_SYNTAX syntax;
+    // Pixel Representation of the enclosing data set, restored once an
+    // item is closed
+    int             pixel_representation;
+};
+
+typedef vector<open_container> container_stack;
+
+static bool is_big_endian( TRANSFER_SYNTAX syntax )
+{
+    return syntax == EXPLICIT_BIG_ENDIAN || syntax == IMPLICIT_BIG_ENDIAN;
+}
+
+static uint32_t get_swap_size( MC_VR vr )
+{
+    uint32_t ret = 1u;
+
+    switch( vr )
+    {
+        case US:
+        case SS:
+        case OW:
+        // AT values are pairs of 16-bit group and element numbers
+        case AT:
+            ret = 2u;
+            break;
+        case UL:
+        case SL:
+        case FL:
+        case OF:
+        case OL:
+            ret = 4u;
+            break;
+        case FD:
+        case OD:
+            ret = 8u;
+            break;
+        default:
+            ret = 1u;
+            break;
+    }
+
+    return ret;
+}
+
+static MC_STATUS write_delimiter( tx_stream&      dest,
+                                  TRANSFER_SYNTAX dest_syntax,
+                                  uint32_t        tag )
+{
+    MC_STATUS ret = dest.write_tag( tag, dest_syntax );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = dest.write_val( static_cast<uint32_t>( 0u ), dest_syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+static MC_STATUS close_container( tx_stream&         dest,
+                                  TRANSFER_SYNTAX    dest_syntax,
+                                  implicit_vr_cache& vr_cache,
+                                  container_stack&   containers )
+{
+    assert( containers.empty() == false );
+
+    const uint32_t tag = containers.back().is_item == true ?
+                             MC_ATT_ITEM_DELIMITATION_ITEM :
+                             MC_ATT_SEQUENCE_DELIMITATION_ITEM;
+    vr_cache.set_pixel_representation( containers.back().pixel_representation );
+    containers.pop_back();
+
+    return write_delimiter( dest, dest_syntax, tag );
+}
+
+static MC_STATUS close_ended_containers( rx_stream&         source,
+                                         tx_stream&         dest,
+                                         TRANSFER_SYNTAX    dest_syntax,
+                                         implicit_vr_cache& vr_cache,
+                                         container_stack&   containers )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    while( ret == MC_NORMAL_COMPLETION                    &&
+           containers.empty() == false                    &&
+           containers.back().end_offset != UNDEFINED_END  &&
+           source.tell_read() >= containers.back().end_offset )
+    {
+        ret = close_container( dest, dest_syntax, vr_cache, containers );
+    }
+
+    return ret;
+}
+
+static MC_STATUS write_element_header( tx_stream&      dest,
+                                       TRANSFER_SYNTAX dest_syntax,
+                                       uint32_t        tag,
+                                       MC_VR           vr,
+                                       uint32_t        length )
+{
+    MC_STATUS ret = dest.write_tag( tag, dest_syntax );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        // Does nothing for implicit little endian
+        ret = dest.write_vr( vr, dest_syntax );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        vr_value_t vr_value;
+        uint8_t field_size = 0;
+        ret = get_vr_field_value( vr, vr_value, field_size );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            if( dest_syntax == IMPLICIT_LITTLE_ENDIAN ||
+                field_size > vr_value.size() )
+            {
+                ret = dest.write_val( length, dest_syntax );
+            }
+            else
+            {
+                assert( length <= numeric_limits<uint16_t>::max() );
+                ret = dest.write_val( static_cast<uint16_t>( length ),
+                                      dest_syntax );
+            }
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+static MC_STATUS copy_value( rx_stream&       source,
+                             tx_stream&       dest,
+                             uint32_t         length,
+                             uint32_t         swap_size,
+                             vector<uint8_t>& buffer )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+
+    uint32_t bytes_remaining = length;
+    while( ret == MC_NORMAL_COMPLETION && bytes_remaining > 0u )
+    {
+        const uint32_t chunk_size =
+            min( static_cast<uint32_t>( buffer.size() ), bytes_remaining );
+        ret = source.read( buffer.data(), chunk_size );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            // Any trailing partial unit is copied unmodified
+            if( swap_size > 1u )
+            {
+                const uint32_t swap_bytes = chunk_size - (chunk_size % swap_size);
+                for( uint32_t i = 0; i < swap_bytes; i += swap_size )
+                {
+                    reverse( buffer.begin() + i,
+                             buffer.begin() + i + swap_size );
+                }
+            }
+            else
+            {
+                // Do nothing. Byte data
+            }
+
+            ret = dest.write( buffer.data(), chunk_size );
+            bytes_remaining -= chunk_size;
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret;
+}
+
+static MC_STATUS transcode_element( rx_stream&         source,
+                                    TRANSFER_SYNTAX    source_syntax,
+                                    tx_stream&         dest,
+                                    TRANSFER_SYNTAX    dest_syntax,
+                                    uint32_t           tag,
+                                    implicit_vr_cache& vr_cache,
+                                    container_stack&   containers,
+                                    vector<uint8_t>&   buffer )
+{
+    MC_VR vr = UNKNOWN_VR;
+    uint32_t length = 0;
+    MC_STATUS ret = read_element_header( source,
+                                         source_syntax,
+                                         tag,
+                                         vr,
+                                         length );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        if( vr == SQ || (vr == UNKNOWN_VR && length == UNDEFINED_LENGTH) )
+        {
+            // UN sequences of undefined length are always encoded as
+            // implicit little endian (PS3.5 6.2.2)
+            const open_container container =
+            {
+                length == UNDEFINED_LENGTH ? UNDEFINED_END :
+                                             source.tell_read() + length,
+                false,
+                vr == SQ ? source_syntax : IMPLICIT_LITTLE_ENDIAN,
+                vr_cache.pixel_representation()
+            };
+            containers.push_back( container );
+
+            ret = write_element_header( dest,
+                                        dest_syntax,
+                                        tag,
+                                        SQ,
+                                        UNDEFINED_LENGTH );
+        }
+        else if( length == UNDEFINED_LENGTH )
+        {
+            // Encapsulated values do not appear in the uncompressed
+            // transfer syntaxes
+            ret = MC_INVALID_LENGTH_FOR_VR;
+        }
+        else if( (tag & 0x0000FFFFu) == 0u )
+        {
+            // Group length values are not valid once the header sizes
+            // change, so they are dropped
+            ret = skip_value( source, source_syntax, vr, length );
+        }
+        else
+        {
+            vr_value_t vr_value;
+            uint8_t field_size = 0;
+            ret = get_vr_field_value( vr, vr_value, field_size );
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                // Values read from an implicit data set may exceed the
+                // 16-bit length field of the VR in an explicit one
+                const MC_VR dest_vr =
+                    dest_syntax != IMPLICIT_LITTLE_ENDIAN &&
+                    field_size <= vr_value.size()         &&
+                    length > numeric_limits<uint16_t>::max() ? UNKNOWN_VR : vr;
+
+                ret = write_element_header( dest,
+                                            dest_syntax,
+                                            tag,
+                                            dest_vr,
+                                            length );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    const uint32_t swap_size =
+                        is_big_endian( source_syntax ) != is_big_endian( dest_syntax ) ?
+                            get_swap_size( vr ) : 1u;
+                    ret = copy_value( source, dest, length, swap_size, buffer );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+bool transcoder_supports_syntax( TRANSFER_SYNTAX syntax )
+{
+    return syntax == IMPLICIT_LITTLE_ENDIAN ||
+           syntax == EXPLICIT_LITTLE_ENDIAN ||
+           syntax == EXPLICIT_BIG_ENDIAN;
+}
+
+MC_STATUS transcode_values( rx_stream&      source,
+                            TRANSFER_SYNTAX source_syntax,
+                            tx_stream&      dest,
+                            TRANSFER_SYNTAX dest_syntax )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( transcoder_supports_syntax( source_syntax ) == true &&
+        transcoder_supports_syntax( dest_syntax ) == true )
+    {
+        container_stack containers;
+        vector<uint8_t> buffer( TRANSCODE_CHUNK_SIZE );
+        bool done = false;
+
+        // Needed even for explicit VR data sets, whose UN sequences have
+        // implicit VR items
+        implicit_vr_cache vr_cache;
+        const implicit_vr_scope vr_scope( vr_cache );
+
+        ret = MC_NORMAL_COMPLETION;
+        while( ret == MC_NORMAL_COMPLETION && done == false )
+        {
+            ret = close_ended_containers( source,
+                                          dest,
+                                          dest_syntax,
+                                          vr_cache,
+                                          containers );
+
+            const TRANSFER_SYNTAX syntax = containers.empty() == true ?
+                                               source_syntax :
+                                               containers.back().syntax;
+            uint32_t tag = 0;
+            if( ret == MC_NORMAL_COMPLETION )
+            {
+                ret = source.read_tag( tag, syntax );
+            }
+            else
+            {
+                // Do nothing. Will return error
+            }
+
+            if( ret == MC_END_OF_DATA && containers.empty() == true )
+            {
+                // No more data at the start of a top-level element
+                done = true;
+                ret = MC_NORMAL_COMPLETION;
+            }
+            else if( ret == MC_END_OF_DATA )
+            {
+                ret = MC_UNEXPECTED_EOD;
+            }
+            else if( ret != MC_NORMAL_COMPLETION )
+            {
+                // Do nothing. Will return error
+            }
+            else if( tag == MC_ATT_ITEM )
+            {
+                uint32_t length = 0;
+                ret = source.read_val( length, syntax );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    const open_container container =
+                    {
+                        length == UNDEFINED_LENGTH ? UNDEFINED_END :
+                                                     source.tell_read() + length,
+                        true,
+                        syntax,
+                        vr_cache.pixel_representation()
+                    };
+                    containers.push_back( container );
+
+                    ret = dest.write_tag( MC_ATT_ITEM, dest_syntax );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    ret = dest.write_val( UNDEFINED_LENGTH, dest_syntax );
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else if( tag == MC_ATT_ITEM_DELIMITATION_ITEM ||
+                     tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM )
+            {
+                // The length should be zero but is not checked
+                uint32_t length = 0;
+                ret = source.read_val( length, syntax );
+                if( ret == MC_NORMAL_COMPLETION )
+                {
+                    const bool is_item = tag == MC_ATT_ITEM_DELIMITATION_ITEM;
+                    if( containers.empty() == false            &&
+                        containers.back().is_item == is_item   &&
+                        containers.back().end_offset == UNDEFINED_END )
+                    {
+                        ret = close_container( dest,
+                                               dest_syntax,
+                                               vr_cache,
+                                               containers );
+                    }
+                    else
+                    {
+                        ret = MC_MISSING_DELIMITER;
+                    }
+                }
+                else
+                {
+                    // Do nothing. Will return error
+                }
+            }
+            else
+            {
+                ret = transcode_element( source,
+                                         syntax,
+                                         dest,
+                                         dest_syntax,
+                                         tag,
+                                         vr_cache,
+                                         containers,
+                                         buffer );
+            }
+        }
+    }
+    else
+    {
+        ret = MC_INVALID_TRANSFER_SYNTAX;
+    }
+
+    return ret;
+}
+
+}
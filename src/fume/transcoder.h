@@ -0,0 +1,46 @@
+#ifndef TRANSCODER_H
+#define TRANSCODER_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+
+// local public
+#include "mcstatus.h"
+#include "mc3msg.h"
+
+namespace fume
+{
+
+class tx_stream;
+class rx_stream;
+
+bool transcoder_supports_syntax( TRANSFER_SYNTAX syntax );
+
+// Copies the data set in the source stream to the destination stream,
+// rewriting the tag, VR and length fields and byte-swapping values as
+// necessary for the destination transfer syntax. Values are copied in
+// fixed-size chunks and never stored in a value_representation, so memory
+// use does not depend on the size of the data set. Sequences and items
+// are always written with undefined length and group length elements are
+// dropped since their values change with the transfer syntax.
+//
+// The VRs of an implicit source data set are resolved from the data set
+// itself (eg. US or SS by its Pixel Representation). Private attributes
+// other than private creators are written as UN.
+MC_STATUS transcode_values( rx_stream&      source,
+                            TRANSFER_SYNTAX source_syntax,
+                            tx_stream&      dest,
+                            TRANSFER_SYNTAX dest_syntax );
+
+}
+
+#endif
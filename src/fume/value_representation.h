@@ -12,6 +12,7 @@
  */
 
 // std
+#include <cstddef>
 #include <memory>
 
 // local public
@@ -20,6 +21,7 @@
 // local private
 #include "fume/serializable.h"
 #include "fume/value_representation_types.h"
+#include "fume/arena.h"
 
 namespace fume
 {
@@ -38,6 +40,17 @@ public:
     {
     }
 
+    // Values read from a file are allocated from the file's arena
+    static void* operator new( size_t size )
+    {
+        return arena::allocate_object( size );
+    }
+
+    static void operator delete( void* ptr )
+    {
+        arena::deallocate_object( ptr );
+    }
+
 // value_representation -- modifiers
 // Note: we make these functions non-pure with a default
 // implementation of to return MC_INCOMPATIBLE_VR to
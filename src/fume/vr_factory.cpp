@@ -45,6 +45,7 @@
 #include "fume/vrs/uc.h"
 #include "fume/vrs/ui.h"
 #include "fume/vrs/ur.h"
+#include "fume/vrs/un.h"
 
 namespace fume
 {
@@ -134,9 +135,8 @@ std::unique_ptr<value_representation> create_vr( MC_VR        vr,
             ret.reset( new fume::vrs::fd( min_vals, max_vals, multiple ) );
             break;
         case UNKNOWN_VR:
-            // TODO: implement
-            // ret = fume::vrs::un() );
-            ret = nullptr;
+            // Note: only 1 value allowed in UN
+            ret.reset( new fume::vrs::un() );
             break;
         case OB:
             // Note: only 1 value allowed in OB
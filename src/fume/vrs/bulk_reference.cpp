@@ -0,0 +1,197 @@
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cassert>
+
+// local private
+#include "fume/tx_stream.h"
+#include "fume/bulk_data_source.h"
+#include "fume/vr_factory.h"
+#include "fume/vrs/bulk_reference.h"
+
+using std::unique_ptr;
+using std::shared_ptr;
+
+namespace fume
+{
+namespace vrs
+{
+
+bulk_reference::bulk_reference( MC_VR                           vr,
+                                const shared_ptr<bulk_data_source>& source,
+                                TRANSFER_SYNTAX                 syntax,
+                                uint64_t                        offset,
+                                uint32_t                        length )
+    : value_representation( 1u, 1u, 1u ),
+      m_vr( vr ),
+      m_source( source ),
+      m_syntax( syntax ),
+      m_offset( offset ),
+      m_length( length )
+{
+    assert( m_source != nullptr );
+    assert( m_vr == OB || m_vr == OW || m_vr == OD );
+    m_source->add_reference( this );
+}
+
+bulk_reference::bulk_reference( const bulk_reference& rhs )
+    : value_representation( 1u, 1u, 1u ),
+      m_vr( rhs.m_vr ),
+      m_source( rhs.m_source ),
+      m_syntax( rhs.m_syntax ),
+      m_offset( rhs.m_offset ),
+      m_length( rhs.m_length ),
+      m_value( rhs.m_value != nullptr ? rhs.m_value->clone() : nullptr )
+{
+    m_source->add_reference( this );
+}
+
+bulk_reference::~bulk_reference()
+{
+    m_source->remove_reference( this );
+}
+
+MC_STATUS bulk_reference::to_stream( tx_stream& stream, TRANSFER_SYNTAX syntax )
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( m_value == nullptr && can_copy_to( syntax ) == true )
+    {
+        ret = stream.write_val( m_length, syntax );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            // The length field is 4 bytes for all of the referenced VRs
+            ret = m_source->copy_range( m_offset + sizeof(m_length),
+                                        m_length,
+                                        stream );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = materialize();
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            ret = m_value->to_stream( stream, syntax );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+
+    return ret;
+}
+
+MC_STATUS bulk_reference::from_stream( rx_stream&      stream,
+                                       TRANSFER_SYNTAX syntax )
+{
+    unique_ptr<value_representation> tmp( create_vr( m_vr, 1u, 1u, 1u ) );
+    MC_STATUS ret = tmp->from_stream( stream, syntax );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        m_value.swap( tmp );
+    }
+    else
+    {
+        // Leave value unchanged and return error
+    }
+
+    return ret;
+}
+
+MC_STATUS bulk_reference::set( const set_func_parms& val )
+{
+    unique_ptr<value_representation> tmp( create_vr( m_vr, 1u, 1u, 1u ) );
+    MC_STATUS ret = tmp->set( val );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        m_value.swap( tmp );
+    }
+    else
+    {
+        // Leave value unchanged and return error
+    }
+
+    return ret;
+}
+
+MC_STATUS bulk_reference::set_null()
+{
+    m_value = create_vr( m_vr, 1u, 1u, 1u );
+
+    return MC_NORMAL_COMPLETION;
+}
+
+MC_STATUS bulk_reference::get( const get_func_parms& val )
+{
+    MC_STATUS ret = materialize();
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = m_value->get( val );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+bool bulk_reference::is_null() const
+{
+    return m_value != nullptr ? m_value->is_null() : m_length == 0u;
+}
+
+unique_ptr<value_representation> bulk_reference::clone() const
+{
+    return unique_ptr<value_representation>( new bulk_reference( *this ) );
+}
+
+MC_STATUS bulk_reference::materialize()
+{
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    if( m_value == nullptr )
+    {
+        unique_ptr<value_representation> tmp( create_vr( m_vr, 1u, 1u, 1u ) );
+        ret = m_source->read_value( m_offset, m_syntax, *tmp );
+        if( ret == MC_NORMAL_COMPLETION )
+        {
+            m_value.swap( tmp );
+        }
+        else
+        {
+            // Do nothing. Will return error
+        }
+    }
+    else
+    {
+        ret = MC_NORMAL_COMPLETION;
+    }
+
+    return ret;
+}
+
+bool bulk_reference::can_copy_to( TRANSFER_SYNTAX syntax ) const
+{
+    // Byte values never need swapping. Word values can be copied as long
+    // as the byte order doesn't change
+    return m_vr == OB ||
+           ((m_syntax == EXPLICIT_BIG_ENDIAN) == (syntax == EXPLICIT_BIG_ENDIAN));
+}
+
+} // namespace vrs
+} // namespace fume
@@ -0,0 +1,110 @@
+#ifndef BULK_REFERENCE_H
+#define BULK_REFERENCE_H
+/**
+ * This file is a part of the FUMe project.
+ *
+ * To the extent possible under law, the person who associated CC0 with
+ * FUMe has waived all copyright and related or neighboring rights
+ * to FUMe.
+ *
+ * You should have received a copy of the CC0 legalcode along with this
+ * work.  If not, see http://creativecommons.org/publicdomain/zero/1.0/.
+ */
+
+// std
+#include <cstdint>
+#include <memory>
+
+// local public
+#include "mc3msg.h"
+
+// local private
+#include "fume/value_representation.h"
+
+namespace fume
+{
+
+class bulk_data_source;
+
+namespace vrs
+{
+
+// Stands in for a large OB, OW or OD value which was left in the file
+// it was read from. When written, the value bytes are copied directly
+// from the source file. The value is only read into memory if it is
+// accessed or has to be byte swapped. Once the value is modified the
+// reference to the source is dropped.
+// Note: the encapsulated value functions are not supported
+class bulk_reference final : public value_representation
+{
+public:
+    bulk_reference( MC_VR                                    vr,
+                    const std::shared_ptr<bulk_data_source>& source,
+                    TRANSFER_SYNTAX                          syntax,
+                    uint64_t                                 offset,
+                    uint32_t                                 length );
+    virtual ~bulk_reference();
+
+// serializable
+public:
+    virtual MC_STATUS to_stream( tx_stream&      stream,
+                                 TRANSFER_SYNTAX syntax ) override final;
+    virtual MC_STATUS from_stream( rx_stream&      stream,
+                                   TRANSFER_SYNTAX syntax ) override final;
+
+// value_representation -- modifiers
+public:
+    virtual MC_STATUS set( const set_func_parms& val ) override final;
+
+    // Sets the value of the data element to NULL (ie. zero length)
+    virtual MC_STATUS set_null() override final;
+
+// value_representation -- accessors
+public:
+    virtual MC_STATUS get( const get_func_parms& val ) override final;
+
+    // Returns the number of elements
+    virtual int count() const override final
+    {
+        return static_cast<int>( is_null() == false );
+    }
+
+    // Indicates whether or not the element is null
+    virtual bool is_null() const override final;
+
+    virtual MC_VR vr() const override final
+    {
+        return m_vr;
+    }
+
+    virtual std::unique_ptr<value_representation> clone() const override final;
+
+public:
+    // Offset of the length field of the value in the source
+    uint64_t offset() const
+    {
+        return m_offset;
+    }
+
+    // Reads the value from the source if that has not already happened
+    MC_STATUS materialize();
+
+private:
+    bulk_reference( const bulk_reference& rhs );
+    bulk_reference& operator=( const bulk_reference& rhs );
+
+    bool can_copy_to( TRANSFER_SYNTAX syntax ) const;
+
+private:
+    const MC_VR                           m_vr;
+    std::shared_ptr<bulk_data_source>     m_source;
+    const TRANSFER_SYNTAX                 m_syntax;
+    const uint64_t                        m_offset;
+    const uint32_t                        m_length;
+    std::unique_ptr<value_representation> m_value;
+};
+
+} // namespace vrs
+} // namespace fume
+
+#endif
@@ -14,9 +14,9 @@
 #include <cstdint>
 #include <algorithm>
 #include <limits>
-
-// boost
-#include "boost/scope_exit.hpp"
+#include <unordered_set>
+#include <vector>
+#include <utility>
 
 // local public
 #include "mc3msg.h"
@@ -28,11 +28,15 @@
 #include "fume/item_object.h"
 #include "fume/tx_stream.h"
 #include "fume/rx_stream.h"
+#include "fume/data_dictionary_types.h"
+#include "fume/sequence_reader.h"
 
 using std::for_each;
 using std::min;
-using std::deque;
 using std::numeric_limits;
+using std::unordered_set;
+using std::vector;
+using std::move;
 
 namespace fume
 {
@@ -63,69 +67,121 @@ static MC_STATUS write_sequence_delimitation( tx_stream&      stream,
     return ret;
 }
 
-static int read_item( rx_stream& stream, TRANSFER_SYNTAX syntax )
+// Releases the IDs of items which are about to be destroyed
+static void release_handles( sq::value_list_t& items )
 {
-    assert( g_context != nullptr );
-
-    int id = g_context->create_empty_item_object();
-    if( id > 0 )
+    if( g_context != nullptr )
     {
-        item_object* item =
-            dynamic_cast<item_object*>( g_context->get_object( id ) );
-        assert( item != nullptr );
-
-        const MC_STATUS stat = item->from_stream( stream, syntax );
-        if( stat != MC_NORMAL_COMPLETION )
+        for( item_object_ptr& item : items )
         {
-            id = -static_cast<int>( stat );
+            if( item != nullptr && item->id() > 0 )
+            {
+                g_context->release_item_handle( *item );
+            }
+            else
+            {
+                // Do nothing. Item has no ID
+            }
         }
-        else
+    }
+    else
+    {
+        // Do nothing. The library is being released
+    }
+}
+
+// Returns items which are being removed from the sequence without being
+// freed to the library context so that their IDs remain valid
+static void return_items( sq::value_list_t& items )
+{
+    if( g_context != nullptr )
+    {
+        for( item_object_ptr& item : items )
         {
-            // Do nothing on success. Will return item id
+            g_context->return_item_object( move( item ) );
         }
     }
     else
     {
-        // Do nothing. Will return errro
+        // Do nothing. The library is being released
+    }
+}
+
+// Deep copies an item. The copy has no ID
+static item_object_ptr copy_item( item_object& item )
+{
+    // A record whose values can't be read is copied empty
+    (void)item.load_values();
+
+    value_dict values;
+    for( dictionary_iter itr = item.begin(); itr != item.end(); ++itr )
+    {
+        if( itr->second != nullptr )
+        {
+            values[itr->first] = itr->second->clone();
+        }
+        else
+        {
+            // Do nothing. Empty values are not copied
+        }
     }
 
-    return id;
+    item_object_ptr ret( new item_object( 0, true ) );
+    ret->insert( move( values ) );
+
+    return ret;
 }
 
-static MC_STATUS write_item( tx_stream& stream, TRANSFER_SYNTAX syntax, int id )
+// Takes ownership of an item created with MC_Open_Item. An item which
+// already belongs to a sequence is copied instead
+static MC_STATUS take_item( int id, item_object_ptr& item )
 {
-    // Caller should have done this
     assert( g_context != nullptr );
 
     MC_STATUS ret = MC_CANNOT_COMPLY;
 
-    item_object* item =
-        dynamic_cast<item_object*>( g_context->get_object( id ) );
+    item = g_context->adopt_item_object( id );
     if( item != nullptr )
     {
-        ret = item->to_stream( stream, syntax );
+        ret = MC_NORMAL_COMPLETION;
     }
     else
     {
-        ret = MC_INVALID_ITEM_ID;
+        item_object* owned_item =
+            dynamic_cast<item_object*>( g_context->get_object( id ) );
+        if( owned_item != nullptr )
+        {
+            item = copy_item( *owned_item );
+            ret = MC_NORMAL_COMPLETION;
+        }
+        else
+        {
+            ret = MC_INCOMPATIBLE_VR;
+        }
     }
 
     return ret;
 }
 
-template<class Iterator>
-static void free_items( Iterator begin, Iterator end )
+static MC_STATUS get_item_id( const item_object_ptr& item, int& val )
 {
-    if( g_context != nullptr )
+    assert( g_context != nullptr );
+    assert( item != nullptr );
+
+    MC_STATUS ret = MC_CANNOT_COMPLY;
+
+    const int id = g_context->create_item_handle( *item );
+    if( id > 0 )
+    {
+        val = id;
+        ret = MC_NORMAL_COMPLETION;
+    }
+    else
     {
-        // Delete all items
-        for_each( begin,
-                  end,
-                  []( int item )
-                  {
-                      g_context->free_item_object( item );
-                  } );
+        ret = static_cast<MC_STATUS>( -id );
     }
+
+    return ret;
 }
 
 sq::sq( unsigned int min_vals, unsigned int max_vals, unsigned int multiple )
@@ -133,89 +189,38 @@ sq::sq( unsigned int min_vals, unsigned int max_vals, unsigned int multiple )
 {
 }
 
+sq::sq( const sq& rhs )
+    : value_representation( rhs )
+{
+    for( value_list_t::const_iterator itr = rhs.m_items.cbegin();
+         itr != rhs.m_items.cend();
+         ++itr )
+    {
+        (void)m_items.set_next( copy_item( **itr ) );
+    }
+}
+
 sq::~sq()
 {
-    free_items( m_items.cbegin(), m_items.cend() );
+    release_handles( m_items );
 }
 
 MC_STATUS sq::from_stream( rx_stream& stream, TRANSFER_SYNTAX syntax )
 {
     uint32_t value_length = 0;
-    value_list_t tmp_items;
 
-    // If the function succeeds then the old items need to
-    // be freed. If it failed the leftover items need to
-    // be freed. In either way we need to free all the
-    // items in the list
-    BOOST_SCOPE_EXIT( &tmp_items )
-    {
-        free_items( tmp_items.cbegin(), tmp_items.cend() );
-    } BOOST_SCOPE_EXIT_END
-    
     MC_STATUS ret = stream.read_val( value_length, syntax );
     if( ret == MC_NORMAL_COMPLETION )
     {
-        const bool delimited = value_length == numeric_limits<uint32_t>::max();
-        const uint32_t start_offset = stream.tell_read();
-        uint32_t cur_offset = stream.tell_read();
-
-        while( ret == MC_NORMAL_COMPLETION &&
-               ((cur_offset - start_offset) + 1) < value_length )
+        vector<item_object_ptr> items;
+        ret = read_sequence( stream, syntax, value_length, items );
+        if( ret == MC_NORMAL_COMPLETION )
         {
-            uint32_t tag = 0;
-            ret = stream.peek_tag( tag, syntax );
-            if( ret == MC_NORMAL_COMPLETION )
-            {
-                if( tag == MC_ATT_ITEM )
-                {
-                    const int item_id = read_item( stream, syntax );
-                    if( item_id > 0 )
-                    {
-                        ret = tmp_items.set_next( item_id );
-                    }
-                    else
-                    {
-                        ret = static_cast<MC_STATUS>(-item_id);
-                    }
-                }
-                else if( tag == MC_ATT_SEQUENCE_DELIMITATION_ITEM )
-                {
-                    uint32_t delimiter_len = 0;
-                    // If peek succeeded then a read of that same data will
-                    // also succeed
-                    (void)stream.read_tag( tag, syntax );
-                    ret = stream.read_val( delimiter_len, syntax );
-                    if( ret == MC_NORMAL_COMPLETION )
-                    {
-                        // If we're expecting a sequence delimiter, then terminate
-                        // the loop
-                        if( delimited == true && delimiter_len == 0 )
-                        {
-                            break;
-                        }
-                        else
-                        {
-                            // If we weren't expected a sequence delimiter, than 
-                            // something went wrong
-                            ret = MC_END_OF_DATA;
-                        }
-                    }
-                    else
-                    {
-                        // Do nothing. Return error
-                    }
-                }
-                else
-                {
-                    ret = MC_INVALID_TAG;
-                }
-            }
-            else
-            {
-                // Do nothing. Will return error
-            }
-
-             cur_offset = stream.tell_read();
+            ret = assign_items( items );
+        }
+        else
+        {
+            // Do nothing. Will return error
         }
     }
     else
@@ -223,11 +228,35 @@ MC_STATUS sq::from_stream( rx_stream& stream, TRANSFER_SYNTAX syntax )
         // Do nothing. Will return error
     }
 
+    return ret;
+}
+
+MC_STATUS sq::assign_items( vector<item_object_ptr>& items )
+{
+    MC_STATUS ret = MC_NORMAL_COMPLETION;
+    value_list_t tmp_items;
+
+    for( vector<item_object_ptr>::iterator itr = items.begin();
+         ret == MC_NORMAL_COMPLETION && itr != items.end();
+         ++itr )
+    {
+        ret = tmp_items.set_next( move( *itr ) );
+    }
+
     if( ret == MC_NORMAL_COMPLETION )
     {
+        // The old items are freed
         tmp_items.swap( m_items );
+        release_handles( tmp_items );
+    }
+    else
+    {
+        // Do nothing. Will return error. Items read from a stream have
+        // no IDs
     }
 
+    items.clear();
+
     return ret;
 }
 
@@ -240,7 +269,7 @@ MC_STATUS sq::to_stream( tx_stream& stream, TRANSFER_SYNTAX syntax )
              ret == MC_NORMAL_COMPLETION && itr != m_items.cend();
              ++itr )
         {
-            ret = write_item( stream, syntax, *itr );
+            ret = (*itr)->to_stream( stream, syntax );
         }
 
         if( ret == MC_NORMAL_COMPLETION )
@@ -263,17 +292,23 @@ MC_STATUS sq::to_stream( tx_stream& stream, TRANSFER_SYNTAX syntax )
 
 MC_STATUS sq::set( int val )
 {
-    MC_STATUS ret = MC_CANNOT_COMPLY;
+    item_object_ptr item;
+    MC_STATUS ret = take_item( val, item );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        value_list_t old_items;
+        old_items.swap( m_items );
 
-    assert( g_context != nullptr );
+        // Setting a single item can't fail
+        (void)m_items.set( move( item ) );
 
-    if( dynamic_cast<item_object*>( g_context->get_object( val ) ) != nullptr )
-    {
-        ret = m_items.set( val );
+        // The specification for this function is that the old items are
+        // /not/ freed
+        return_items( old_items );
     }
     else
     {
-        ret = MC_INCOMPATIBLE_VR;
+        // Do nothing. Will return error
     }
 
     return ret;
@@ -281,30 +316,169 @@ MC_STATUS sq::set( int val )
 
 MC_STATUS sq::set_next( int val )
 {
-    MC_STATUS ret = MC_CANNOT_COMPLY;
+    item_object_ptr item;
+    MC_STATUS ret = take_item( val, item );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = m_items.set_next( move( item ) );
+        if( ret != MC_NORMAL_COMPLETION )
+        {
+            // Keep the item ID valid
+            g_context->return_item_object( move( item ) );
+        }
+        else
+        {
+            // Do nothing. Item added
+        }
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
 
-    assert( g_context != nullptr );
+    return ret;
+}
+
+MC_STATUS sq::set_null()
+{
+    // NOTE: the specification for this function is that items are /not/
+    // freed. Any item with an ID is handed back to the library context
+    value_list_t old_items;
+    old_items.swap( m_items );
+    return_items( old_items );
+
+    return MC_NORMAL_COMPLETION;
+}
 
-    if( dynamic_cast<item_object*>( g_context->get_object( val ) ) != nullptr )
+MC_STATUS sq::delete_current()
+{
+    // As with set_null, the item is not freed
+    item_object_ptr* current = m_items.modify_current();
+    item_object_ptr item;
+    if( current != nullptr )
     {
-        ret = m_items.set_next( val );
+        item.swap( *current );
     }
     else
     {
-        ret = MC_INCOMPATIBLE_VR;
+        // Do nothing. delete_current will return an error
+    }
+
+    const MC_STATUS ret = m_items.delete_current();
+    if( item != nullptr && g_context != nullptr )
+    {
+        g_context->return_item_object( move( item ) );
+    }
+    else
+    {
+        // Do nothing
     }
 
     return ret;
 }
 
+void sq::remove_items( const unordered_set<const item_object*>& items,
+                       vector<item_object_ptr>&                 removed )
+{
+    removed.reserve( removed.size() + items.size() );
+    m_items.remove_values( [&items, &removed]( item_object_ptr& item )
+                           {
+                               const bool ret = items.count( item.get() ) > 0;
+                               if( ret == true )
+                               {
+                                   removed.push_back( move( item ) );
+                               }
+                               else
+                               {
+                                   // Do nothing. Item is kept
+                               }
+
+                               return ret;
+                           } );
+}
+
 MC_STATUS sq::get( int& val )
 {
-    return m_items.get( val );
+    const item_object_ptr* item = nullptr;
+    MC_STATUS ret = m_items.get( item );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = get_item_id( *item, val );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
 }
 
 MC_STATUS sq::get_next( int& val )
 {
-    return m_items.get_next( val );
+    const item_object_ptr* item = nullptr;
+    MC_STATUS ret = m_items.get_next( item );
+    if( ret == MC_NORMAL_COMPLETION )
+    {
+        ret = get_item_id( *item, val );
+    }
+    else
+    {
+        // Do nothing. Will return error
+    }
+
+    return ret;
+}
+
+void sq::get_items( vector<item_object*>& items ) const
+{
+    items.reserve( items.size() + m_items.count() );
+    for( value_list_t::const_iterator itr = m_items.cbegin();
+         itr != m_items.cend();
+         ++itr )
+    {
+        items.push_back( itr->get() );
+    }
+}
+
+bool sq::contains( const data_dictionary& dict ) const
+{
+    // Sequences may nest arbitrarily deeply, so walk them with an
+    // explicit stack rather than recursing
+    vector<const sq*> pending( 1u, this );
+
+    bool found = false;
+    while( found == false && pending.empty() == false )
+    {
+        const sq* const cur = pending.back();
+        pending.pop_back();
+
+        for( value_list_t::const_iterator itr = cur->m_items.cbegin();
+             found == false && itr != cur->m_items.cend();
+             ++itr )
+        {
+            item_object& item = **itr;
+            if( &item == &dict )
+            {
+                found = true;
+            }
+            else
+            {
+                for( value_dict::const_reference elem : item )
+                {
+                    if( elem.second != nullptr && elem.second->vr() == SQ )
+                    {
+                        pending.push_back( static_cast<const sq*>( elem.second.get() ) );
+                    }
+                    else
+                    {
+                        // Do nothing. Only sequences contain items
+                    }
+                }
+            }
+        }
+    }
+
+    return found;
 }
 
 } // namespace vrs
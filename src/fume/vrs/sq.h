@@ -13,11 +13,14 @@
 
 // std
 #include <limits>
+#include <unordered_set>
+#include <vector>
 
 // local private
 #include "fume/value_representation.h"
 #include "fume/value_conversion.h"
 #include "fume/vrs/vr_value_list.h"
+#include "fume/item_object.h"
 
 namespace fume
 {
@@ -25,9 +28,10 @@ namespace vrs
 {
 
 // vr_sq is used to contain objects which have a sequence value
-// representation. This class doesn't actually implement the
-// item object but rather references one by its integer item
-// ID (returned from MC_Create_Item)
+// representation. The sequence owns its items. The integer item IDs
+// used by the API are only handles: an item created with MC_Open_Item
+// is taken over by the sequence when it is set, and an item read from a
+// stream is only given an ID when one is requested with get
 class sq final : public value_representation
 {
 public:
@@ -43,6 +47,13 @@ public:
 
 // value_representation -- modifiers
 public:
+    // Replaces the items with those read by read_sequence, freeing the
+    // old items. items is left empty
+    MC_STATUS assign_items( std::vector<item_object_ptr>& items );
+
+    // Replaces the items with the item whose ID is val. An item which
+    // already belongs to a sequence, this one included, is copied and
+    // val keeps referring to the original, so items are never shared
     virtual MC_STATUS set( int val ) override final;
 
     virtual MC_STATUS set( double val ) override final
@@ -109,12 +120,10 @@ public:
     // Sets the value of the data element to NULL (ie. zero length).
     // NOTE: the specification for this function is that items are /not/
     // freed
-    virtual MC_STATUS set_null() override final
-    {
-        m_items.set_null();
-        return MC_NORMAL_COMPLETION;
-    }
+    virtual MC_STATUS set_null() override final;
 
+    // Appends the item whose ID is val, copying it if it already
+    // belongs to a sequence as set does
     virtual MC_STATUS set_next( int val ) override final;
 
     virtual MC_STATUS set_next( double val ) override final
@@ -175,10 +184,13 @@ public:
     }
 
     // Removes the "current" value
-    virtual MC_STATUS delete_current() override final
-    {
-        return m_items.delete_current();
-    }
+    virtual MC_STATUS delete_current() override final;
+
+    // Removes all of the items in items in one pass over the sequence,
+    // moving them to removed in sequence order. As with delete_current
+    // the items are not freed
+    void remove_items( const std::unordered_set<const item_object*>& items,
+                       std::vector<item_object_ptr>&                 removed );
 
 // value_representation -- accessors
 public:
@@ -329,21 +341,29 @@ public:
         return SQ;
     }
 
+    // True if dict is one of the items of the sequence or is nested
+    // within one of them
+    bool contains( const data_dictionary& dict ) const;
+
+    // Appends the items of the sequence to items, in order. The items
+    // remain owned by the sequence
+    void get_items( std::vector<item_object*>& items ) const;
+
     virtual std::unique_ptr<value_representation> clone() const override
     {
         return std::unique_ptr<value_representation>( new sq( *this ) );
     }
 
-private:
-    sq( const sq& rhs )
-        : value_representation( rhs ),
-          // TODO: Do we ned to do a deep copy?
-          m_items( rhs.m_items )
-    {
-    }
+public:
+    // Items are owned by the sequence rather than the library context.
+    // An item is only registered with the context when its ID is
+    // requested
+    typedef vr_value_list<item_object_ptr,
+                          std::numeric_limits<uint32_t>::max() - 1> value_list_t;
 
 private:
-  typedef vr_value_list<int, std::numeric_limits<uint32_t>::max() - 1> value_list_t;
+    // Deep copies the items. The copies have no IDs
+    sq( const sq& rhs );
 
 private:
     value_list_t m_items;
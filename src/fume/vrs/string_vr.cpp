@@ -24,7 +24,6 @@
 #include "fume/rx_stream.h"
 
 using std::min;
-using std::deque;
 using std::string;
 using std::numeric_limits;
 using std::move;
@@ -12,7 +12,7 @@
  */
 
 // std
-#include <deque>
+#include <cassert>
 #include <string>
 #include <type_traits>
 #include <limits>
@@ -20,11 +20,13 @@
 #include <algorithm>
 #include <numeric>
 #include <utility>
+#include <vector>
 
 // local public
 #include "mcstatus.h"
 
 // local private
+#include "fume/arena.h"
 
 namespace fume
 {
@@ -32,22 +34,26 @@ namespace fume
 namespace vrs
 {
 
+// Values come from the arena of the file being read, if any
+template<class T>
+using value_vector = std::vector<T, arena_allocator<T>>;
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 
 template<class T>
-static size_t get_value_size( const std::deque<T>& val )
+static size_t get_value_size( const value_vector<T>& val )
 {
     return val.size() * sizeof(T);
 }
 
 template<class T>
-static size_t get_new_size( const std::deque<T>& val, const T& )
+static size_t get_new_size( const value_vector<T>& val, const T& )
 {
     return get_value_size( val ) + sizeof(T);
 }
 
-static size_t get_value_size( const std::deque<std::string>& values )
+static size_t get_value_size( const value_vector<std::string>& values )
 {
     // Calculate the total length of all the strings
     const size_t str_size = std::accumulate( values.cbegin(),
@@ -66,7 +72,7 @@ static size_t get_value_size( const std::deque<std::string>& values )
     return total_size;
 }
 
-static size_t get_new_size( const std::deque<std::string>& values,
+static size_t get_new_size( const value_vector<std::string>& values,
                             const std::string&             val )
 {
     // If list is empty, new size is just the size of the new value
@@ -77,29 +83,43 @@ static size_t get_new_size( const std::deque<std::string>& values,
 
 #pragma GCC diagnostic pop
 
+// A list holds its values itself until it is first copied. The copy
+// moves them to a container shared by both lists, so cloning a value
+// representation does not copy its values, and a list takes a private
+// copy of shared values on its first modification. Each copy keeps its
+// own get_next position.
+//
+// Sharing is detected with shared_ptr::use_count(), which does not
+// synchronize with other threads, and copying a list moves the values of
+// the source. Lists sharing values (ie. the values of an object and of
+// its copies) must not be copied, modified or freed concurrently
 template<class T, size_t MaxSize>
 class vr_value_list
 {
 public:
-    typedef typename std::deque<T>::iterator iterator;
-    typedef typename std::deque<T>::const_iterator const_iterator;
+    typedef typename value_vector<T>::iterator iterator;
+    typedef typename value_vector<T>::const_iterator const_iterator;
 
 public:
     vr_value_list()
-        : m_current_idx( 0 )
+        : m_local(),
+          m_shared(),
+          m_current_idx( 0 )
     {
         static_assert( MaxSize < std::numeric_limits<uint32_t>::max(),
                        "MaxSize must be < 0xFFFFFFFF" );
     }
 
     vr_value_list( const vr_value_list& rhs )
-        : m_values( rhs.m_values ),
+        : m_local(),
+          m_shared( rhs.share_values() ),
           m_current_idx( rhs.m_current_idx )
     {
     }
 
     vr_value_list( vr_value_list&& rhs ) noexcept
-        : m_values( std::move( rhs.m_values ) ),
+        : m_local( std::move( rhs.m_local ) ),
+          m_shared( std::move( rhs.m_shared ) ),
           m_current_idx( std::move( rhs.m_current_idx ) )
     {
         rhs.m_current_idx = 0;
@@ -107,6 +127,8 @@ public:
 
     MC_STATUS set( T&& val )
     {
+        // Always a new container, so values shared with another list
+        // are not copied only to be discarded
         container_t tmp;
         tmp.push_back( std::move( val ) );
 
@@ -115,8 +137,7 @@ public:
         {
             // Atomically clear and add. If the push_back above fails then
             // the value is not modified
-            m_values.swap( tmp );
-            m_current_idx = 0;
+            replace_values( tmp );
             ret = MC_NORMAL_COMPLETION;
         }
         else
@@ -129,21 +150,36 @@ public:
 
     MC_STATUS set( const T& val )
     {
-        container_t tmp;
-        tmp.push_back( val );
-
         MC_STATUS ret = MC_CANNOT_COMPLY;
-        if( get_value_size( tmp ) <= MaxSize )
+
+        if( std::is_arithmetic<T>::value == true &&
+            m_shared == nullptr &&
+            m_local.size() == 1u )
         {
-            // Atomically clear and add. If the push_back above fails then
-            // the value is not modified
-            m_values.swap( tmp );
+            // Replacing the only value of a number can't fail or change
+            // the size, so the container is reused
+            m_local.front() = val;
             m_current_idx = 0;
             ret = MC_NORMAL_COMPLETION;
         }
         else
         {
-            ret = MC_TOO_MANY_VALUES;
+            // Always a new container, so values shared with another list
+            // are not copied only to be discarded
+            container_t tmp;
+            tmp.push_back( val );
+
+            if( get_value_size( tmp ) <= MaxSize )
+            {
+                // Atomically clear and add. If the push_back above fails
+                // then the value is not modified
+                replace_values( tmp );
+                ret = MC_NORMAL_COMPLETION;
+            }
+            else
+            {
+                ret = MC_TOO_MANY_VALUES;
+            }
         }
 
         return ret;
@@ -153,9 +189,9 @@ public:
     {
         MC_STATUS ret = MC_CANNOT_COMPLY;
 
-        if( get_new_size( m_values, val ) <= MaxSize )
+        if( get_new_size( values(), val ) <= MaxSize )
         {
-            m_values.push_back( std::move( val ) );
+            unshared_values().push_back( std::move( val ) );
             m_current_idx = 0;
             ret = MC_NORMAL_COMPLETION;
         }
@@ -171,9 +207,9 @@ public:
     {
         MC_STATUS ret = MC_CANNOT_COMPLY;
 
-        if( get_new_size( m_values, val ) <= MaxSize )
+        if( get_new_size( values(), val ) <= MaxSize )
         {
-            m_values.push_back( val );
+            unshared_values().push_back( val );
             m_current_idx = 0;
             ret = MC_NORMAL_COMPLETION;
         }
@@ -189,10 +225,11 @@ public:
     {
         MC_STATUS ret = MC_CANNOT_COMPLY;
 
-        if( m_values.empty() == false )
+        const container_t& list = values();
+        if( list.empty() == false )
         {
             m_current_idx = 0;
-            val = &m_values[m_current_idx];
+            val = &list[m_current_idx];
             ret = MC_NORMAL_COMPLETION;
         }
         else
@@ -207,10 +244,11 @@ public:
     {
         MC_STATUS ret = MC_CANNOT_COMPLY;
 
-        if( m_values.empty() == false )
+        const container_t& list = values();
+        if( list.empty() == false )
         {
             m_current_idx = 0;
-            val = m_values[m_current_idx];
+            val = list[m_current_idx];
             ret = MC_NORMAL_COMPLETION;
         }
         else
@@ -225,12 +263,13 @@ public:
     {
         MC_STATUS ret = MC_CANNOT_COMPLY;
 
-        if( m_values.empty() == false )
+        const container_t& list = values();
+        if( list.empty() == false )
         {
-            m_current_idx = std::min( m_values.size(), m_current_idx + 1 );
-            if( m_current_idx < m_values.size() )
+            m_current_idx = std::min( list.size(), m_current_idx + 1 );
+            if( m_current_idx < list.size() )
             {
-                val = &m_values[m_current_idx];
+                val = &list[m_current_idx];
                 ret = MC_NORMAL_COMPLETION;
             }
             else
@@ -250,12 +289,13 @@ public:
     {
         MC_STATUS ret = MC_CANNOT_COMPLY;
 
-        if( m_values.empty() == false )
+        const container_t& list = values();
+        if( list.empty() == false )
         {
-            m_current_idx = std::min( m_values.size(), m_current_idx + 1 );
-            if( m_current_idx < m_values.size() )
+            m_current_idx = std::min( list.size(), m_current_idx + 1 );
+            if( m_current_idx < list.size() )
             {
-                val = m_values[m_current_idx];
+                val = list[m_current_idx];
                 ret = MC_NORMAL_COMPLETION;
             }
             else
@@ -271,18 +311,37 @@ public:
         return ret;
     }
 
+    // Returns the value get and get_next last returned, or NULL if
+    // there is none
+    const T* current() const
+    {
+        return m_current_idx < values().size() ?
+               &values()[m_current_idx] :
+               nullptr;
+    }
+
+    // As current, for callers which modify the value. Takes a private
+    // copy of shared values
+    T* modify_current()
+    {
+        return m_current_idx < values().size() ?
+               &unshared_values()[m_current_idx] :
+               nullptr;
+    }
+
     MC_STATUS delete_current()
     {
         MC_STATUS ret = MC_CANNOT_COMPLY;
 
-        if( m_values.empty() == false )
+        if( values().empty() == false )
         {
-            if( m_current_idx < m_values.size() )
+            if( m_current_idx < values().size() )
             {
-                m_values.erase( m_values.cbegin() + m_current_idx );
+                container_t& list = unshared_values();
+                list.erase( list.cbegin() + m_current_idx );
                 // Adjust the index to continue to be valid if we removed
                 // the last element of a multi-element list
-                if( m_current_idx > 0 && m_current_idx >= m_values.size() )
+                if( m_current_idx > 0 && m_current_idx >= list.size() )
                 {
                     --m_current_idx;
                 }
@@ -290,6 +349,8 @@ public:
                 {
                     // Do nothing. Index is still valid
                 }
+
+                ret = MC_NORMAL_COMPLETION;
             }
             else
             {
@@ -304,58 +365,177 @@ public:
         return ret;
     }
 
+    // Removes every value for which remove returns true in a single
+    // pass, keeping the order of the rest. remove may move from the
+    // values it removes. The current value is reset to the first
+    template<class Remove>
+    void remove_values( Remove remove )
+    {
+        if( values().empty() == false )
+        {
+            container_t& list = unshared_values();
+            typename container_t::iterator kept = list.begin();
+            for( typename container_t::iterator itr = list.begin();
+                 itr != list.end();
+                 ++itr )
+            {
+                if( remove( *itr ) == false )
+                {
+                    if( kept != itr )
+                    {
+                        *kept = std::move( *itr );
+                    }
+                    else
+                    {
+                        // Do nothing. Nothing removed yet
+                    }
+                    ++kept;
+                }
+                else
+                {
+                    // Do nothing. Overwritten by a later value or erased
+                }
+            }
+
+            list.erase( kept, list.end() );
+            m_current_idx = 0;
+        }
+        else
+        {
+            // Do nothing. No values
+        }
+    }
+
     void set_null()
     {
-        m_values.clear();
+        container_t().swap( m_local );
+        // Values shared with another list stay with that list
+        m_shared.reset();
     }
 
     bool is_null() const
     {
-        return m_values.empty();
+        return values().empty();
     }
 
     uint32_t count() const
     {
-        return m_values.size();
+        return values().size();
     }
 
     uint32_t size() const
     {
         // we ensure size is less than 32-bits
-        return get_value_size( m_values );
+        return get_value_size( values() );
     }
 
     iterator begin()
     {
-        return m_values.begin();
+        return unshared_values().begin();
     }
 
     const_iterator cbegin() const
     {
-        return m_values.cbegin();
+        return values().cbegin();
     }
 
     iterator end()
     {
-        return m_values.end();
+        return unshared_values().end();
     }
 
     const_iterator cend() const
     {
-        return m_values.cend();
+        return values().cend();
     }
 
     void swap( vr_value_list& rhs )
     {
-        m_values.swap( rhs.m_values );
+        m_local.swap( rhs.m_local );
+        m_shared.swap( rhs.m_shared );
         std::swap( m_current_idx, rhs.m_current_idx );
     }
 
 private:
-    typedef std::deque<T> container_t;
+    typedef value_vector<T> container_t;
+    typedef std::shared_ptr<container_t> container_ptr;
+
+private:
+    static container_t copy_values( const container_t& values, std::true_type )
+    {
+        return container_t( values );
+    }
+
+    static container_t copy_values( const container_t&, std::false_type )
+    {
+        // Lists of move-only values (ie. sequence items) are never
+        // shared, so are never copied
+        assert( false );
+        return container_t();
+    }
+
+    const container_t& values() const
+    {
+        return m_shared != nullptr ? *m_shared : m_local;
+    }
+
+    // Moves the values to a container which copies of the list can share,
+    // unless they are already there. The container and its control block
+    // come from the current arena, if any, like the values themselves
+    container_ptr share_values() const
+    {
+        if( m_shared == nullptr && m_local.empty() == false )
+        {
+            m_shared = std::allocate_shared<container_t>( arena_allocator<container_t>(),
+                                                          std::move( m_local ) );
+            m_local.clear();
+        }
+        else
+        {
+            // Do nothing. Already shared, or nothing to share
+        }
+
+        return m_shared;
+    }
+
+    // Returns values which are not shared with any other list, copying
+    // them if necessary
+    container_t& unshared_values()
+    {
+        if( m_shared != nullptr )
+        {
+            if( m_shared.use_count() > 1 )
+            {
+                m_local = copy_values( *m_shared,
+                                       std::is_copy_constructible<T>() );
+            }
+            else
+            {
+                m_local = std::move( *m_shared );
+            }
+            m_shared.reset();
+        }
+        else
+        {
+            // Do nothing. Values are not shared
+        }
+
+        return m_local;
+    }
+
+    void replace_values( container_t& values )
+    {
+        m_local.swap( values );
+        m_shared.reset();
+        m_current_idx = 0;
+    }
 
 private:
-    container_t            m_values;
+    // Values are held here until the list is first copied
+    mutable container_t             m_local;
+    // Values shared with copies of the list, if any. m_local is empty
+    // while they are
+    mutable container_ptr           m_shared;
     typename container_t::size_type m_current_idx;
 };
 